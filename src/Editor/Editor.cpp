@@ -34,14 +34,15 @@ SOFTWARE.
 #include "Editor.hpp"
 
 #include <tuple>
+#include <algorithm>
 #include <limits>
 #include <utility>
 #include <format> //C++20 is required. MSVC/GCC-13/Clang-14/17/AppleClang-15
 #include <cmath>
 
 
-Editor::Window::Window(FileHandler& file) : fileCursorX(0), fileCursorY(0), cols(0), rows(0), renderedCursorX(0), renderedCursorY(0), colNumberToDisplay(0), savedRenderedCursorXPos(0),
-rowOffset(0), colOffset(0), dirty(false), fileRows(file.getFileContents())
+Editor::Window::Window(FileHandler& file) : fileCursorX(0), fileCursorY(0), renderedCursorX(0), renderedCursorY(0), savedRenderedCursorXPos(0), colNumberToDisplay(0),
+rowOffset(0), colOffset(0), rows(0), cols(0), document(file.getFileContents()), dirty(false)
 {}
 
 Editor::ChangeHistory::ChangeHistory(ChangeHistory::ChangeType change, const Window& window) :
@@ -58,26 +59,32 @@ Editor::Editor(SyntaxHighlight syntax, FileHandler fileHandler, std::unique_ptr<
 {
 	mWindow = std::make_unique<Window>(Window(mFile));
 	updateWindowSize();
+	mPolicyLimits = LargeFilePolicy::loadLimits();
+	updatePolicy();
 
-	if (mSyntax.hasSyntax())
+	if (mFile.recoveredEdits() > 0)
 	{
-		mNormalColorMode = std::format("\x1b[38;5;{}m", std::to_string(mSyntax.color(SyntaxHighlight::HighlightType::Normal)));
+		mWindow->dirty = true; //The recovered edits haven't been saved yet
+		mStatusMessage = std::format("recovered {} unsaved edits", mFile.recoveredEdits());
 	}
-	else
+	else if (mFile.hasStaleJournal())
 	{
-		constexpr uint8_t white = 15;
-		mNormalColorMode = std::format("\x1b[38;5;{}m", std::to_string(white));
+		mStatusMessage = "couldn't replay unsaved edits from last session"; //The file changed since. The journal is kept as <file>.mini-journal.stale
 	}
 }
 
 void Editor::prepForRender()
 {
-	if (mWindow->fileRows->size() > 0 && !(mMode == Mode::CommandMode || mMode == Mode::FindInputMode || mMode == Mode::ReplaceInputMode)) fixRenderedCursorPosition(mWindow->fileRows->at(mWindow->fileCursorY));
+	if (mWindow->document->lineCount() > 0 && !(mMode == Mode::CommandMode || mMode == Mode::FindInputMode || mMode == Mode::ReplaceInputMode))
+	{
+		//Without tab expansion the cursor's column doesn't depend on the row's contents, so a long row isn't copied out every frame
+		fixRenderedCursorPosition(mPolicy.expandTabs() ? mWindow->document->line(mWindow->fileCursorY, 0, mWindow->fileCursorX) : std::string());
+	}
 
 	size_t rowToStart = mWindow->rowOffset;
 	size_t colToStart = 0;
 	size_t rowToEnd = mWindow->rowOffset + mWindow->rows;
-	if (mSyntax.hasSyntax())
+	if (highlightsSyntax())
 	{
 
 		std::tuple<size_t, size_t, size_t> offsets = mSyntax.removeOffScreenHighlights(mWindow->rowOffset, mWindow->rows, mWindow->fileCursorY);
@@ -98,10 +105,14 @@ void Editor::prepForRender()
 
 void Editor::setRenderedLine(const size_t startRow, const size_t endRow)
 {
-	for (size_t r = startRow; r <= endRow && r < mWindow->fileRows->size(); ++r)
-	{
-		FileHandler::Row& row = mWindow->fileRows->at(r);
-		row.renderedLine = row.line;
+	//Without tab expansion every character takes one column, so only the columns on screen are pulled out, however far into the row they are.
+	//Tabs only ever make a row wider, so otherwise nothing past colOffset + cols characters can be on screen, and very long rows are cut off there
+	const size_t startCol = mPolicy.expandTabs() ? 0 : mWindow->colOffset;
+	const size_t maxLength = mPolicy.expandTabs() ? std::max(mWindow->colOffset + mWindow->cols, longRowLength) : mWindow->cols;
+	mViewport.load(*mWindow->document, startRow, endRow, startCol, maxLength);
+	for (size_t r = mViewport.firstRow(); r < mViewport.size(); ++r)
+	{
+		ViewportCache::Line& row = mViewport.at(r);
 		if (row.renderedLine.length() > 0)
 		{
 			replaceRenderedStringTabs(row.renderedLine);
@@ -111,26 +122,21 @@ void Editor::setRenderedLine(const size_t startRow, const size_t endRow)
 
 void Editor::setRenderedLineLength()
 {
-	for (size_t y = mWindow->rowOffset; y < mWindow->fileRows->size() && y < mWindow->rows + mWindow->rowOffset; ++y)
+	const size_t skippedCols = mPolicy.expandTabs() ? mWindow->colOffset : 0; //Without tab expansion, setRenderedLine() already started at colOffset
+	for (size_t y = mWindow->rowOffset; y < mViewport.size() && y < mWindow->rows + mWindow->rowOffset; ++y)
 	{
-		FileHandler::Row& row = mWindow->fileRows->at(y);
+		std::string& renderedLine = mViewport.at(y).renderedLine;
 
-		//Set the render string length to the lesser of the console width and the line length.
-		const size_t renderedLength = std::min(static_cast<size_t>(mWindow->cols - 1), row.renderedLine.length() - mWindow->colOffset);
-		if (renderedLength > 0)
+		//Trim the render string in place to the lesser of the console width and the line length, so its buffer is kept for the next frame
+		if (skippedCols < renderedLine.length())
 		{
-			if (mWindow->colOffset < row.renderedLine.length())
-			{
-				row.renderedLine = row.renderedLine.substr(mWindow->colOffset, renderedLength);
-			}
-			else
-			{
-				row.renderedLine.clear();
-			}
+			const size_t renderedLength = std::min(static_cast<size_t>(mWindow->cols - 1), renderedLine.length() - skippedCols);
+			renderedLine.resize(skippedCols + renderedLength);
+			if (skippedCols > 0) renderedLine.erase(0, skippedCols);
 		}
 		else
 		{
-			row.renderedLine.clear();
+			renderedLine.clear();
 		}
 	}
 }
@@ -138,16 +144,22 @@ void Editor::setRenderedLineLength()
 void Editor::prepStatusForRender()
 {
 	std::string mode;
-	if (mMode == Mode::ReadMode)											mode = "READ ONLY";
+	if (mMode == Mode::ReadMode)											mode = mFile.isFollowing() ? "FOLLOWING" : "READ ONLY";
 	else if (mMode == Mode::EditMode)										mode = "EDIT";
 	else if (mMode == Mode::CommandMode)									mode = "COMMAND";
 	else if (mMode == Mode::FindInputMode || mMode == Mode::FindMode)		mode = "FIND";
 	else if (mMode == Mode::ReplaceInputMode || mMode == Mode::ReplaceMode) mode = "REPLACE";
+	if (mPolicy.isActive()) mode += " (" + mPolicy.label() + ")";
 
 	std::string rStatus;
-	if (mMode == Mode::ReadMode || mMode == Mode::EditMode)
+	if ((mMode == Mode::ReadMode || mMode == Mode::EditMode) && !mStatusMessage.empty())
 	{
-		rStatus = std::format("row {}/{} col {}", mWindow->fileCursorY + 1, mWindow->fileRows->size(), mWindow->colNumberToDisplay + 1);
+		rStatus = mStatusMessage;
+		if (!mFile.isSaving()) mStatusMessage.clear(); //"saving..." stays up until the save is done
+	}
+	else if (mMode == Mode::ReadMode || mMode == Mode::EditMode)
+	{
+		rStatus = std::format("row {}/{} col {}", mFile.firstRow() + mWindow->fileCursorY + 1, mFile.lineCount(), mWindow->colNumberToDisplay + 1);
 	}
 	else if (mMode == Mode::CommandMode)
 	{
@@ -160,36 +172,44 @@ void Editor::prepStatusForRender()
 		rStatus = std::format("match {}/{}", findPosToDisplay, mFindLocations.size());
 	}
 
-	mRenderer.setStatusBuffer(mWindow->rows + 1, mWindow->dirty, mFile.fileName(), mWindow->fileRows->size(), mWindow->fileCursorY + 1, mWindow->colNumberToDisplay + 1, mode, rStatus, mWindow->cols);
+	mRenderer.setStatusBuffer(mWindow->rows + 1, mWindow->dirty, mFile.fileName(), mFile.lineCount(), mFile.indexProgress(), mFile.firstRow() + mWindow->fileCursorY + 1, mWindow->colNumberToDisplay + 1, mode, rStatus, mWindow->cols);
 }
 
 void Editor::refreshScreen(bool forceRedrawScreen)
 {
-	mMutex.lock(); //Refresh screen may be called from a separate thread
+	mFile.waitForRows(mWindow->rowOffset + mWindow->rows + 1); //Picks up anything indexed in the background, and makes sure the screen's rows are available
+	shiftView(mFile.followRow(mWindow->fileCursorY)); //In view mode, keeps the rows around the cursor in the document
+	if (mFile.collectSave()) finishSave();
+	const FileHandler::Reload reload = mFile.reloadIfChanged(mWindow->dirty);
+	if (reload.changedOnDisk) applyReload(reload);
+	const uint64_t versionBeforeAppend = mWindow->document->version();
+	const FileHandler::Appended appended = mFile.readAppended();
+	if (appended.changed || appended.ended) followAppended(appended, versionBeforeAppend);
+	updatePolicy();
 
 	if (forceRedrawScreen)
 	{
-		mRenderer.clearScreen();
-		if (mWindow->fileRows->empty())
+		if (mWindow->document->lineCount() == 0)
 		{
 			mWindow->renderedCursorX = 0;
 			mWindow->renderedCursorY = 0;
 		}
-		else fixRenderedCursorPosition(mWindow->fileRows->at(mWindow->fileCursorY));
+		else fixRenderedCursorPosition(mPolicy.expandTabs() ? mWindow->document->line(mWindow->fileCursorY, 0, mWindow->fileCursorX) : std::string());
 	}
 
 	prepForRender();
 	updateRenderedColor();
 
-	for (size_t i = mWindow->rowOffset; i < mWindow->fileRows->size() && i < mWindow->rowOffset + mWindow->rows; ++i)
+	const size_t lineCount = mWindow->document->lineCount();
+	for (size_t i = mWindow->rowOffset; i < lineCount && i < mWindow->rowOffset + mWindow->rows; ++i)
 	{
-		mRenderer.addRenderedLineToBuffer(mWindow->fileRows->at(i).renderedLine);
+		mRenderer.addRenderedLineToBuffer(mViewport.at(i).renderedLine);
 	}
 
-	if (mWindow->rowOffset + mWindow->rows > mWindow->fileRows->size())
+	if (mWindow->rowOffset + mWindow->rows > lineCount)
 	{
-		const uint16_t rowsToEnter = mWindow->rowOffset + mWindow->rows - mWindow->fileRows->size() + 1;
-		mRenderer.addEndOfFileToBuffer(rowsToEnter, mWindow->cols, mWindow->fileRows->empty());
+		const uint16_t rowsToEnter = mWindow->rowOffset + mWindow->rows - lineCount + 1;
+		mRenderer.addEndOfFileToBuffer(rowsToEnter, mWindow->cols, lineCount == 0);
 	}
 
 	prepStatusForRender();
@@ -206,8 +226,6 @@ void Editor::refreshScreen(bool forceRedrawScreen)
 
 	mRenderer.setCursorBuffer(mWindow->renderedCursorY + 1, mWindow->renderedCursorX + 1);
 	mRenderer.renderScreen(forceRedrawScreen, renderCommandBuffer);
-
-	mMutex.unlock(); //Finally unlock the mutex so main thread and secondary thread can do their thing
 }
 
 int8_t Editor::moveCursorLeftRight(const KeyActions::KeyAction key)
@@ -216,10 +234,11 @@ int8_t Editor::moveCursorLeftRight(const KeyActions::KeyAction key)
 
 	if (isForward)
 	{
-		if (mWindow->fileCursorY == mWindow->fileRows->size() - 1 
-		 && mWindow->fileCursorX == mWindow->fileRows->at(mWindow->fileCursorY).line.length()) return cursorCantMove; //Can't move any farther right if we are at the end of the file
+		const size_t lineLength = mWindow->document->lineLength(mWindow->fileCursorY);
+		if (mWindow->fileCursorY == mWindow->document->lineCount() - 1 
+		 && mWindow->fileCursorX == lineLength) return cursorCantMove; //Can't move any farther right if we are at the end of the file
 
-		if (mWindow->fileCursorX == mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+		if (mWindow->fileCursorX == lineLength)
 		{
 			++mWindow->fileCursorY;
 			mWindow->fileCursorX = 0;
@@ -233,7 +252,7 @@ int8_t Editor::moveCursorLeftRight(const KeyActions::KeyAction key)
 		if (mWindow->fileCursorX == 0)
 		{
 			--mWindow->fileCursorY;
-			mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+			mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 			return cursorMovedNewLine;
 		}
 	}
@@ -243,7 +262,11 @@ int8_t Editor::moveCursorLeftRight(const KeyActions::KeyAction key)
 
 void Editor::moveCursor(const KeyActions::KeyAction key)
 {
-	if (mWindow->fileRows->size() == 0) return;
+	//While a large file is still being indexed, only wait for the rows the cursor can actually reach
+	if (key == KeyActions::KeyAction::CtrlEnd) mFile.waitForIndex();
+	else mFile.waitForRows(std::max(mWindow->fileCursorY, mWindow->rowOffset) + (mWindow->rows * 2) + 1);
+
+	if (mWindow->document->lineCount() == 0) return;
 
 	int8_t returnCode = 0;
 	if (key == KeyActions::KeyAction::ArrowLeft || key == KeyActions::KeyAction::ArrowRight 
@@ -286,9 +309,9 @@ void Editor::moveCursor(const KeyActions::KeyAction key)
 		break;
 
 	case KeyActions::KeyAction::ArrowDown:
-		if (mWindow->fileCursorY == mWindow->fileRows->size() - 1)
+		if (mWindow->fileCursorY == mWindow->document->lineCount() - 1)
 		{
-			mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+			mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 			return;
 		}
 
@@ -302,7 +325,7 @@ void Editor::moveCursor(const KeyActions::KeyAction key)
 			while (mWindow->fileCursorX > 0)
 			{
 				--mWindow->fileCursorX;
-				char charToFind = mWindow->fileRows->at(mWindow->fileCursorY).line[mWindow->fileCursorX];
+				char charToFind = mWindow->document->at(mWindow->fileCursorY, mWindow->fileCursorX);
 				if (separators.find(charToFind) != std::string::npos) break;
 			}
 		} 
@@ -311,10 +334,11 @@ void Editor::moveCursor(const KeyActions::KeyAction key)
 	case KeyActions::KeyAction::CtrlArrowRight:
 		if(returnCode == cursorMoveNormal)
 		{
-			while (mWindow->fileCursorX < mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+			const size_t lineLength = mWindow->document->lineLength(mWindow->fileCursorY);
+			while (mWindow->fileCursorX < lineLength)
 			{
 				++mWindow->fileCursorX;
-				char charToFind = mWindow->fileRows->at(mWindow->fileCursorY).line[mWindow->fileCursorX];
+				char charToFind = mWindow->document->at(mWindow->fileCursorY, mWindow->fileCursorX);
 				if (separators.find(charToFind) != std::string::npos) break;
 			}
 		}
@@ -325,39 +349,41 @@ void Editor::moveCursor(const KeyActions::KeyAction key)
 		break;
 		
 	case KeyActions::KeyAction::End:
-		mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+		mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 		break;
 
 	case KeyActions::KeyAction::CtrlHome:
+		shiftView(mFile.showRow(0));
 		mWindow->fileCursorX = 0; mWindow->fileCursorY = 0;
 		break;
 
 	case KeyActions::KeyAction::CtrlEnd:
-		mWindow->fileCursorY = mWindow->fileRows->size() - 1;
-		mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+		shiftView(mFile.showRow(std::string::npos));
+		mWindow->fileCursorY = mWindow->document->lineCount() - 1;
+		mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 		break;
 
 	case KeyActions::KeyAction::CtrlPageUp: //Move cursor to top of screen
 		mWindow->fileCursorY -= (mWindow->fileCursorY - mWindow->rowOffset) % mWindow->rows;
-		if (mWindow->fileCursorX > mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+		if (mWindow->fileCursorX > mWindow->document->lineLength(mWindow->fileCursorY))
 		{
-			mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+			mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 		}
 		break;
 
 	case KeyActions::KeyAction::CtrlPageDown: //Move cursor to bottom of screen
-		if (mWindow->fileCursorY + mWindow->rows - ((mWindow->fileCursorY - mWindow->rowOffset) % mWindow->rows) > mWindow->fileRows->size() - 1)
+		if (mWindow->fileCursorY + mWindow->rows - ((mWindow->fileCursorY - mWindow->rowOffset) % mWindow->rows) > mWindow->document->lineCount() - 1)
 		{
-			mWindow->fileCursorY = mWindow->fileRows->size() - 1;
+			mWindow->fileCursorY = mWindow->document->lineCount() - 1;
 		}
 		else
 		{
 			mWindow->fileCursorY += mWindow->rows - ((mWindow->fileCursorY - mWindow->rowOffset) % mWindow->rows);
 		}
 
-		if (mWindow->fileCursorX > mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+		if (mWindow->fileCursorX > mWindow->document->lineLength(mWindow->fileCursorY))
 		{
-			mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+			mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 		}
 		break;
 
@@ -368,15 +394,16 @@ void Editor::moveCursor(const KeyActions::KeyAction key)
 
 void Editor::shiftRowOffset(const KeyActions::KeyAction key)
 {
-	if (mWindow->fileRows->size() == 0) return;
+	mFile.waitForRows(std::max(mWindow->fileCursorY, mWindow->rowOffset) + (mWindow->rows * 2) + 1);
+	if (mWindow->document->lineCount() == 0) return;
 
 	switch (key)
 	{
 	case KeyActions::KeyAction::CtrlArrowDown:
-		if (mWindow->rowOffset == mWindow->fileRows->size() - 1) return; //This is as far as the screen can be moved down
+		if (mWindow->rowOffset == mWindow->document->lineCount() - 1) return; //This is as far as the screen can be moved down
 
 		++mWindow->rowOffset;
-		if (mWindow->fileCursorY < mWindow->fileRows->size() && mWindow->renderedCursorY == 0) //Move the file cursor if the rendered cursor is at the top of the screen
+		if (mWindow->fileCursorY < mWindow->document->lineCount() && mWindow->renderedCursorY == 0) //Move the file cursor if the rendered cursor is at the top of the screen
 		{
 			moveCursor(KeyActions::KeyAction::ArrowDown);
 		}
@@ -404,18 +431,18 @@ void Editor::shiftRowOffset(const KeyActions::KeyAction key)
 			if (mWindow->rowOffset >= mWindow->rows) mWindow->rowOffset -= mWindow->rows;
 			else mWindow->rowOffset = 0;
 		}
-		if (mWindow->fileCursorX > mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+		if (mWindow->fileCursorX > mWindow->document->lineLength(mWindow->fileCursorY))
 		{
-			mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+			mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 		}
 		break;
 
 	case KeyActions::KeyAction::PageDown: //Shift screen offset down by 1 page worth (mWindow->rows)
-		if (mWindow->fileCursorY + mWindow->rows > mWindow->fileRows->size() - 1)
+		if (mWindow->fileCursorY + mWindow->rows > mWindow->document->lineCount() - 1)
 		{
-			if (mWindow->fileCursorY == mWindow->fileRows->size() - 1) return;
+			if (mWindow->fileCursorY == mWindow->document->lineCount() - 1) return;
 
-			mWindow->fileCursorY = mWindow->fileRows->size() - 1;
+			mWindow->fileCursorY = mWindow->document->lineCount() - 1;
 			mWindow->rowOffset += mWindow->fileCursorY % mWindow->rows;
 		}
 		else
@@ -423,9 +450,9 @@ void Editor::shiftRowOffset(const KeyActions::KeyAction key)
 			mWindow->fileCursorY += mWindow->rows;
 			mWindow->rowOffset += mWindow->rows;
 		}
-		if (mWindow->fileCursorX > mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+		if (mWindow->fileCursorX > mWindow->document->lineLength(mWindow->fileCursorY))
 		{
-			mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+			mWindow->fileCursorX = mWindow->document->lineLength(mWindow->fileCursorY);
 		}
 		break;
 
@@ -440,23 +467,7 @@ void Editor::addRow()
 
 	addUndoHistory(ChangeHistory::ChangeType::RowInserted);
 
-	FileHandler::Row& row = mWindow->fileRows->at(mWindow->fileCursorY);
-
-	if (mWindow->fileCursorX == row.line.length())
-	{
-		mWindow->fileRows->insert(mWindow->fileRows->begin() + mWindow->fileCursorY + 1, FileHandler::Row());
-	}
-	else if (mWindow->fileCursorX == 0)
-	{
-		mWindow->fileRows->insert(mWindow->fileRows->begin() + mWindow->fileCursorY, FileHandler::Row());
-	}
-	else
-	{
-		FileHandler::Row newRow;
-		newRow.line = row.line.substr(mWindow->fileCursorX);
-		row.line.erase(row.line.begin() + mWindow->fileCursorX, row.line.end());
-		mWindow->fileRows->insert(mWindow->fileRows->begin() + mWindow->fileCursorY + 1, newRow);
-	}
+	mWindow->document->insert(mWindow->fileCursorY, mWindow->fileCursorX, "\n"); //Splitting the row moves everything past the cursor onto the new row
 
 	mWindow->fileCursorX = 0; ++mWindow->fileCursorY;
 	mWindow->dirty = true;
@@ -465,23 +476,21 @@ void Editor::addRow()
 
 void Editor::deleteRow(const size_t fileCursor, const size_t rowNumToAppend)
 {
-	if (fileCursor >= mWindow->fileRows->size() || rowNumToAppend >= mWindow->fileRows->size()) return;
+	if (fileCursor >= mWindow->document->lineCount() || rowNumToAppend >= mWindow->document->lineCount()) return;
 
 	addUndoHistory(ChangeHistory::ChangeType::RowDeleted, rowNumToAppend - mWindow->fileCursorY);
 
-	mWindow->fileCursorX = mWindow->fileRows->at(fileCursor).line.length();
+	mWindow->fileCursorX = mWindow->document->lineLength(fileCursor);
 	mWindow->fileCursorY = fileCursor;
 
-	const FileHandler::Row& row = mWindow->fileRows->at(rowNumToAppend);
-	mWindow->fileRows->at(fileCursor).line.append(row.line);
-	mWindow->fileRows->erase(mWindow->fileRows->begin() + fileCursor + 1);
+	mWindow->document->erase(fileCursor, mWindow->fileCursorX, 1); //Erasing the line break appends the next row onto this one
 }
 
 void Editor::deleteChar(const KeyActions::KeyAction key)
 {
 	clearRedoHistory();
 
-	FileHandler::Row& row = mWindow->fileRows->at(mWindow->fileCursorY);
+	const size_t lineLength = mWindow->document->lineLength(mWindow->fileCursorY);
 	switch (key)
 	{
 	case KeyActions::KeyAction::Backspace:
@@ -497,25 +506,25 @@ void Editor::deleteChar(const KeyActions::KeyAction key)
 		else
 		{
 			addUndoHistory(ChangeHistory::ChangeType::CharDeleted, -1);
-			row.line.erase(row.line.begin() + mWindow->fileCursorX - 1);
+			mWindow->document->erase(mWindow->fileCursorY, mWindow->fileCursorX - 1, 1);
 			--mWindow->fileCursorX;
 		}
 		break;
 
 	case KeyActions::KeyAction::Delete:
-		if (mWindow->fileCursorY == mWindow->fileRows->size() - 1 && mWindow->fileCursorX == row.line.length())
+		if (mWindow->fileCursorY == mWindow->document->lineCount() - 1 && mWindow->fileCursorX == lineLength)
 		{
 			return;
 		}
 
-		if (mWindow->fileCursorX == row.line.length())
+		if (mWindow->fileCursorX == lineLength)
 		{
 			deleteRow(mWindow->fileCursorY, mWindow->fileCursorY + 1);
 		}
 		else
 		{
 			addUndoHistory(ChangeHistory::ChangeType::CharDeleted, 1);
-			row.line.erase(row.line.begin() + mWindow->fileCursorX);
+			mWindow->document->erase(mWindow->fileCursorY, mWindow->fileCursorX, 1);
 		}
 		break;
 
@@ -533,11 +542,11 @@ void Editor::deleteChar(const KeyActions::KeyAction key)
 		{
 			int16_t charsDeleted = 0;
 			size_t findPos;
-			if ((findPos = row.line.substr(0, mWindow->fileCursorX).find_last_of(separators)) == std::string::npos) //Delete everything in the row to the beginning
+			if ((findPos = mWindow->document->line(mWindow->fileCursorY, 0, mWindow->fileCursorX).find_last_of(separators)) == std::string::npos) //Delete everything in the row to the beginning
 			{
 				charsDeleted = mWindow->fileCursorX;
 				addUndoHistory(ChangeHistory::ChangeType::CharDeleted, -charsDeleted);
-				row.line.erase(row.line.begin(), row.line.begin() + mWindow->fileCursorX);
+				mWindow->document->erase(mWindow->fileCursorY, 0, mWindow->fileCursorX);
 				mWindow->fileCursorX = 0;
 			}
 			else if (findPos == mWindow->fileCursorX - 1)
@@ -549,19 +558,19 @@ void Editor::deleteChar(const KeyActions::KeyAction key)
 			{
 				charsDeleted = mWindow->fileCursorX - findPos + 1;
 				addUndoHistory(ChangeHistory::ChangeType::CharDeleted, -charsDeleted);
-				row.line.erase(row.line.begin() + findPos + 1, row.line.begin() + mWindow->fileCursorX);
+				mWindow->document->erase(mWindow->fileCursorY, findPos + 1, mWindow->fileCursorX - findPos - 1);
 				mWindow->fileCursorX = findPos + 1;
 			}
 		}
 		break;
 
 	case KeyActions::KeyAction::CtrlDelete:
-		if (mWindow->fileCursorY == mWindow->fileRows->size() - 1 && mWindow->fileCursorX == row.line.length())
+		if (mWindow->fileCursorY == mWindow->document->lineCount() - 1 && mWindow->fileCursorX == lineLength)
 		{
 			return;
 		}
 
-		if (mWindow->fileCursorX == row.line.length())
+		if (mWindow->fileCursorX == lineLength)
 		{
 			deleteRow(mWindow->fileCursorY, mWindow->fileCursorY + 1);
 		}
@@ -569,11 +578,11 @@ void Editor::deleteChar(const KeyActions::KeyAction key)
 		{
 			int16_t charsDeleted = 0;
 			size_t findPos;
-			if ((findPos = row.line.substr(mWindow->fileCursorX).find_first_of(separators)) == std::string::npos) //Delete everything in the row to the beginning
+			if ((findPos = mWindow->document->line(mWindow->fileCursorY, mWindow->fileCursorX, std::string::npos).find_first_of(separators)) == std::string::npos) //Delete everything in the row to the beginning
 			{
-				charsDeleted = row.line.length() - mWindow->fileCursorX;
+				charsDeleted = lineLength - mWindow->fileCursorX;
 				addUndoHistory(ChangeHistory::ChangeType::CharDeleted, charsDeleted);
-				row.line.erase(row.line.begin() + mWindow->fileCursorX, row.line.end());
+				mWindow->document->erase(mWindow->fileCursorY, mWindow->fileCursorX, charsDeleted);
 			}
 			else if (findPos == 0)
 			{
@@ -584,7 +593,7 @@ void Editor::deleteChar(const KeyActions::KeyAction key)
 			{
 				charsDeleted = findPos - mWindow->fileCursorX;
 				addUndoHistory(ChangeHistory::ChangeType::CharDeleted, charsDeleted);
-				row.line.erase(row.line.begin() + mWindow->fileCursorX, row.line.begin() + findPos + mWindow->fileCursorX);
+				mWindow->document->erase(mWindow->fileCursorY, mWindow->fileCursorX, findPos);
 			}
 		}
 		break;
@@ -598,16 +607,62 @@ void Editor::insertChar(const unsigned char c)
 {
 	clearRedoHistory();
 
-	FileHandler::Row& row = mWindow->fileRows->at(mWindow->fileCursorY);
+	//Typing straight on from the last change adds to it, if the file is large enough for undo to go a run of typing at a time
+	const char inserted = static_cast<char>(c);
+	const bool continuesTyping = mPolicy.groupTypingUndo() && !mFileHistory.empty() && mFileHistory.front().changeType == ChangeHistory::ChangeType::CharInserted
+		&& mFileHistory.front().rowChanged == mWindow->fileCursorY && mFileHistory.front().colChanged + mFileHistory.front().changeMade.length() == mWindow->fileCursorX;
+	if (!continuesTyping) addUndoHistory(ChangeHistory::ChangeType::CharInserted);
+	mFileHistory.front().changeMade.push_back(inserted);
 
-	addUndoHistory(ChangeHistory::ChangeType::CharInserted);
-
-	row.line.insert(row.line.begin() + mWindow->fileCursorX, c);
+	mWindow->document->insert(mWindow->fileCursorY, mWindow->fileCursorX, std::string_view(&inserted, 1));
 	++mWindow->fileCursorX;
 	mWindow->dirty = true;
 	mWindow->updateSavedPos = true;
 }
 
+void Editor::insertFile(const std::string_view fileName)
+{
+	if (mFile.isViewOnly()) return;
+
+	std::string text;
+	if (FileHandler::readText(std::filesystem::path(fileName), text) < 0)
+	{
+		mStatusMessage = std::format("couldn't open {}", fileName);
+		return;
+	}
+	if (text.empty())
+	{
+		mStatusMessage = std::format("{} is empty", fileName);
+		return;
+	}
+
+	mFile.waitForIndex(); //The document can't be edited until the whole file is indexed
+	clearRedoHistory();
+	addUndoHistory(ChangeHistory::ChangeType::TextInserted);
+
+	const size_t row = mWindow->fileCursorY, col = mWindow->fileCursorX;
+	mWindow->document->insert(row, col, text);
+	moveCursorPastInserted(row, col, text);
+	const size_t rowsInserted = mWindow->fileCursorY - row + ((text.back() == '\n') ? 0 : 1);
+	mStatusMessage = std::format("inserted {} rows from {}", rowsInserted, fileName);
+	mFileHistory.front().changeMade = std::move(text); //Kept for redo. The document has its own copy
+	mWindow->dirty = true;
+	mWindow->updateSavedPos = true;
+}
+
+void Editor::moveCursorPastInserted(const size_t row, const size_t col, const std::string_view text)
+{
+	const size_t lastLineBreak = text.rfind('\n');
+	if (lastLineBreak == std::string_view::npos)
+	{
+		mWindow->fileCursorY = row;
+		mWindow->fileCursorX = col + text.length();
+		return;
+	}
+	mWindow->fileCursorY = row + std::count(text.begin(), text.end(), '\n');
+	mWindow->fileCursorX = text.length() - lastLineBreak - 1;
+}
+
 void Editor::clearRedoHistory()
 {
 	while (mRedoCounter > 0)
@@ -630,20 +685,25 @@ void Editor::addUndoHistory(ChangeHistory::ChangeType change, const int16_t offs
 		history.rowChanged = mWindow->fileCursorY;
 		history.colChanged = mWindow->fileCursorX;
 		if (offset < 0) history.colChanged += offset;
-		history.changeMade = mWindow->fileRows->at(history.rowChanged).line.substr(history.colChanged, std::abs(offset));
+		history.changeMade = mWindow->document->line(history.rowChanged, history.colChanged, std::abs(offset));
 	}
 	else if (change == ChangeHistory::ChangeType::RowInserted)
 	{
 		history.rowChanged = mWindow->fileCursorY;
 		history.colChanged = mWindow->fileCursorX;
-		history.changeMade = mWindow->fileRows->at(history.rowChanged).line.substr(mWindow->fileCursorX);
+		history.changeMade = mWindow->document->line(history.rowChanged, mWindow->fileCursorX, std::string::npos);
 	}
 	else if (change == ChangeHistory::ChangeType::RowDeleted)
 	{
 		history.rowChanged = mWindow->fileCursorY + offset;
 		history.colChanged = mWindow->fileCursorX;
-		history.changeMade = mWindow->fileRows->at(history.rowChanged).line;
-		history.prevLineLength = mWindow->fileRows->at(history.rowChanged - 1).line.length();
+		history.changeMade = mWindow->document->line(history.rowChanged);
+		history.prevLineLength = mWindow->document->lineLength(history.rowChanged - 1);
+	}
+	else if (change == ChangeHistory::ChangeType::TextInserted)
+	{
+		history.rowChanged = mWindow->fileCursorY;
+		history.colChanged = mWindow->fileCursorX;
 	}
 	mFileHistory.push_front(std::move(history));
 }
@@ -666,6 +726,14 @@ Editor::ChangeHistory::ChangeType Editor::reverseChangeType(ChangeHistory::Chang
 	{
 		return ChangeHistory::ChangeType::RowInserted;
 	}
+	else if (current == ChangeHistory::ChangeType::TextInserted)
+	{
+		return ChangeHistory::ChangeType::TextDeleted;
+	}
+	else if (current == ChangeHistory::ChangeType::TextDeleted)
+	{
+		return ChangeHistory::ChangeType::TextInserted;
+	}
 	return ChangeHistory::ChangeType::None;
 }
 
@@ -680,11 +748,11 @@ void Editor::addRedoHistory(ChangeHistory history)
 	history.changeType = reverseChangeType(history.changeType);
 	if (history.changeType == ChangeHistory::ChangeType::CharDeleted)
 	{
-		history.changeMade = mWindow->fileRows->at(history.rowChanged).line.substr(history.colChanged, 1);
+		history.changeMade = mWindow->document->line(history.rowChanged, history.colChanged, history.changeMade.length());
 	}
 	else if (history.changeType == ChangeHistory::ChangeType::RowDeleted)
 	{
-		history.prevLineLength = mWindow->fileRows->at(history.rowChanged).line.length();
+		history.prevLineLength = mWindow->document->lineLength(history.rowChanged);
 	}
 	mFileHistory.push_back(history);
 	++mRedoCounter;
@@ -704,21 +772,27 @@ void Editor::undoChange()
 
 	if (undo.changeType == ChangeHistory::ChangeType::CharInserted)
 	{
-		mWindow->fileRows->at(undo.rowChanged).line.erase(undo.colChanged, 1);
+		mWindow->document->erase(undo.rowChanged, undo.colChanged, undo.changeMade.length());
 	}
 	else if (undo.changeType == ChangeHistory::ChangeType::CharDeleted)
 	{
-		mWindow->fileRows->at(undo.rowChanged).line.insert(undo.colChanged, undo.changeMade);
+		mWindow->document->insert(undo.rowChanged, undo.colChanged, undo.changeMade);
 	}
 	else if (undo.changeType == ChangeHistory::ChangeType::RowInserted)
 	{
-		mWindow->fileRows->at(undo.rowChanged).line.insert(undo.colChanged, undo.changeMade);
-		mWindow->fileRows->erase(mWindow->fileRows->begin() + undo.rowChanged + 1);
+		mWindow->document->erase(undo.rowChanged, undo.colChanged, 1); //Joins the split row back together
 	}
 	else if (undo.changeType == ChangeHistory::ChangeType::RowDeleted)
 	{
-		mWindow->fileRows->insert(mWindow->fileRows->begin() + undo.rowChanged, FileHandler::Row(undo.changeMade));
-		mWindow->fileRows->at(undo.rowChanged - 1).line.resize(undo.prevLineLength);
+		mWindow->document->insert(undo.rowChanged - 1, undo.prevLineLength, "\n"); //Splits the joined row back apart
+	}
+	else if (undo.changeType == ChangeHistory::ChangeType::TextInserted)
+	{
+		mWindow->document->erase(undo.rowChanged, undo.colChanged, undo.changeMade.length());
+	}
+	else if (undo.changeType == ChangeHistory::ChangeType::TextDeleted)
+	{
+		mWindow->document->insert(undo.rowChanged, undo.colChanged, undo.changeMade);
 	}
 
 	mFileHistory.pop_front();
@@ -738,41 +812,205 @@ void Editor::redoChange()
 
 	if (redo.changeType == ChangeHistory::ChangeType::CharInserted)
 	{
-		mWindow->fileRows->at(redo.rowChanged).line.erase(redo.colChanged, redo.changeMade.length());
+		mWindow->document->erase(redo.rowChanged, redo.colChanged, redo.changeMade.length());
 	}
 	else if (redo.changeType == ChangeHistory::ChangeType::CharDeleted)
 	{
-		mWindow->fileRows->at(redo.rowChanged).line.insert(redo.colChanged, redo.changeMade);
-		if (redo.fileCursorX == redo.colChanged) ++mWindow->fileCursorX;
+		mWindow->document->insert(redo.rowChanged, redo.colChanged, redo.changeMade);
+		if (redo.fileCursorX == redo.colChanged) mWindow->fileCursorX += redo.changeMade.length();
 	}
 	else if (redo.changeType == ChangeHistory::ChangeType::RowInserted)
 	{
-		mWindow->fileRows->at(redo.rowChanged - 1).line.insert(redo.prevLineLength, redo.changeMade);
-		mWindow->fileRows->erase(mWindow->fileRows->begin() + redo.rowChanged);
+		mWindow->document->erase(redo.rowChanged - 1, redo.prevLineLength, 1);
 		mWindow->fileCursorY = redo.rowChanged - 1;
 		mWindow->fileCursorX = redo.prevLineLength;
 	}
 	else if (redo.changeType == ChangeHistory::ChangeType::RowDeleted)
 	{
-		mWindow->fileRows->insert(mWindow->fileRows->begin() + redo.rowChanged + 1, FileHandler::Row(redo.changeMade));
-		mWindow->fileRows->at(redo.rowChanged).line.resize(redo.prevLineLength);
+		mWindow->document->insert(redo.rowChanged, redo.prevLineLength, "\n");
 		mWindow->fileCursorX = 0;
 		++mWindow->fileCursorY;
 	}
+	else if (redo.changeType == ChangeHistory::ChangeType::TextInserted)
+	{
+		mWindow->document->erase(redo.rowChanged, redo.colChanged, redo.changeMade.length());
+		mWindow->fileCursorY = redo.rowChanged;
+	}
+	else if (redo.changeType == ChangeHistory::ChangeType::TextDeleted)
+	{
+		mWindow->document->insert(redo.rowChanged, redo.colChanged, redo.changeMade);
+		moveCursorPastInserted(redo.rowChanged, redo.colChanged, redo.changeMade);
+	}
 
 	mFileHistory.pop_back();
 	--mRedoCounter;
 }
 
-const bool Editor::isDirty() const
+const bool Editor::isDirty()
 {
+	if (mFile.waitForSave()) finishSave(); //A save that is still being written counts once it is done
 	return mWindow->dirty;
 }
 
-void Editor::save()
+void Editor::save(const bool sync)
 {
-	mFile.saveFile();
-	mWindow->dirty = false;
+	if (mFile.isViewOnly()) return;
+	if (mFile.waitForSave()) finishSave();
+	mFile.saveFileInBackground(sync);
+	mStatusMessage = "saving...";
+}
+
+void Editor::finishSave()
+{
+	const FileHandler::SaveStats& stats = mFile.lastSave();
+	if (!stats.error.empty())
+	{
+		mStatusMessage = "save failed: " + stats.error;
+		return;
+	}
+
+	//Anything typed while the save was being written isn't in the file yet
+	if (stats.version == mWindow->document->version()) mWindow->dirty = false;
+	mStatusMessage = std::format("saved {} bytes ({} unchanged), {:.1f} MB/s", stats.bytes, stats.bytesCopied, stats.bytesPerSecond() / (1024 * 1024));
+}
+
+void Editor::applyReload(const FileHandler::Reload& reload)
+{
+	if (!reload.reloaded)
+	{
+		if (reload.lostBytes > 0) mStatusMessage = std::format("file truncated on disk, {} bytes of unedited text are lost", reload.lostBytes);
+		else mStatusMessage = mWindow->dirty ? "file changed on disk, not reloaded because of unsaved changes" : "file removed from disk";
+		return;
+	}
+
+	if (reload.wholeFile)
+	{
+		documentReplaced();
+		mStatusMessage = "reloaded from disk";
+		return;
+	}
+
+	if (reload.oldEndRow == reload.firstRow)
+	{
+		mStatusMessage = "reloaded from disk, no rows changed";
+		return;
+	}
+
+	const size_t lineCount = mWindow->document->lineCount();
+	const size_t lastRow = (lineCount == 0) ? 0 : lineCount - 1;
+
+	//Rows after the replaced ones are the same text, just moved. Rows inside stay inside the new rows, which there is always at least one of
+	const size_t newEndRow = reload.oldEndRow + reload.rowDelta;
+	auto moveRow = [&reload, newEndRow](const size_t row)
+		{
+			if (row >= reload.oldEndRow) return static_cast<size_t>(static_cast<int64_t>(row) + reload.rowDelta);
+			if (row >= reload.firstRow) return std::min(row, newEndRow - 1);
+			return row;
+		};
+	mWindow->fileCursorY = std::min(moveRow(mWindow->fileCursorY), lastRow);
+	mWindow->rowOffset = std::min(moveRow(mWindow->rowOffset), mWindow->fileCursorY);
+	mWindow->fileCursorX = std::min(mWindow->fileCursorX, mWindow->document->lineLength(mWindow->fileCursorY));
+
+	std::erase_if(mSyntax.highlights(), [&reload](const SyntaxHighlight::HighlightLocation& highlight)
+		{
+			return highlight.startRow < reload.oldEndRow && highlight.endRow >= reload.firstRow;
+		});
+	for (SyntaxHighlight::HighlightLocation& highlight : mSyntax.highlights())
+	{
+		highlight.startRow = moveRow(highlight.startRow);
+		highlight.endRow = moveRow(highlight.endRow);
+	}
+
+	std::erase_if(mFindLocations, [&reload](const FindAndReplace::FindLocation& location)
+		{
+			return location.row >= reload.firstRow && location.row < reload.oldEndRow;
+		});
+	for (FindAndReplace::FindLocation& location : mFindLocations)
+	{
+		if (location.row >= reload.oldEndRow) location.row = moveRow(location.row); //filePos and startCol are columns in the row, so they don't move
+	}
+	mCurrentFindPos = std::min(mCurrentFindPos, mFindLocations.empty() ? 0 : mFindLocations.size() - 1);
+
+	//An undo that changed one of the replaced rows, or the row break just before them, can't be applied to the new text
+	const bool historyTouchesReload = std::any_of(mFileHistory.begin(), mFileHistory.end(), [&reload](const ChangeHistory& change)
+		{
+			const size_t lastChangedRow = change.rowChanged + std::count(change.changeMade.begin(), change.changeMade.end(), '\n') + 1;
+			return lastChangedRow >= reload.firstRow && change.rowChanged < reload.oldEndRow;
+		});
+	if (historyTouchesReload)
+	{
+		mFileHistory.clear();
+		mRedoCounter = 0;
+	}
+	for (ChangeHistory& change : mFileHistory)
+	{
+		change.rowChanged = moveRow(change.rowChanged);
+		change.fileCursorY = moveRow(change.fileCursorY);
+		change.rowOffset = moveRow(change.rowOffset);
+	}
+
+	mStatusMessage = std::format("reloaded rows {}-{} from disk", reload.firstRow + 1, newEndRow);
+}
+
+void Editor::followAppended(const FileHandler::Appended& appended, const uint64_t previousVersion)
+{
+	if (appended.truncated)
+	{
+		documentReplaced();
+		mStatusMessage = "file got shorter, loaded again";
+		return;
+	}
+	if (appended.ended) mStatusMessage = "end of input";
+	if (!appended.changed) return;
+	mViewport.keepRowsBefore(*mWindow->document, previousVersion, appended.firstRow);
+
+	//Like tail -f, but only while the cursor is at the end, so scrolling back through the file isn't interrupted
+	if (mWindow->fileCursorY != appended.firstRow) return;
+	mWindow->fileCursorY = mWindow->document->lineCount() - 1;
+	mWindow->fileCursorX = std::min(mWindow->fileCursorX, mWindow->document->lineLength(mWindow->fileCursorY));
+	if (mWindow->fileCursorY >= mWindow->rowOffset + mWindow->rows) mWindow->rowOffset = mWindow->fileCursorY - mWindow->rows + 1;
+}
+
+void Editor::documentReplaced()
+{
+	const size_t lineCount = mWindow->document->lineCount();
+	mWindow->fileCursorY = std::min(mWindow->fileCursorY, (lineCount == 0) ? 0 : lineCount - 1);
+	mWindow->rowOffset = std::min(mWindow->rowOffset, mWindow->fileCursorY);
+	mWindow->fileCursorX = (lineCount == 0) ? 0 : std::min(mWindow->fileCursorX, mWindow->document->lineLength(mWindow->fileCursorY));
+	mSyntax.highlights().clear();
+	mFindLocations.clear();
+	mFileHistory.clear();
+	mRedoCounter = 0;
+}
+
+void Editor::updatePolicy()
+{
+	const LargeFilePolicy policy(mPolicyLimits, mFile.fileSize(), mFile.lineCount(), mFile.longestRow());
+	if (policy == mPolicy) return;
+	mPolicy = policy;
+	if (!mPolicy.syntaxHighlighting()) mSyntax.highlights().clear();
+}
+
+const bool Editor::highlightsSyntax() const
+{
+	return mSyntax.hasSyntax() && mPolicy.syntaxHighlighting();
+}
+
+const size_t Editor::renderedFindColumn(const FindAndReplace::FindLocation& location) const
+{
+	if (mFindColumnsRendered) return location.startCol;
+	return location.startCol + getRenderedTabSpaces(mWindow->document->line(location.row, 0, location.startCol), location.startCol);
+}
+
+void Editor::setLargeFileLimits(const LargeFilePolicy::Limits& limits)
+{
+	mPolicyLimits = limits;
+	updatePolicy();
+}
+
+const LargeFilePolicy& Editor::largeFilePolicy() const
+{
+	return mPolicy;
 }
 
 void Editor::enableCommandMode()
@@ -805,9 +1043,11 @@ void Editor::enableReplaceMode()
 
 void Editor::enableEditMode()
 {
-	if (mWindow->fileRows->size() == 0)
+	if (mFile.isViewOnly()) return;
+	mFile.waitForIndex(); //The document can't be edited until the whole file is indexed
+	if (mWindow->document->lineCount() == 0)
 	{
-		mWindow->fileRows->push_back(FileHandler::Row());
+		mWindow->document->pushBackLine();
 	}
 	mMode = Mode::EditMode;
 }
@@ -826,18 +1066,32 @@ void Editor::enableExitMode()
 
 void Editor::setCursorLinePosition()
 {
-	if (mWindow->renderedCursorX > mWindow->fileRows->at(mWindow->fileCursorY).renderedLine.length())
+	if (!mPolicy.expandTabs())
 	{
-		mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+		//Every character takes one column, so the row doesn't need to be walked
+		const size_t lineLength = mWindow->document->lineLength(mWindow->fileCursorY);
+		const size_t visibleLength = (mWindow->colOffset < lineLength) ? std::min(static_cast<size_t>(mWindow->cols - 1), lineLength - mWindow->colOffset) : 0;
+		mWindow->fileCursorX = (mWindow->renderedCursorX > visibleLength) ? lineLength : std::min(mWindow->savedRenderedCursorXPos, lineLength);
+		return;
+	}
+
+	const std::string line = mWindow->document->line(mWindow->fileCursorY);
+
+	//The part of the row that is visible on screen, the same length setRenderedLineLength() would give it
+	const size_t renderedLength = line.length() + getRenderedTabSpaces(line, line.length());
+	const size_t visibleLength = (mWindow->colOffset < renderedLength) ? std::min(static_cast<size_t>(mWindow->cols - 1), renderedLength - mWindow->colOffset) : 0;
+	if (mWindow->renderedCursorX > visibleLength)
+	{
+		mWindow->fileCursorX = line.length();
 		return;
 	}
 
 	mWindow->fileCursorX = 0;
-	size_t spaces = getRenderedTabSpaces(mWindow->fileRows->at(mWindow->fileCursorY), mWindow->fileCursorX);
+	size_t spaces = getRenderedTabSpaces(line, mWindow->fileCursorX);
 	while (mWindow->fileCursorX + spaces < mWindow->savedRenderedCursorXPos)
 	{
 		++mWindow->fileCursorX;
-		spaces = getRenderedTabSpaces(mWindow->fileRows->at(mWindow->fileCursorY), mWindow->fileCursorX);
+		spaces = getRenderedTabSpaces(line, mWindow->fileCursorX);
 	}
 
 	if (mWindow->fileCursorX + spaces > mWindow->savedRenderedCursorXPos)
@@ -845,26 +1099,27 @@ void Editor::setCursorLinePosition()
 		--mWindow->fileCursorX;
 	}
 
-	if (mWindow->fileCursorX > mWindow->fileRows->at(mWindow->fileCursorY).line.length())
+	if (mWindow->fileCursorX > line.length())
 	{
-		mWindow->fileCursorX = mWindow->fileRows->at(mWindow->fileCursorY).line.length();
+		mWindow->fileCursorX = line.length();
 	}
 }
 
-void Editor::fixRenderedCursorPosition(const FileHandler::Row& row)
+void Editor::fixRenderedCursorPosition(const std::string_view line)
 {
 	//Fixing rendered X/Col position
 	mWindow->renderedCursorX = mWindow->fileCursorX;
-	mWindow->renderedCursorX += getRenderedTabSpaces(row, mWindow->fileCursorX);
+	mWindow->renderedCursorX += getRenderedTabSpaces(line, mWindow->fileCursorX);
 	mWindow->colNumberToDisplay = mWindow->renderedCursorX;
 
-	while (mWindow->renderedCursorX - mWindow->colOffset >= mWindow->cols && mWindow->renderedCursorX >= mWindow->colOffset)
+	//Jumps straight to the new offset, as stepping one column at a time is slow after moving to the end of a very long row
+	if (mWindow->renderedCursorX >= mWindow->colOffset + mWindow->cols)
 	{
-		++mWindow->colOffset;
+		mWindow->colOffset = mWindow->renderedCursorX - mWindow->cols + 1;
 	}
-	while (mWindow->renderedCursorX < mWindow->colOffset)
+	if (mWindow->renderedCursorX < mWindow->colOffset)
 	{
-		--mWindow->colOffset;
+		mWindow->colOffset = mWindow->renderedCursorX;
 	}
 	mWindow->renderedCursorX = mWindow->renderedCursorX - mWindow->colOffset;
 	if (mWindow->renderedCursorX == mWindow->cols)
@@ -896,12 +1151,12 @@ void Editor::fixRenderedCursorPosition(const FileHandler::Row& row)
 
 void Editor::replaceRenderedStringTabs(std::string& renderedLine)
 {
-	for (size_t i = 0; i < renderedLine.length(); ++i)
+	//Jumps from tab to tab, so rows without tabs (or long rows with few) are only searched, not walked one character at a time
+	for (size_t i = renderedLine.find(static_cast<char>(KeyActions::KeyAction::Tab)); i != std::string::npos;
+		i = renderedLine.find(static_cast<char>(KeyActions::KeyAction::Tab), i + 1))
 	{
-		if (i >= renderedLine.length()) return;	
-		if (renderedLine[i] != static_cast<uint8_t>(KeyActions::KeyAction::Tab)) continue;
-
 		renderedLine[i] = ' '; //Replace the tab character with a space
+		if (!mPolicy.expandTabs()) continue; //One column each, so columns on screen match columns in the file
 		uint8_t t = maxSpacesForTab - (i % tabSpacing);
 		if (t > 0)
 		{
@@ -911,186 +1166,77 @@ void Editor::replaceRenderedStringTabs(std::string& renderedLine)
 	}
 }
 
-const size_t Editor::getRenderedTabSpaces(const FileHandler::Row& row, size_t endPos) const
+const size_t Editor::getRenderedTabSpaces(const std::string_view line, size_t endPos) const
 {
+	if (!mPolicy.expandTabs()) return 0;
+
 	size_t spacesToAdd = 0;
 	for (size_t i = 0; i < endPos; ++i)
 	{
-		if (i > row.line.length()) return 0;
+		if (i > line.length()) return 0;
 
-		if (row.line[i] != static_cast<uint8_t>(KeyActions::KeyAction::Tab)) continue;
+		if (i == line.length() || line[i] != static_cast<uint8_t>(KeyActions::KeyAction::Tab)) continue;
 
 		spacesToAdd += maxSpacesForTab - ((i + spacesToAdd) % tabSpacing); //Tabs are replaced with up to 8 spaces, depending on how close to a multiple of 8 the tab is
 	}
 	return spacesToAdd;
 }
 
-size_t Editor::adjustSyntaxHighlightLocations(const size_t adjustmentsMade, const FindAndReplace::FindLocation& findLocation, const size_t findColorLength)
-{
-	if (!mSyntax.hasSyntax()) return 0;
-
-	size_t adjustmentToMake = 0;
-	const size_t highlightsSize = mSyntax.highlights().size();
-	for (size_t i = 0; i < highlightsSize; ++i)
-	{
-		SyntaxHighlight::HighlightLocation* highlight = &mSyntax.highlights().at(i);
-		if (highlight->startRow > findLocation.row) break;
-
-		if (highlight->startRow == findLocation.row || highlight->endRow == findLocation.row)
-		{
-			if (highlight->startRow == findLocation.row)
-			{
-				if (highlight->startCol + highlight->startPosAdjustment >= findLocation.startCol + adjustmentsMade)
-				{
-					if (highlight->startCol + highlight->startPosAdjustment <= findLocation.startCol + findLocation.length + adjustmentsMade)
-					{
-						highlight->startPosAdjustment += findColorLength;
-						adjustmentToMake = (adjustmentToMake == 0) ? findColorLength : adjustmentToMake;
-					}
-					else
-					{
-						highlight->startPosAdjustment += findColorLength + normalBackgroundColor.length();
-						adjustmentToMake = findColorLength + normalBackgroundColor.length();
-					}
-				}
-			}
-			if (highlight->endRow == findLocation.row)
-			{
-				if (highlight->endCol + highlight->endPosAdjustment >= findLocation.startCol + adjustmentsMade)
-				{
-					if (highlight->endCol + highlight->endPosAdjustment <= findLocation.startCol + findLocation.length + adjustmentsMade)
-					{
-						highlight->endPosAdjustment += findColorLength;
-						adjustmentToMake = (adjustmentToMake == 0) ? findColorLength : adjustmentToMake;
-					}
-					else
-					{
-						highlight->endPosAdjustment += findColorLength + normalBackgroundColor.length();
-						adjustmentToMake = findColorLength + normalBackgroundColor.length();
-					}
-				}
-			}
-		}
-	}
-
-	return adjustmentToMake;
-}
-
 void Editor::addFindLocationColor(const size_t rowOffset, const size_t colOffset)
 {
-	size_t charactersToAdjust = 0; //The amount of characters to adjust for in the string position based on how many color code escape sequences have been added
-	size_t prevRow = 0;
-	size_t syntaxToFindAdjustmentsMade = 0;
 	constexpr uint8_t findColorId = 237;
 	constexpr uint8_t currentFindColorId = 102;
 
-	for (size_t i = 0; i < mFindLocations.size(); ++i)
+	//When only the current match is highlighted, the others aren't even looked at
+	const size_t first = mPolicy.highlightAllMatches() ? 0 : mCurrentFindPos;
+	const size_t last = mPolicy.highlightAllMatches() ? mFindLocations.size() : std::min(mCurrentFindPos + 1, mFindLocations.size());
+	for (size_t i = first; i < last; ++i)
 	{
 		const FindAndReplace::FindLocation& findLocation = mFindLocations.at(i);
-		if (findLocation.row < rowOffset || findLocation.startCol >= mWindow->cols + colOffset || findLocation.startCol + findLocation.length < colOffset) continue;
+		if (findLocation.row < rowOffset) continue;
 		if (findLocation.row >= rowOffset + mWindow->rows) break;
 
-		const uint8_t currentColorId = (i == mCurrentFindPos) ? currentFindColorId : findColorId;
-		std::string findLocationColor = std::format("\x1b[48;5;{}m", std::to_string(currentColorId));
-		std::string* renderString = &mWindow->fileRows->at(findLocation.row).renderedLine;
-
-		if (prevRow != findLocation.row)
-		{
-			charactersToAdjust = 0;
-			syntaxToFindAdjustmentsMade = 0;
-		}
-
-		size_t insertPos = findLocation.startCol;
-		if (insertPos < colOffset) insertPos = 0;
-		else if (insertPos >= colOffset) insertPos -= colOffset;
-
-		insertPos += charactersToAdjust;
-		if (insertPos >= renderString->length()) insertPos = renderString->length();
-
-		renderString->insert(insertPos, findLocationColor);
-		charactersToAdjust += findLocationColor.length();
-
-		insertPos = findLocation.startCol + findLocation.length;
-		if (insertPos >= colOffset) insertPos -= colOffset;
+		const size_t startCol = renderedFindColumn(findLocation);
+		if (startCol >= mWindow->cols + colOffset || startCol + findLocation.length <= colOffset) continue;
 
-		insertPos += charactersToAdjust;
-		if (insertPos >= renderString->length()) insertPos = renderString->length();
-
-		renderString->insert(insertPos, normalBackgroundColor);
-
-		charactersToAdjust += normalBackgroundColor.length();
-		prevRow = findLocation.row;
-
-		syntaxToFindAdjustmentsMade += adjustSyntaxHighlightLocations(syntaxToFindAdjustmentsMade, findLocation, findLocationColor.length());
+		const uint8_t color = (i == mCurrentFindPos) ? currentFindColorId : findColorId;
+		mRenderer.styles().addBackground({ findLocation.row - rowOffset, std::max(startCol, colOffset) - colOffset, startCol + findLocation.length - colOffset, color });
 	}
 }
 
 void Editor::addSyntaxHighlightColor(const size_t rowOffset, const size_t colOffset)
 {
-	size_t charactersToAdjust = 0; //The amount of characters to adjust for in the string position based on how many color code escape sequences have been added
-	size_t prevRow = 0;
-
 	for (const auto& highlight : mSyntax.highlights())
 	{
-		if (!highlight.drawColor) continue;
-		if (highlight.startRow == highlight.endRow && highlight.endCol < colOffset) continue;
-		if (highlight.startRow >= mWindow->rowOffset + mWindow->rows) break;
-
-		std::string* renderString = &mWindow->fileRows->at(highlight.startRow).renderedLine;
-		if (prevRow != highlight.startRow) charactersToAdjust = 0;
+		if (!highlight.drawColor || highlight.endRow < rowOffset) continue;
+		if (highlight.startRow >= rowOffset + mWindow->rows) break;
 
+		//Highlights over several rows, like multiline comments, get a span on each row of theirs that is on screen
 		const uint8_t color = mSyntax.color(highlight.highlightType);
-		std::string colorFormat = std::format("\x1b[38;5;{}m", std::to_string(color));
-
-		if (rowOffset > highlight.startRow)
-		{
-			renderString = &mWindow->fileRows->at(rowOffset).renderedLine;
-			renderString->insert(0, colorFormat);
-			charactersToAdjust += colorFormat.length();
-			prevRow = rowOffset;
-		}
-		else
+		const size_t lastRow = std::min(highlight.endRow, rowOffset + mWindow->rows - 1);
+		for (size_t row = std::max(highlight.startRow, rowOffset); row <= lastRow; ++row)
 		{
-			size_t insertPos = highlight.startCol;
-			//Need to make sure the insert position is in within the rendered string
-			if (insertPos < colOffset) insertPos = 0;
-			else if (insertPos >= colOffset) insertPos -= colOffset;
-
-			insertPos += charactersToAdjust + highlight.startPosAdjustment;
-			if (insertPos >= renderString->length()) insertPos = renderString->length();
-
-			renderString->insert(insertPos, colorFormat);
-			charactersToAdjust += colorFormat.length();
+			const size_t startCol = (row == highlight.startRow) ? highlight.startCol : 0;
+			const size_t endCol = (row == highlight.endRow) ? highlight.endCol : std::numeric_limits<size_t>::max();
+			if (endCol <= colOffset) continue;
 
-			prevRow = highlight.startRow;
+			mRenderer.styles().addForeground({ row - rowOffset, std::max(startCol, colOffset) - colOffset, endCol - colOffset, color });
 		}
-
-		size_t insertPos = highlight.endCol;
-		if (insertPos >= colOffset) insertPos -= colOffset;
-		else if (insertPos < colOffset) insertPos = 0;
-		if (insertPos >= mWindow->cols) insertPos = mWindow->cols - 1;
-
-		if (prevRow != highlight.endRow) charactersToAdjust = 0;
-		insertPos += charactersToAdjust + highlight.endPosAdjustment;
-
-		renderString = &mWindow->fileRows->at(highlight.endRow).renderedLine;
-		if (insertPos >= renderString->length()) insertPos = renderString->length();
-
-
-		renderString->insert(insertPos, mNormalColorMode);
-		charactersToAdjust += mNormalColorMode.length();
-
-		prevRow = highlight.endRow;
 	}
 }
 
 void Editor::updateRenderedColor()
 {
+	//Text outside of the highlights is drawn in the syntax's normal color
+	FrameBuffer::Style baseStyle;
+	if (highlightsSyntax()) baseStyle.foreground = mSyntax.color(SyntaxHighlight::HighlightType::Normal);
+	mRenderer.styles().setBaseStyle(baseStyle);
+
 	if (mMode == Mode::FindInputMode || mMode == Mode::ReplaceInputMode || mMode == Mode::FindMode || mMode == Mode::ReplaceMode)
 	{
 		addFindLocationColor(mWindow->rowOffset, mWindow->colOffset);
 	}
-	if (mSyntax.hasSyntax())
+	if (highlightsSyntax())
 	{
 		addSyntaxHighlightColor(mWindow->rowOffset, mWindow->colOffset);
 	}
@@ -1098,11 +1244,11 @@ void Editor::updateRenderedColor()
 
 void Editor::setHighlightLocations(const size_t rowToStart, size_t colToStart)
 {
-	if (!mSyntax.hasSyntax()) return; //Can't highlight if there is no syntax
+	if (!highlightsSyntax()) return; //Can't highlight if there is no syntax, or the file is too large for it
 
-	for(size_t i = rowToStart; i < mWindow->fileRows->size() && i < mWindow->rowOffset + mWindow->rows; ++i)
+	for(size_t i = rowToStart; i < mViewport.size() && i < mWindow->rowOffset + mWindow->rows; ++i)
 	{
-		FileHandler::Row* row = &mWindow->fileRows->at(i); //The starting row
+		ViewportCache::Line* row = &mViewport.at(i); //The starting row
 
 		size_t findPos = 0, posOffset = colToStart; //posOffset keeps track of how far into the string we are, since findPos depends on currentWord, which progressively gets smaller
 
@@ -1119,7 +1265,7 @@ void Editor::setHighlightLocations(const size_t rowToStart, size_t colToStart)
 		{
 			if (findPos >= mWindow->colOffset + mWindow->cols) goto nextrow;
 
-			row = &mWindow->fileRows->at(i); //Makes sure the correct row is always being used
+			row = &mViewport.at(i); //Makes sure the correct row is always being used
 
 			std::string_view wordToCheck = currentWord.substr(0, findPos); //The word/character sequence before the separator character
 
@@ -1128,7 +1274,7 @@ void Editor::setHighlightLocations(const size_t rowToStart, size_t colToStart)
 				mSyntax.highlightKeywordNumberCheck(wordToCheck, i, posOffset);
 			}
 
-			bool gotoNextRow = mSyntax.highlightCommentCheck(*mWindow->fileRows, currentWord, row, findPos, posOffset, i);
+			bool gotoNextRow = mSyntax.highlightCommentCheck(mViewport, currentWord, row, findPos, posOffset, i);
 			if(gotoNextRow)
 			{
 				goto nextrow;
@@ -1146,11 +1292,30 @@ void Editor::setHighlightLocations(const size_t rowToStart, size_t colToStart)
 	}
 }
 
+void Editor::shiftView(const int64_t rows)
+{
+	if (rows == 0) return;
+
+	//The document's rows now start somewhere else in the file, so move everything that points at a row by the same amount
+	const int64_t lastRow = static_cast<int64_t>(mWindow->document->lineCount()) - 1;
+	const int64_t cursorY = std::clamp(static_cast<int64_t>(mWindow->fileCursorY) - rows, int64_t(0), lastRow);
+	const int64_t rowOffset = std::clamp(static_cast<int64_t>(mWindow->rowOffset) - rows, int64_t(0), cursorY);
+	mWindow->fileCursorY = static_cast<size_t>(cursorY);
+	mWindow->rowOffset = static_cast<size_t>(rowOffset);
+	mWindow->fileCursorX = std::min(mWindow->fileCursorX, mWindow->document->lineLength(mWindow->fileCursorY));
+
+	mSyntax.highlights().clear();
+	mFindLocations.clear();
+}
+
 void Editor::updateWindowSize()
 {
 	IConsole::WindowSize windowSize = mConsole->getWindowSize();
 	mWindow->rows = windowSize.rows - statusMessageRows;
 	mWindow->cols = windowSize.cols;
+	mViewport.resize(mWindow->rows + 1);
+	mRenderer.resize(windowSize.rows, windowSize.cols);
+	mRenderer.setScrollRegion(0, mWindow->rows);
 }
 
 void Editor::updateCommandBuffer(const std::string& command)
@@ -1160,11 +1325,16 @@ void Editor::updateCommandBuffer(const std::string& command)
 
 void Editor::findString(const std::string& findString)
 {
-	mFindLocations = FindAndReplace::find(findString, *mWindow->fileRows);
-	for (auto& location : mFindLocations)
+	mFile.waitForIndex();
+	mFindLocations = FindAndReplace::find(findString, *mWindow->document);
+	mFindColumnsRendered = mPolicy.highlightAllMatches(); //Otherwise only the current match is shown, so the rest are never worked out
+	if (mFindColumnsRendered)
 	{
-		const size_t tabs = getRenderedTabSpaces(mWindow->fileRows->at(location.row), location.startCol);
-		location.startCol += tabs;
+		for (auto& location : mFindLocations)
+		{
+			const size_t tabs = getRenderedTabSpaces(mWindow->document->line(location.row), location.startCol);
+			location.startCol += tabs;
+		}
 	}
 	mCurrentFindPos = 0;
 
@@ -1178,9 +1348,10 @@ void Editor::findString(const std::string& findString)
 	const FindAndReplace::FindLocation& findLocation = mFindLocations.at(startLocation);
 	mWindow->fileCursorY = findLocation.row;
 	mWindow->fileCursorX = findLocation.filePos;
-	if (findLocation.startCol + findLocation.length >= mWindow->colOffset + mWindow->cols)
+	const size_t startCol = renderedFindColumn(findLocation);
+	if (startCol + findLocation.length >= mWindow->colOffset + mWindow->cols)
 	{
-		mWindow->colOffset = findLocation.startCol + findLocation.length - mWindow->cols + 1;
+		mWindow->colOffset = startCol + findLocation.length - mWindow->cols + 1;
 	}
 }
 
@@ -1211,24 +1382,25 @@ void Editor::moveCursorToFind(const KeyActions::KeyAction key)
 
 	mWindow->fileCursorY = mFindLocations.at(mCurrentFindPos).row;
 	mWindow->fileCursorX = mFindLocations.at(mCurrentFindPos).filePos;
-	if (mFindLocations.at(mCurrentFindPos).startCol + mFindLocations.at(mCurrentFindPos).length >= mWindow->colOffset + mWindow->cols)
+	const size_t startCol = renderedFindColumn(mFindLocations.at(mCurrentFindPos));
+	if (startCol + mFindLocations.at(mCurrentFindPos).length >= mWindow->colOffset + mWindow->cols)
 	{
-		mWindow->colOffset = mFindLocations.at(mCurrentFindPos).startCol + mFindLocations.at(mCurrentFindPos).length - mWindow->cols + 1;
+		mWindow->colOffset = startCol + mFindLocations.at(mCurrentFindPos).length - mWindow->cols + 1;
 	}
 }
 
 void Editor::replaceFindString(const std::string& replaceStr, const bool replaceAll)
 {
-	if (mFindLocations.empty()) return;
+	if (mFindLocations.empty() || mFile.isViewOnly()) return;
 
 	if (replaceAll)
 	{
 		for (size_t i = mFindLocations.size() - 1; i > 0; --i)
 		{
 			const FindAndReplace::FindLocation& current = mFindLocations.at(i);
-			FindAndReplace::replace(mWindow->fileRows->at(current.row).line, replaceStr, current);
+			FindAndReplace::replace(*mWindow->document, replaceStr, current);
 		}
-		FindAndReplace::replace(mWindow->fileRows->at(mFindLocations.front().row).line, replaceStr, mFindLocations.front());
+		FindAndReplace::replace(*mWindow->document, replaceStr, mFindLocations.front());
 		mFindLocations.clear();
 		mCurrentFindPos = 0;
 		enableReadMode();
@@ -1236,7 +1408,7 @@ void Editor::replaceFindString(const std::string& replaceStr, const bool replace
 	}
 
 	const FindAndReplace::FindLocation& current = mFindLocations.at(mCurrentFindPos);
-	FindAndReplace::replace(mWindow->fileRows->at(current.row).line, replaceStr, current);
+	FindAndReplace::replace(*mWindow->document, replaceStr, current);
 
 	if (replaceStr.length() != current.length)
 	{
@@ -1248,7 +1420,7 @@ void Editor::replaceFindString(const std::string& replaceStr, const bool replace
 
 			locationToUpdate.filePos += lengthDiff;
 
-			const size_t tabSpaces = getRenderedTabSpaces(mWindow->fileRows->at(locationToUpdate.row), locationToUpdate.filePos);
+			const size_t tabSpaces = getRenderedTabSpaces(mWindow->document->line(locationToUpdate.row), locationToUpdate.filePos);
 			locationToUpdate.startCol = locationToUpdate.filePos + tabSpaces;
 		}
 	}
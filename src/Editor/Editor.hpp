@@ -37,13 +37,14 @@ SOFTWARE.
 #include "Console/ConsoleInterface.hpp"
 #include "FindAndReplace/FindAndReplace.hpp"
 #include "Renderer/Renderer.hpp"
+#include "Renderer/ViewportCache.hpp"
+#include "LargeFilePolicy.hpp"
 
 #include <vector>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <deque>
-#include <mutex>
 #include <cstdint>
 
 class Editor
@@ -125,6 +126,14 @@ public:
 	/// <param name="c"></param>
 	void insertChar(const unsigned char c);
 
+	/// <summary>
+	/// Inserts the contents of another file at the cursor (the ":r <filename>" command), as a single change that can be undone in one go.
+	/// The file is read the same way the document's own file is, and all of its rows are spliced into the document at once.
+	/// Leaves the cursor at the end of the inserted text
+	/// </summary>
+	/// <param name="fileName"></param>
+	void insertFile(const std::string_view fileName);
+
 	/// <summary>
 	/// When CTRL-Z is pressed, undo the change.
 	/// First adds the current state of the editor to the Redo Change
@@ -144,13 +153,15 @@ public:
 	/// Should be used when trying to exit the program
 	/// </summary>
 	/// <returns></returns>
-	const bool isDirty() const;
+	const bool isDirty();
 
 	/// <summary>
 	/// Sends the current changes to be written to the file.
+	/// The file is written in the background, and the file stops being dirty once it is done, unless it was edited in the meantime.
 	/// Called when either save or save/quit command is used
 	/// </summary>
-	void save();
+	/// <param name="sync"> Waits for the file to reach the disk </param>
+	void save(const bool sync = false);
 
 	/// <summary>
 	/// When command mode is entered (pressing ':' while in read mode), take necessary steps
@@ -237,6 +248,18 @@ public:
 	/// <param name="replaceAll"></param>
 	void replaceFindString(const std::string& replaceStr, const bool replaceAll = false);
 
+	/// <summary>
+	/// Replaces the limits read from config.json, and chooses the policy again
+	/// </summary>
+	/// <param name="limits"></param>
+	void setLargeFileLimits(const LargeFilePolicy::Limits& limits);
+
+	/// <summary>
+	/// Which features are in a cheaper mode because of the size of the file
+	/// </summary>
+	/// <returns></returns>
+	const LargeFilePolicy& largeFilePolicy() const;
+
 private:
 	/// <summary>
 	/// The structure for how the window stores information and tracks current position within the file
@@ -252,7 +275,7 @@ private:
 		size_t rowOffset, colOffset;
 		int rows, cols;
 
-		std::vector<FileHandler::Row>* fileRows;
+		PieceTable* document;
 
 		bool dirty;
 	};
@@ -268,6 +291,8 @@ private:
 			CharDeleted,
 			RowInserted,
 			RowDeleted,
+			TextInserted, //A block of text that can span rows, kept in changeMade
+			TextDeleted,
 			None
 		} changeType;
 
@@ -286,7 +311,7 @@ private:
 	void prepForRender();
 
 	/// <summary>
-	/// Sets the rendered lines that are currently on screen and replaces the tabs with spaces
+	/// Loads the rows that are currently on screen into the viewport cache and replaces the tabs in their rendered lines with spaces
 	/// </summary>
 	void setRenderedLine(const size_t startRow, const size_t endRow);
 
@@ -356,7 +381,15 @@ private:
 	/// Fixes the rendered cursor's x position accounting for tabs, as well as the y position depending on how far way the cursor is from the row offset
 	/// </summary>
 	/// <param name=""></param>
-	void fixRenderedCursorPosition(const FileHandler::Row&);
+	void fixRenderedCursorPosition(const std::string_view line);
+
+	/// <summary>
+	/// Moves the cursor to the end of text, which was just inserted at the given row and column
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="text"></param>
+	void moveCursorPastInserted(const size_t row, const size_t col, const std::string_view text);
 
 	/// <summary>
 	/// Replaces the tabs in the rendered string with spaces, to the nearest multiple of 8.
@@ -370,26 +403,17 @@ private:
 	/// </summary>
 	/// <param name=""></param>
 	/// <returns> The amount of spaces the rendered cursor needs to move </returns>
-	const size_t getRenderedTabSpaces(const FileHandler::Row&, size_t endPos) const;
-
-	/// <summary>
-	/// Creates the escape code sequence insert adjusments needed when find string highlights have been added
-	/// </summary>
-	/// <param name="adjustmentsMade"></param>
-	/// <param name="findLocation"></param>
-	/// <param name="findColorLength"></param>
-	/// <returns></returns>
-	size_t adjustSyntaxHighlightLocations(const size_t adjustmentsMade, const FindAndReplace::FindLocation& findLocation, const size_t findColorLength);
+	const size_t getRenderedTabSpaces(const std::string_view line, size_t endPos) const;
 
 	/// <summary>
-	/// Adds the find location color escape codes to the rendered string
+	/// Adds the background color spans of the find locations on screen to the renderer
 	/// </summary>
 	/// <param name="rowOffset"></param>
 	/// <param name="colOffset"></param>
 	void addFindLocationColor(const size_t rowOffset, const size_t colOffset);
 
 	/// <summary>
-	/// Adds the syntax highlight color escape codes to the rendered string
+	/// Adds the text color spans of the syntax highlights on screen to the renderer
 	/// </summary>
 	/// <param name="rowOffset"></param>
 	/// <param name="colOffset"></param>
@@ -405,11 +429,66 @@ private:
 	/// </summary>
 	void setHighlightLocations(const size_t rowToStart, size_t colToStart);
 
+	/// <summary>
+	/// Called after the file handler moves the window of rows held in the document (view mode only).
+	/// Moves the cursor and row offset back by the same number of rows, so they stay on the same rows of the file
+	/// </summary>
+	/// <param name="rows"> How many rows the window moved forward </param>
+	void shiftView(const int64_t rows);
+
+	/// <summary>
+	/// Called once a background save is done. Clears the dirty flag if the version that was written is still the current one,
+	/// and puts how the save went in the status bar
+	/// </summary>
+	void finishSave();
+
+	/// <summary>
+	/// Called after the file handler checked for changes made by another program.
+	/// After a partial reload, everything pointing at a row after the replaced rows moves by the same number of rows, and anything on the replaced rows is dropped.
+	/// The undo history is only kept if none of it touches the replaced rows
+	/// </summary>
+	/// <param name="reload"></param>
+	void applyReload(const FileHandler::Reload& reload);
+
+	/// <summary>
+	/// Called after rows were added to the end of the file in follow mode. Rows on screen before the new ones aren't pulled out of the document again.
+	/// If the cursor was on the last row, it moves to the new last row and the screen scrolls with it.
+	/// Also called when piped input ends, to say so in the status bar
+	/// </summary>
+	/// <param name="appended"></param>
+	/// <param name="previousVersion"> The document's version before the rows were added </param>
+	void followAppended(const FileHandler::Appended& appended, const uint64_t previousVersion);
+
+	/// <summary>
+	/// Called when the whole document was loaded again. Keeps the cursor inside it, and drops everything that pointed at the old rows
+	/// </summary>
+	void documentReplaced();
+
+	/// <summary>
+	/// Chooses the large file policy for the file as it is now. Called every refresh, since the number of rows and the longest row
+	/// are only known once indexing is done, and can change with a reload or in follow mode
+	/// </summary>
+	void updatePolicy();
+
+	/// <summary>
+	/// Whether rows are syntax highlighted: the file has a syntax, and isn't too large for it
+	/// </summary>
+	/// <returns></returns>
+	const bool highlightsSyntax() const;
+
+	/// <summary>
+	/// The column a find location starts at on screen. Only worked out once the location is shown when not every match is highlighted
+	/// </summary>
+	/// <param name="location"></param>
+	/// <returns></returns>
+	const size_t renderedFindColumn(const FindAndReplace::FindLocation& location) const;
+
 private:
 	std::string mCommandBuffer;
-	std::string mNormalColorMode;
+	std::string mStatusMessage; //Shown in the status bar on the next refresh, in place of the cursor position. "saving..." stays until the save is done
 
 	std::unique_ptr<Window> mWindow;
+	ViewportCache mViewport; //The rows pulled out of the document for the current frame
 	std::unique_ptr<IConsole> mConsole;
 	FileHandler mFile;
 	SyntaxHighlight mSyntax;
@@ -419,18 +498,20 @@ private:
 
 	std::vector<FindAndReplace::FindLocation> mFindLocations;
 	size_t mCurrentFindPos = 0;
+	bool mFindColumnsRendered = true; //Whether the find locations' startCol already accounts for tabs
+
+	LargeFilePolicy::Limits mPolicyLimits;
+	LargeFilePolicy mPolicy;
 
 	std::deque<ChangeHistory> mFileHistory; //Double ended queue - Front for undo history, back for redo history
 	size_t mRedoCounter = 0; //Tracking how many redos we can do
-	
-	std::mutex mMutex;
 
 	//Some constants to give specific values an identifying name
 	inline static const std::string_view separators = " \"',.()+-/*=~%;:[]{}<>";
-	inline static const std::string normalBackgroundColor = "\x1b[48;5;0m";
 	inline static constexpr uint8_t tabSpacing = 8;
 	inline static constexpr uint8_t maxSpacesForTab = 7;
 	inline static constexpr uint8_t statusMessageRows = 2;
+	inline static constexpr size_t longRowLength = 64 * 1024; //Rows longer than this are only pulled out as far as can be drawn
 
 	//Return codes from moveCursorLeftRight()
 	inline static constexpr int8_t cursorCantMove = -1;
@@ -0,0 +1,122 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LargeFilePolicy.hpp"
+#include "Utility/GetProgramPath/GetProgramPath.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <charconv>
+#include <filesystem>
+
+using JsonParser::JsonValue;
+using JsonParser::JsonObject;
+
+LargeFilePolicy::LargeFilePolicy(const Limits& limits, const uint64_t fileSize, const size_t lineCount, const size_t longestLine) :
+	mLargeFile(fileSize > limits.fileSize), mManyRows(lineCount > limits.lineCount), mLongRows(longestLine > limits.lineLength)
+{}
+
+LargeFilePolicy::Limits LargeFilePolicy::loadLimits()
+{
+	std::ifstream file(GetProgramPath::getPath() / "config.json");
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return parseLimits(JsonParser::parseJson(contents.str()));
+}
+
+/// <summary>
+/// Reads a size such as "4096", "16KB" or "256MB" into value. value is left alone if the size can't be read
+/// </summary>
+template <class T>
+static void parseSize(const JsonValue& limits, const std::string& key, T& value)
+{
+	if (!limits.contains(key) || !std::holds_alternative<std::string>(limits.at(key).value)) return;
+	const std::string& size = limits.get<std::string>(key);
+
+	uint64_t number = 0;
+	const auto [end, ec] = std::from_chars(size.data(), size.data() + size.length(), number);
+	if (ec != std::errc()) return;
+
+	const std::string_view suffix(end, size.data() + size.length() - end);
+	if (suffix == "KB") number *= 1024;
+	else if (suffix == "MB") number *= 1024 * 1024;
+	else if (suffix == "GB") number *= 1024 * 1024 * 1024;
+	else if (!suffix.empty()) return;
+	value = static_cast<T>(number);
+}
+
+LargeFilePolicy::Limits LargeFilePolicy::parseLimits(const std::vector<JsonObject>& config)
+{
+	Limits limits;
+	for (const JsonObject& key : config)
+	{
+		const auto largeFile = key.find("largeFile");
+		if (largeFile == key.end() || !std::holds_alternative<JsonObject>(largeFile->second.value)) continue;
+
+		parseSize(largeFile->second, "fileSize", limits.fileSize);
+		parseSize(largeFile->second, "lineCount", limits.lineCount);
+		parseSize(largeFile->second, "lineLength", limits.lineLength);
+	}
+	return limits;
+}
+
+const bool LargeFilePolicy::syntaxHighlighting() const
+{
+	return !mLargeFile && !mLongRows;
+}
+
+const bool LargeFilePolicy::highlightAllMatches() const
+{
+	return !mLargeFile && !mManyRows;
+}
+
+const bool LargeFilePolicy::groupTypingUndo() const
+{
+	return mLargeFile || mManyRows;
+}
+
+const bool LargeFilePolicy::expandTabs() const
+{
+	return !mLongRows;
+}
+
+const bool LargeFilePolicy::isActive() const
+{
+	return mLargeFile || mManyRows || mLongRows;
+}
+
+const std::string LargeFilePolicy::label() const
+{
+	std::string label;
+	auto add = [&label](const bool past, const std::string_view name)
+		{
+			if (!past) return;
+			label += label.empty() ? "" : ", ";
+			label += name;
+		};
+	add(mLargeFile, "LARGE FILE");
+	add(mManyRows, "MANY ROWS");
+	add(mLongRows, "LONG ROWS");
+	return label;
+}
@@ -0,0 +1,124 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file LargeFilePolicy.hpp
+* @brief Decides which editor features switch to cheaper modes for a file that is too large for them
+*
+* The limits come from the "largeFile" object in config.json, and any that are missing keep their defaults.
+* Each limit only turns off the features that get slow past it:
+*	fileSize	- syntax highlighting, highlighting every find match, undoing a character at a time
+*	lineCount	- highlighting every find match, undoing a character at a time
+*	lineLength	- syntax highlighting, expanding tabs
+*/
+#pragma once
+#include "Utility/JsonParser/JsonParser.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class LargeFilePolicy
+{
+public:
+	/// <summary>
+	/// The sizes past which a file counts as large. In config.json, each is a string of digits with an optional KB, MB or GB suffix
+	/// </summary>
+	struct Limits
+	{
+		uint64_t fileSize = 256 * 1024 * 1024;
+		size_t lineCount = 2'000'000;
+		size_t lineLength = 16 * 1024;
+	};
+
+	/// <summary>
+	/// Every feature at full detail
+	/// </summary>
+	LargeFilePolicy() = default;
+
+	/// <summary>
+	/// Chooses the policy for a file of the given size and shape
+	/// </summary>
+	/// <param name="limits"></param>
+	/// <param name="fileSize"></param>
+	/// <param name="lineCount"></param>
+	/// <param name="longestLine"></param>
+	LargeFilePolicy(const Limits& limits, const uint64_t fileSize, const size_t lineCount, const size_t longestLine);
+
+	/// <summary>
+	/// Reads the limits from config.json next to the executable
+	/// </summary>
+	/// <returns></returns>
+	static Limits loadLimits();
+
+	/// <summary>
+	/// Reads the limits from parsed config, keeping the defaults for anything missing or malformed
+	/// </summary>
+	/// <param name="config"> The top-level keys of config.json </param>
+	/// <returns></returns>
+	static Limits parseLimits(const std::vector<JsonParser::JsonObject>& config);
+
+	/// <summary>
+	/// Whether rows are syntax highlighted
+	/// </summary>
+	/// <returns></returns>
+	const bool syntaxHighlighting() const;
+
+	/// <summary>
+	/// Whether every find match on screen is highlighted, rather than only the current one
+	/// </summary>
+	/// <returns></returns>
+	const bool highlightAllMatches() const;
+
+	/// <summary>
+	/// Whether a run of characters typed one after another is undone together, rather than a character at a time
+	/// </summary>
+	/// <returns></returns>
+	const bool groupTypingUndo() const;
+
+	/// <summary>
+	/// Whether tabs are expanded to the next multiple of 8 columns, rather than taking a single column
+	/// </summary>
+	/// <returns></returns>
+	const bool expandTabs() const;
+
+	/// <summary>
+	/// Whether any feature has been switched to a cheaper mode
+	/// </summary>
+	/// <returns></returns>
+	const bool isActive() const;
+
+	/// <summary>
+	/// Which limits the file is past, for the status bar. Empty if none are
+	/// </summary>
+	/// <returns></returns>
+	const std::string label() const;
+
+	bool operator==(const LargeFilePolicy& other) const = default;
+
+private:
+	bool mLargeFile = false;
+	bool mManyRows = false;
+	bool mLongRows = false;
+};
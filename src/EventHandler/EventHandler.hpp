@@ -23,8 +23,6 @@ SOFTWARE.
 */
 
 #pragma once
-#include "Editor/Editor.hpp"
-
 #include <atomic>
 class EventHandler
 {
@@ -34,10 +32,17 @@ public:
 	/// The atomic bool is only for Windows, but may be useful later so it is gonna stay here since its not hurting anything
 	/// </summary>
 	/// <param name="running"></param>
-	EventHandler(std::atomic<bool>& running, Editor* editor);
+	EventHandler(std::atomic<bool>& running);
 
 	/// <summary>
 	/// On Windows, join the thread. On Unix, unset the SIGWINCH callback.
 	/// </summary>
 	~EventHandler();
+
+	/// <summary>
+	/// Whether the window has been resized since the last call. The event only sets a flag, and the main loop resizes and redraws the editor,
+	/// since redrawing can reload the file and replace the document, which isn't safe to do in the middle of handling a key
+	/// </summary>
+	/// <returns></returns>
+	const bool windowResized();
 };
\ No newline at end of file
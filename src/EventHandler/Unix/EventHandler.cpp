@@ -28,22 +28,26 @@ SOFTWARE.
 #include <iostream>
 #include <csignal>
 
-Editor* editor = nullptr;
+volatile std::sig_atomic_t resizePending = 0;
 
 void windowSizeChangeEvent(int)
 {
-    editor->updateWindowSize();
-    editor->refreshScreen(true);
+    resizePending = 1; //Nothing else is safe to do in a signal handler
 }
 
-EventHandler::EventHandler(std::atomic<bool>& running, Editor* ed)
+EventHandler::EventHandler(std::atomic<bool>& running)
 {
-    editor = ed;
     std::signal(SIGWINCH, windowSizeChangeEvent);
 }
 
 EventHandler::~EventHandler()
 {
-    editor = nullptr;
-    std::signal(SIGWINCH, nullptr);
+    std::signal(SIGWINCH, SIG_DFL);
+}
+
+const bool EventHandler::windowResized()
+{
+    if (resizePending == 0) return false;
+    resizePending = 0;
+    return true;
 }
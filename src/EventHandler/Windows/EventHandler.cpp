@@ -30,7 +30,7 @@ SOFTWARE.
 #include <thread>
 
 std::thread t;
-Editor* editor = nullptr;
+std::atomic<bool> resizePending = false;
 
 /// <summary>
 /// Handles checking and updating the window size using a blocking call on a secondary thread to avoid busy looping
@@ -47,8 +47,7 @@ void windowSizeChangeEvent(std::atomic<bool>& running)
 		ReadConsoleInput(GetStdHandle(STD_INPUT_HANDLE), &input, 1, &numEvents); //Blocks this thread until an event happens
 		if (input.EventType == WINDOW_BUFFER_SIZE_EVENT) //If the event is a window size update
 		{
-			editor->updateWindowSize();
-			editor->refreshScreen(true);
+			resizePending = true; //The main loop redraws, so the editor is only ever used from one thread
 		}
 		else
 		{
@@ -58,13 +57,17 @@ void windowSizeChangeEvent(std::atomic<bool>& running)
 	}
 }
 
-EventHandler::EventHandler(std::atomic<bool>& running, Editor* ed)
+EventHandler::EventHandler(std::atomic<bool>& running)
 {
-	editor = ed;
 	t = std::thread(windowSizeChangeEvent, std::ref(running));
 }
 
 EventHandler::~EventHandler()
 {
 	t.join();
+}
+
+const bool EventHandler::windowResized()
+{
+	return resizePending.exchange(false);
 }
\ No newline at end of file
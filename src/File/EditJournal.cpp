@@ -0,0 +1,296 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "EditJournal.hpp"
+
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+
+constexpr std::string_view journalTag = "mini-journal 1";
+
+EditJournal::EditJournal(std::filesystem::path journalPath, const FileIdentity base) : mPath(std::move(journalPath)), mBase(base)
+{}
+
+EditJournal::~EditJournal()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mBatchReady.notify_one();
+	if (mWriter.joinable()) mWriter.join();
+
+	mFile.close();
+	std::error_code ec;
+	if (mFileCreated) std::filesystem::remove(mPath, ec);
+}
+
+std::filesystem::path EditJournal::pathFor(const std::filesystem::path& filePath)
+{
+	std::filesystem::path journalPath = filePath;
+	journalPath += ".mini-journal";
+	return journalPath;
+}
+
+EditJournal::FileIdentity EditJournal::identify(const std::filesystem::path& filePath)
+{
+	std::error_code ec;
+	FileIdentity identity;
+	identity.size = std::filesystem::file_size(filePath, ec);
+	if (ec) return FileIdentity();
+	identity.modified = static_cast<int64_t>(std::filesystem::last_write_time(filePath, ec).time_since_epoch().count());
+	return identity;
+}
+
+std::string EditJournal::header(const FileIdentity base)
+{
+	return std::string(journalTag) + ' ' + std::to_string(base.size) + ' ' + std::to_string(base.modified) + '\n';
+}
+
+/// <summary>
+/// Reads the numbers in "row col count" from the start of str
+/// </summary>
+/// <returns> False if any of them are missing </returns>
+static bool parseNumbers(std::string_view str, size_t& row, size_t& col, size_t& count)
+{
+	size_t* numbers[] = { &row, &col, &count };
+	for (size_t* number : numbers)
+	{
+		if (str.empty() || str.front() != ' ') return false;
+		str.remove_prefix(1);
+		const std::from_chars_result result = std::from_chars(str.data(), str.data() + str.length(), *number);
+		if (result.ec != std::errc()) return false;
+		str.remove_prefix(result.ptr - str.data());
+	}
+	return str.empty();
+}
+
+size_t EditJournal::recover(PieceTable& document)
+{
+	std::lock_guard<std::mutex> fileLock(mFileMutex);
+
+	std::ifstream in(mPath, std::ios::binary);
+	if (!in.is_open()) return 0;
+	std::stringstream contents;
+	contents << in.rdbuf();
+	in.close();
+	const std::string journal = contents.str();
+
+	const std::string expectedHeader = header(mBase);
+	if (journal.compare(0, expectedHeader.length(), expectedHeader) != 0)
+	{
+		//Recorded against a different version of the file, so the edits can't be placed. They are kept to one side rather than lost
+		std::filesystem::path stalePath = mPath;
+		stalePath += ".stale";
+		std::error_code ec;
+		std::filesystem::rename(mPath, stalePath, ec);
+		if (!ec) mStalePath = std::move(stalePath);
+		return 0;
+	}
+
+	size_t edits = 0;
+	size_t pos = expectedHeader.length();
+	while (pos < journal.length())
+	{
+		const size_t lineEnd = journal.find('\n', pos);
+		if (lineEnd == std::string::npos) break;
+
+		const std::string_view line = std::string_view(journal).substr(pos, lineEnd - pos);
+		size_t row, col, count;
+		if (line.empty() || !parseNumbers(line.substr(1), row, col, count)) break;
+
+		size_t next = lineEnd + 1;
+		try
+		{
+			if (line.front() == 'i')
+			{
+				if (journal.length() - next < count) break; //The text was cut short
+				document.insert(row, col, std::string_view(journal).substr(next, count));
+				next += count;
+			}
+			else if (line.front() == 'e')
+			{
+				document.erase(row, col, count);
+			}
+			else break;
+		}
+		catch (const std::exception&)
+		{
+			break; //The edit doesn't fit the document, so nothing after it can be trusted either
+		}
+		pos = next;
+		++edits;
+	}
+
+	//Anything after the last good record is dropped, so new records follow straight on from it
+	std::error_code ec;
+	if (pos < journal.length()) std::filesystem::resize_file(mPath, pos, ec);
+	mFileCreated = true;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPosition = pos - expectedHeader.length();
+	}
+	mFileStart = 0;
+	return edits;
+}
+
+const std::filesystem::path& EditJournal::stalePath() const
+{
+	return mStalePath;
+}
+
+void EditJournal::inserted(const size_t row, const size_t col, const std::string_view text)
+{
+	record('i', row, col, text.length(), text);
+}
+
+void EditJournal::erased(const size_t row, const size_t col, const size_t count)
+{
+	record('e', row, col, count, std::string_view());
+}
+
+void EditJournal::record(const char type, const size_t row, const size_t col, const size_t count, const std::string_view text)
+{
+	char line[4 + 3 * 20]; //The type, three numbers, and the spaces and line break between them
+	char* end = line;
+	*end++ = type;
+	for (const size_t number : { row, col, count })
+	{
+		*end++ = ' ';
+		end = std::to_chars(end, line + sizeof(line), number).ptr;
+	}
+	*end++ = '\n';
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	const size_t before = mBatch.size();
+	mBatch.append(line, end - line);
+	mBatch.append(text);
+	mPosition += mBatch.size() - before;
+	mStats.bytes += mBatch.size() - before;
+	++mStats.records;
+
+	if (!mWriter.joinable()) mWriter = std::thread(&EditJournal::writeBatches, this);
+	if (before == 0 || (before < batchSize && mBatch.size() >= batchSize)) mBatchReady.notify_one();
+}
+
+const uint64_t EditJournal::position()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPosition;
+}
+
+void EditJournal::rebase(const uint64_t position, const FileIdentity base)
+{
+	std::lock_guard<std::mutex> fileLock(mFileMutex);
+	writeBatch();
+	mFile.close();
+
+	//The records made since position are all that isn't in the saved file
+	std::string tail;
+	if (mFileCreated)
+	{
+		std::ifstream in(mPath, std::ios::binary);
+		std::stringstream contents;
+		contents << in.rdbuf();
+		in.close();
+		const std::string journal = contents.str();
+		const size_t recordsStart = journal.find('\n') + 1;
+		const size_t tailStart = recordsStart + static_cast<size_t>(position - mFileStart);
+		if (recordsStart > 0 && tailStart < journal.length()) tail = journal.substr(tailStart);
+	}
+
+	mBase = base;
+	mFileStart = position;
+	std::error_code ec;
+	if (tail.empty())
+	{
+		std::filesystem::remove(mPath, ec);
+		mFileCreated = false; //Recreated with the new header on the next edit
+		return;
+	}
+
+	std::filesystem::path tempPath = mPath;
+	tempPath += ".tmp";
+	std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+	out << header(mBase) << tail;
+	out.close();
+	std::filesystem::rename(tempPath, mPath, ec);
+}
+
+void EditJournal::flush()
+{
+	std::lock_guard<std::mutex> fileLock(mFileMutex);
+	writeBatch();
+}
+
+const EditJournal::Stats EditJournal::stats()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+void EditJournal::writeBatches()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (!mStop)
+	{
+		mBatchReady.wait(lock, [this]() { return mStop || !mBatch.empty(); });
+		//Give more edits a chance to join the batch, unless it is already large
+		mBatchReady.wait_for(lock, flushInterval, [this]() { return mStop || mBatch.size() >= batchSize; });
+		if (mStop) break;
+
+		lock.unlock();
+		flush();
+		lock.lock();
+	}
+}
+
+void EditJournal::writeBatch()
+{
+	std::string batch;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mBatch.empty()) return;
+		batch.swap(mBatch);
+		mBatch.reserve(batch.capacity()); //Keeps the editor thread from growing the next batch from nothing
+		++mStats.flushes;
+	}
+
+	if (!mFile.is_open())
+	{
+		if (mFileCreated)
+		{
+			mFile.open(mPath, std::ios::binary | std::ios::app);
+		}
+		else
+		{
+			mFile.open(mPath, std::ios::binary | std::ios::trunc);
+			mFile << header(mBase);
+			mFileCreated = true;
+		}
+	}
+	mFile.write(batch.data(), batch.size());
+	mFile.flush(); //Into the OS, so the edits survive mini dying even if they haven't reached the disk
+}
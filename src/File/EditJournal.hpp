@@ -0,0 +1,194 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file EditJournal.hpp
+* @brief Keeps a journal of unsaved edits next to the file, so they can be recovered if mini dies before saving
+*
+* Each edit made to the document is added to an in-memory batch, and a background thread appends the batches to the journal file,
+* so typing never waits on the disk. The journal starts with the size and modification time of the file it was recorded against,
+* and is only replayed onto that same file. It is removed when mini closes normally, since the edits have then either been saved or thrown away.
+*
+* Each record is a line "i row col length" followed by the inserted text, or a line "e row col length"
+*/
+#pragma once
+#include "PieceTable/PieceTable.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+class EditJournal : public PieceTable::EditListener
+{
+public:
+	/// <summary>
+	/// Identifies the contents of a file without reading it
+	/// </summary>
+	struct FileIdentity
+	{
+		uintmax_t size = 0;
+		int64_t modified = 0;
+
+		bool operator==(const FileIdentity& other) const = default;
+	};
+
+	/// <summary>
+	/// How much has been journaled
+	/// </summary>
+	struct Stats
+	{
+		size_t records = 0;
+		size_t flushes = 0; //Batches appended to the journal file
+		size_t bytes = 0;
+	};
+
+	/// <summary>
+	/// Nothing is written until the first edit, so files that are only read never get a journal
+	/// </summary>
+	/// <param name="journalPath"></param>
+	/// <param name="base"> The file the edits are made to </param>
+	EditJournal(std::filesystem::path journalPath, const FileIdentity base);
+
+	/// <summary>
+	/// Stops the writer thread and removes the journal file
+	/// </summary>
+	~EditJournal() override;
+
+	EditJournal(const EditJournal&) = delete;
+	EditJournal& operator=(const EditJournal&) = delete;
+
+	/// <summary>
+	/// The journal's name for the given file
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <returns></returns>
+	static std::filesystem::path pathFor(const std::filesystem::path& filePath);
+
+	/// <summary>
+	/// The size and modification time of the file. Zeroed if it doesn't exist
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <returns></returns>
+	static FileIdentity identify(const std::filesystem::path& filePath);
+
+	/// <summary>
+	/// Replays the edits in a journal left behind for the file onto its freshly loaded document, and carries on adding to that journal
+	/// so the recovered edits aren't lost if mini dies again. Must be called before the journal is listening to the document.
+	/// A journal recorded against a different version of the file is set aside as <file>.mini-journal.stale rather than replayed (see stalePath()),
+	/// and a record cut short by a crash ends the replay
+	/// </summary>
+	/// <param name="document"> The document loaded from the file. Has to be fully indexed </param>
+	/// <returns> How many edits were replayed </returns>
+	size_t recover(PieceTable& document);
+
+	/// <summary>
+	/// Where recover() set aside a journal it couldn't replay, so the edits in it can still be found by hand. Empty if it didn't
+	/// </summary>
+	/// <returns></returns>
+	const std::filesystem::path& stalePath() const;
+
+	void inserted(const size_t row, const size_t col, const std::string_view text) override;
+	void erased(const size_t row, const size_t col, const size_t count) override;
+
+	/// <summary>
+	/// Where the journal is up to, counted in bytes of records. Taken when a save starts, to pass to rebase() once it is done
+	/// </summary>
+	/// <returns></returns>
+	const uint64_t position();
+
+	/// <summary>
+	/// Called after the file has been saved. Drops the records from before position, which are now in the file,
+	/// and starts the journal again from the saved file. Records made while the save was being written are kept
+	/// </summary>
+	/// <param name="position"> What position() returned when the saved snapshot was taken </param>
+	/// <param name="base"> The saved file </param>
+	void rebase(const uint64_t position, const FileIdentity base);
+
+	/// <summary>
+	/// Waits until every edit so far is in the journal file
+	/// </summary>
+	void flush();
+
+	/// <summary>
+	/// How much has been journaled
+	/// </summary>
+	/// <returns></returns>
+	const Stats stats();
+
+	inline static constexpr size_t batchSize = 64 * 1024; //A batch this large is written straight away
+	inline static constexpr std::chrono::milliseconds flushInterval{ 200 }; //Otherwise, how long an edit can wait before it is written
+
+private:
+	/// <summary>
+	/// Adds a record to the batch, starting the writer thread on the first one
+	/// </summary>
+	/// <param name="type"></param>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="count"></param>
+	/// <param name="text"></param>
+	void record(const char type, const size_t row, const size_t col, const size_t count, const std::string_view text);
+
+	/// <summary>
+	/// Runs on the writer thread. Writes the batch every flushInterval, or sooner once it reaches batchSize
+	/// </summary>
+	void writeBatches();
+
+	/// <summary>
+	/// Takes the batch and appends it to the journal file, creating the file if needed. Expects mFileMutex to be held,
+	/// which keeps batches in order
+	/// </summary>
+	void writeBatch();
+
+	/// <summary>
+	/// The first line of a journal recorded against base
+	/// </summary>
+	/// <param name="base"></param>
+	/// <returns></returns>
+	static std::string header(const FileIdentity base);
+
+private:
+	std::filesystem::path mPath;
+	FileIdentity mBase;
+
+	std::mutex mMutex; //Guards the batch and the counters, which the editor thread adds to
+	std::condition_variable mBatchReady;
+	std::string mBatch;
+	uint64_t mPosition = 0;
+	Stats mStats;
+	bool mStop = false;
+	std::thread mWriter;
+
+	std::mutex mFileMutex; //Guards the journal file
+	std::ofstream mFile;
+	uint64_t mFileStart = 0; //The position of the first record in the journal file
+	bool mFileCreated = false;
+	std::filesystem::path mStalePath;
+};
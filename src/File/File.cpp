@@ -23,21 +23,99 @@ SOFTWARE.
 */
 
 #include "File.hpp"
+#include "LineIndexCache.hpp"
+#include "Utility/LineScanner/LineScanner.hpp"
+#include "Utility/FileWriter/FileWriter.hpp"
 
-#include <exception>
-#include <sstream>
 #include <iostream>
 #include <fstream>
 #include <thread>
+#include <limits>
+#include <algorithm>
+#include <chrono>
 
-unsigned int maxThreads;
-constexpr uint16_t startingRowsPerThread = 20'000;
+constexpr size_t minBytesPerChunk = 1024 * 1024; //Smaller files aren't worth starting threads for
+constexpr size_t chunksPerThread = 4; //A thread that finishes early picks up another chunk, so uneven chunks and cores balance out
 constexpr uint8_t charactersPerRowAverage = 50; //Assume an average of 50 characters per row. This will need some testing to fine-tune
 
-FileHandler::FileHandler(const std::string_view fName) : mPath(std::filesystem::current_path() / fName), mFileName(fName)
+FileHandler::FileHandler(const std::string_view fName, const OpenMode mode, const bool useIndexCache) : mPath(std::filesystem::current_path() / fName), mFileName(fName),
+	mUseIndexCache(useIndexCache), mViewOnly(mode != OpenMode::Edit), mFollowing(mode == OpenMode::Follow)
 {
-	maxThreads = std::thread::hardware_concurrency();
+	if (mode == OpenMode::View)
+	{
+		mPagedFile = std::make_unique<PagedFile>();
+		if (mPagedFile->open(mPath))
+		{
+			std::error_code ec;
+			mLoadedBytes = std::filesystem::file_size(mPath, ec); //Nothing else in view mode reads it, but it tells the editor how large the file is
+			loadViewWindow(0);
+			return;
+		}
+		mPagedFile.reset(); //Empty files and anything else that can't be mapped are small enough to load normally
+	}
 	loadFileContents();
+	if (!mViewOnly)
+	{
+		startJournal();
+		mDiskIdentity = EditJournal::identify(mPath);
+		mWatcher.watch(mPath);
+	}
+}
+
+/// <summary>
+/// Reads the pipe until the other end is closed or the file handler stops it, handing what was read to the editor thread through progress
+/// </summary>
+static void readPipe(std::shared_ptr<FileHandler::PipeProgress> progress, PipeReader pipe)
+{
+	std::string buffer(FileHandler::pipeChunkSize, '\0');
+	while (!progress->stop)
+	{
+		{
+			//The other program waits while the document catches up, rather than everything it writes piling up in memory
+			std::unique_lock<std::mutex> lock(progress->mutex);
+			if (progress->pendingBytes >= FileHandler::maxPipeBacklog)
+			{
+				lock.unlock();
+				std::this_thread::sleep_for(std::chrono::milliseconds(PipeReader::waitTime));
+				continue;
+			}
+		}
+
+		const int64_t length = pipe.read(buffer.data(), buffer.length());
+		if (length < 0) continue; //Nothing yet
+
+		std::lock_guard<std::mutex> lock(progress->mutex);
+		if (length == 0)
+		{
+			progress->done = true;
+			return;
+		}
+		//Copied out at the size that was read, since a pipe usually gives far less than the buffer at a time
+		progress->chunks.emplace_back(buffer.data(), static_cast<size_t>(length));
+		progress->pendingBytes += static_cast<size_t>(length);
+	}
+}
+
+FileHandler::FileHandler(PipeReader&& pipe) : mFileName("(stdin)"), mViewOnly(true), mFollowing(true)
+{
+	mPipeProgress = std::make_shared<PipeProgress>();
+	mPipeThread = std::thread(readPipe, mPipeProgress, std::move(pipe));
+}
+
+FileHandler::~FileHandler()
+{
+	if (mPipeThread.joinable())
+	{
+		mPipeProgress->stop = true;
+		mPipeThread.join();
+	}
+	waitForSave();
+	mDocument.setEditListener(nullptr);
+	if (mIndexThread.joinable())
+	{
+		mIndexProgress->stop = true;
+		mIndexThread.join();
+	}
 }
 
 const std::string_view FileHandler::fileName()
@@ -45,115 +123,762 @@ const std::string_view FileHandler::fileName()
 	return mFileName;
 }
 
-void FileHandler::loadRows(const size_t startPos, const size_t endPos, const std::string_view str, std::promise<std::vector<FileHandler::Row>>&& p)
+/// <summary>
+/// Removes the '\r' from each "\r\n" so rows don't end with a stray carriage return
+/// </summary>
+/// <param name="str"></param>
+static void removeCarriageReturns(std::string& str)
+{
+	if (str.find("\r\n") == std::string::npos) return;
+
+	size_t writePos = 0;
+	for (size_t readPos = 0; readPos < str.length(); ++readPos)
+	{
+		if (str[readPos] == '\r' && readPos + 1 < str.length() && str[readPos + 1] == '\n') continue;
+		str[writePos++] = str[readPos];
+	}
+	str.resize(writePos);
+}
+
+/// <summary>
+/// Splits str into chunkCount pieces of roughly the same size. Every chunk but the last ends just after a '\n',
+/// so no row (or "\r\n") is split between two chunks
+/// </summary>
+/// <returns> The end position of each chunk </returns>
+static std::vector<size_t> splitIntoChunks(const std::string_view str, const size_t chunkCount)
+{
+	std::vector<size_t> chunkEnds;
+	chunkEnds.reserve(chunkCount);
+	const size_t targetLength = str.length() / chunkCount;
+
+	size_t end = 0;
+	for (size_t i = 1; i < chunkCount; ++i)
+	{
+		const size_t lineBreak = str.find('\n', std::max(end, i * targetLength));
+		if (lineBreak == std::string_view::npos) break;
+		end = lineBreak + 1;
+		chunkEnds.push_back(end);
+	}
+	if (chunkEnds.empty() || chunkEnds.back() != str.length()) chunkEnds.push_back(str.length());
+	return chunkEnds;
+}
+
+bool FileHandler::findLineBreaks(const std::string_view fileStr, LineIndex& lineBreaks, unsigned int threads)
+{
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	const size_t chunkCount = std::clamp<size_t>(fileStr.length() / minBytesPerChunk, 1, threads * chunksPerThread);
+	threads = static_cast<unsigned int>(std::min<size_t>(threads, chunkCount));
+
+	const std::vector<size_t> chunkEnds = splitIntoChunks(fileStr, chunkCount);
+	std::vector<std::vector<size_t>> chunkLineBreaks(chunkEnds.size());
+	std::vector<uint8_t> chunkHasCarriageReturn(chunkEnds.size()); //Not vector<bool>, since each thread writes its own element
+	std::atomic<size_t> nextChunk = 0;
+
+	auto indexChunks = [&]()
+		{
+			size_t chunk;
+			while ((chunk = nextChunk.fetch_add(1)) < chunkEnds.size())
+			{
+				const size_t start = (chunk == 0) ? 0 : chunkEnds[chunk - 1];
+				std::vector<size_t>& chunkIndex = chunkLineBreaks[chunk];
+				chunkIndex.reserve((chunkEnds[chunk] - start) / charactersPerRowAverage);
+				chunkHasCarriageReturn[chunk] = LineScanner::findLineBreaks(fileStr.substr(start, chunkEnds[chunk] - start), start, chunkIndex);
+			}
+		};
+
+	std::vector<std::thread> helpers;
+	helpers.reserve(threads - 1);
+	for (unsigned int i = 1; i < threads; ++i) helpers.emplace_back(indexChunks);
+	indexChunks(); //The calling thread takes chunks too, instead of just waiting
+	for (std::thread& helper : helpers) helper.join();
+
+	bool foundCarriageReturn = false;
+	for (size_t i = 0; i < chunkEnds.size(); ++i)
+	{
+		lineBreaks.append(std::move(chunkLineBreaks[i])); //Each chunk becomes its own segment of the index, so nothing gets copied
+		foundCarriageReturn |= (chunkHasCarriageReturn[i] != 0);
+	}
+	return foundCarriageReturn;
+}
+
+/// <summary>
+/// Indexes str from startPos onwards one chunk at a time, handing each chunk's line breaks to the editor thread through progress.
+/// Runs on its own thread during a progressive load. If cachePath isn't empty, the line breaks are read from the cache there when it matches the file,
+/// and otherwise saved to it once the whole file has been scanned
+/// </summary>
+static void indexInBackground(std::shared_ptr<FileHandler::IndexProgress> progress, const std::string_view str, const size_t startPos,
+	const std::filesystem::path filePath, const std::filesystem::path cachePath, const EditJournal::FileIdentity identity)
 {
-	std::vector<FileHandler::Row> rows;
-	rows.reserve((endPos - startPos) / charactersPerRowAverage);
-	size_t findPos;
-	std::string_view threadStr = str.substr(startPos, endPos - startPos);
+	LineIndexCache cache(cachePath, identity);
+	bool fromCache = false, savingCache = !cachePath.empty();
+	if (savingCache)
+	{
+		//The head was already scanned for the first screen. Scanning it again is cheap, and gives the cache's line breaks something to be checked against
+		std::vector<size_t> headLineBreaks, cachedLineBreaks;
+		LineScanner::findLineBreaks(str.substr(0, startPos), 0, headLineBreaks);
+		fromCache = cache.open(str) && cache.read(startPos, cachedLineBreaks) && cachedLineBreaks == headLineBreaks;
+		savingCache = !fromCache;
+		if (savingCache) cache.add(headLineBreaks);
+	}
 
-	while ((findPos = threadStr.find('\n')) != std::string_view::npos)
+	for (size_t pos = startPos; pos < str.length() && !progress->stop; pos += FileHandler::progressiveChunkSize)
 	{
-		if (findPos > 0 && threadStr.at(findPos - 1) == '\r')
+		const size_t length = std::min(FileHandler::progressiveChunkSize, str.length() - pos);
+		std::vector<size_t> chunkLineBreaks;
+		chunkLineBreaks.reserve(length / charactersPerRowAverage);
+		bool foundCarriageReturn = false;
+		if (fromCache && !cache.read(pos + length, chunkLineBreaks))
+		{
+			//A damaged cache is scanned past from here on, and rebuilt the next time the file is opened
+			fromCache = false;
+			chunkLineBreaks.clear();
+			std::error_code ec;
+			std::filesystem::remove(cachePath, ec);
+		}
+		if (!fromCache)
 		{
-			rows.emplace_back(std::string(threadStr.substr(0, findPos - 1)));
+			foundCarriageReturn = LineScanner::findLineBreaks(str.substr(pos, length), pos, chunkLineBreaks);
+			foundCarriageReturn |= (str[pos - 1] == '\r' && str[pos] == '\n'); //A "\r\n" split between two chunks
+			savingCache &= !foundCarriageReturn; //The file gets loaded as a normalized copy instead, which isn't worth caching
+			if (savingCache) cache.add(chunkLineBreaks);
 		}
-		else
+
 		{
-			rows.emplace_back(std::string(threadStr.substr(0, findPos)));
+			std::lock_guard<std::mutex> lock(progress->mutex);
+			progress->lineBreaks.push_back(std::move(chunkLineBreaks));
+			progress->indexedLength = pos + length;
+			progress->foundCarriageReturn |= foundCarriageReturn;
+			progress->fromCache = fromCache;
 		}
-		threadStr = threadStr.substr(findPos + 1);
+		progress->indexed.notify_all();
 	}
-	rows.emplace_back(std::string(threadStr));
-	p.set_value(rows);
-}
 
+	if (savingCache && !progress->stop) cache.save(filePath);
+	{
+		std::lock_guard<std::mutex> lock(progress->mutex);
+		progress->done = true;
+	}
+	progress->indexed.notify_all();
+}
 
 void FileHandler::loadFileContents()
 {
-	std::ifstream file(mPath);
-	std::stringstream fileContents;
-	fileContents << file.rdbuf();
-	file.close();
+	MappedFile mapping;
+	LineIndex lineBreaks;
+	mLongestRow = 0;
+	mNextRowStart = 0;
 
-	const std::string& fileStr = fileContents.str();
+	//A followed file can be truncated in place while it is open (like logrotate's copytruncate does), and reading
+	//the mapped pages past its new end would raise SIGBUS, so it is read into a copy instead
+	if (!mFollowing && mapping.open(mPath))
+	{
+		const std::string_view str = mapping.view();
+		mLoadedBytes = str.length();
+		if (str.length() > progressiveLoadSize)
+		{
+			//Only the head of the file is indexed up front, so the first screen can be drawn straight away
+			const std::string_view head = str.substr(0, progressiveChunkSize);
+			if (!lineBreaks.scan(head, 0))
+			{
+				measureRows(lineBreaks);
+				mDocument = PieceTable(std::move(mapping), std::move(lineBreaks), false);
+				mIndexedLength = head.length();
+				mIndexProgress = std::make_shared<IndexProgress>();
+				const std::filesystem::path cachePath = mUseIndexCache ? LineIndexCache::pathFor(mPath) : std::filesystem::path();
+				mIndexThread = std::thread(indexInBackground, mIndexProgress, str, head.length(), mPath, cachePath, EditJournal::identify(mPath));
+				return;
+			}
+		}
+		else if (!findLineBreaks(str, lineBreaks))
+		{
+			measureRows(lineBreaks);
+			mLongestRow = std::max<size_t>(mLongestRow, str.length() - mNextRowStart);
+			mDocument = PieceTable(std::move(mapping), std::move(lineBreaks));
+			return;
+		}
+	}
+	mapping.close();
+
+	loadFileCopy();
+}
+
+void FileHandler::loadFileCopy()
+{
+	//Files with "\r\n" line endings get normalized, so they need their own copy
+	std::string fileStr;
+	const int64_t bytesRead = readText(mPath, fileStr);
+	if (bytesRead < 0) return;
+	mLoadedBytes = static_cast<uint64_t>(bytesRead);
 	if (fileStr.length() == 0) return;
 
-	if (fileStr.length() <= (startingRowsPerThread * charactersPerRowAverage))
+	LineIndex lineBreaks;
+	findLineBreaks(fileStr, lineBreaks);
+	mLongestRow = 0;
+	mNextRowStart = 0;
+	measureRows(lineBreaks);
+	mLongestRow = std::max<size_t>(mLongestRow, fileStr.length() - mNextRowStart);
+	mDocument = PieceTable(std::move(fileStr), std::move(lineBreaks));
+}
+
+void FileHandler::measureRows(const std::vector<size_t>& lineBreaks)
+{
+	for (const size_t lineBreak : lineBreaks)
+	{
+		mLongestRow = std::max(mLongestRow, lineBreak - mNextRowStart);
+		mNextRowStart = lineBreak + 1;
+	}
+}
+
+void FileHandler::measureRows(const LineIndex& lineBreaks)
+{
+	for (size_t i = 0; i < lineBreaks.segmentCount(); ++i)
 	{
-		std::promise<std::vector<FileHandler::Row>> promise;
-		std::future<std::vector<FileHandler::Row>> value = promise.get_future();
-		loadRows(0, fileStr.length(), fileStr, std::move(promise));
-		mRows = value.get();
-		return;
+		measureRows(lineBreaks.segment(i));
 	}
+}
+
+int64_t FileHandler::readText(const std::filesystem::path& path, std::string& text)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) return -1;
 
-	std::vector<std::thread> allThreads;
-	std::vector<std::future<std::vector<FileHandler::Row>>> retValues;
-	unsigned int threads = (fileStr.length() / (startingRowsPerThread * charactersPerRowAverage)) + 1;
-	if (threads > maxThreads) threads = maxThreads;
-	const uint16_t lengthPerThread =  (startingRowsPerThread * charactersPerRowAverage) / threads; //splitting the work up evenly
-	size_t prevEndPos = 0;
-	for (unsigned int i = 0; i < threads; ++i)
+	std::error_code ec;
+	const uintmax_t fileSize = std::filesystem::file_size(path, ec);
+	text.clear();
+	if (!ec && fileSize > 0)
 	{
-		size_t startPos = prevEndPos;
-		if (i > 0) ++startPos;
+		text.resize(fileSize);
+		file.read(text.data(), fileSize);
+		text.resize(file.gcount());
+	}
+	file.close();
+
+	const int64_t bytesRead = static_cast<int64_t>(text.length());
+	removeCarriageReturns(text);
+	return bytesRead;
+}
+
+const bool FileHandler::isIndexing() const
+{
+	return !mDocument.isIndexed();
+}
 
-		size_t endPos = (i == threads - 1) ? fileStr.length() : startPos + lengthPerThread;
+const uint8_t FileHandler::indexProgress() const
+{
+	if (mPagedFile != nullptr) return mPagedFile->scanProgress();
+	if (mDocument.isIndexed() || mDocument.length() == 0) return 100;
+	return static_cast<uint8_t>(mIndexedLength * 100 / mDocument.length());
+}
+
+const bool FileHandler::indexedFromCache() const
+{
+	return mIndexedFromCache;
+}
+
+void FileHandler::syncIndex()
+{
+	if (mIndexProgress == nullptr) return;
 
-		if (endPos < fileStr.length())
+	std::vector<std::vector<size_t>> lineBreaks;
+	bool done, foundCarriageReturn;
+	{
+		std::lock_guard<std::mutex> lock(mIndexProgress->mutex);
+		lineBreaks.swap(mIndexProgress->lineBreaks);
+		mIndexedLength = mIndexProgress->indexedLength;
+		done = mIndexProgress->done;
+		foundCarriageReturn = mIndexProgress->foundCarriageReturn;
+		mIndexedFromCache = mIndexProgress->fromCache;
+	}
+	for (std::vector<size_t>& chunkLineBreaks : lineBreaks)
+	{
+		measureRows(chunkLineBreaks);
+		mDocument.appendOriginalLineBreaks(std::move(chunkLineBreaks), false);
+	}
+	if (!done) return;
+	mDocument.appendOriginalLineBreaks({}, true);
+	mLongestRow = std::max<size_t>(mLongestRow, mDocument.length() - mNextRowStart);
+
+	mIndexThread.join();
+	mIndexProgress.reset();
+	if (foundCarriageReturn)
+	{
+		//Nothing can be edited while indexing, so switching to a normalized copy doesn't lose anything. The rows stay the same, minus the '\r's
+		mDocument = PieceTable();
+		loadFileCopy();
+	}
+	if (mJournal != nullptr) mDocument.setEditListener(mJournal.get()); //Editing can start now the document is complete
+}
+
+void FileHandler::waitForRows(const size_t rowCount)
+{
+	syncIndex();
+	while (mIndexProgress != nullptr && mDocument.lineCount() < rowCount)
+	{
 		{
-			while (fileStr.at(endPos) != '\n' && endPos != fileStr.length()) ++endPos;
+			std::unique_lock<std::mutex> lock(mIndexProgress->mutex);
+			mIndexProgress->indexed.wait(lock, [this]() { return !mIndexProgress->lineBreaks.empty() || mIndexProgress->done; });
 		}
-		prevEndPos = endPos;
+		syncIndex();
+	}
+}
+
+void FileHandler::waitForIndex()
+{
+	waitForRows(std::numeric_limits<size_t>::max());
+}
+
+const uint64_t FileHandler::fileSize() const
+{
+	return mLoadedBytes;
+}
+
+const size_t FileHandler::longestRow() const
+{
+	return mLongestRow;
+}
+
+const bool FileHandler::isViewOnly() const
+{
+	return mViewOnly;
+}
+
+const bool FileHandler::isFollowing() const
+{
+	return mFollowing;
+}
+
+FileHandler::Appended FileHandler::readAppended()
+{
+	Appended appended;
+	if (!mFollowing || isIndexing()) return appended; //Rows can only be added once the document is complete
+
+	const size_t heldLength = mPartialRow.length();
+	bool inputEnded = false;
+	if (mPipeProgress != nullptr)
+	{
+		inputEnded = takePiped();
+		appended.ended = (inputEnded && !mPipeEnded);
+		mPipeEnded = inputEnded;
+	}
+	else if (!readFileEnd(appended)) return appended;
+
+	//What was held back has no line break in it, so only the new bytes are searched
+	const size_t newLineBreak = std::string_view(mPartialRow).substr(heldLength).rfind('\n');
+	size_t rowsEnd = (newLineBreak == std::string_view::npos) ? 0 : heldLength + newLineBreak + 1;
+	if (inputEnded) rowsEnd = mPartialRow.length(); //Nothing more is coming, so the last row is complete without its line break
+	if (rowsEnd == 0) return appended;
+
+	std::string complete = mPartialRow.substr(0, rowsEnd);
+	mPartialRow.erase(0, rowsEnd);
+	removeCarriageReturns(complete);
+
+	if (mDocument.lineCount() == 0) mDocument.pushBackLine();
+	const size_t lastRow = mDocument.lineCount() - 1;
+	mDocument.insert(lastRow, mDocument.lineLength(lastRow), complete);
 
-		std::promise<std::vector<FileHandler::Row>> p;
-		retValues.emplace_back(p.get_future());
-		allThreads.emplace_back(&FileHandler::loadRows, this, startPos, endPos, fileStr, std::move(p));
+	appended.changed = true;
+	appended.firstRow = lastRow;
+	appended.newRows = mDocument.lineCount() - 1 - lastRow;
+	return appended;
+}
+
+bool FileHandler::readFileEnd(Appended& appended)
+{
+	std::error_code ec;
+	const uintmax_t fileSize = std::filesystem::file_size(mPath, ec);
+	if (ec || fileSize == mLoadedBytes) return false;
+	if (fileSize < mLoadedBytes)
+	{
+		//Whatever was read before is gone, so start again from the new file
+		mFollowStream.close();
+		mPartialRow.clear();
+		mDocument = PieceTable();
+		loadFileContents();
+		appended.changed = appended.truncated = true;
+		return false;
+	}
 
-		if (endPos == fileStr.length()) break;
+	if (!mFollowStream.is_open())
+	{
+		mFollowStream.open(mPath, std::ios::binary);
+		if (!mFollowStream.is_open()) return false;
 	}
+	mFollowStream.clear(); //Reading up to the end last time set eof
+	mFollowStream.seekg(mLoadedBytes);
 
-	mRows.reserve(fileStr.length() / charactersPerRowAverage);
+	//A file growing faster than it can be shown is caught up with over a few frames, so the screen never stops responding
+	const size_t toRead = static_cast<size_t>(std::min<uintmax_t>(fileSize - mLoadedBytes, maxAppendedRead));
+	const size_t heldLength = mPartialRow.length();
+	mPartialRow.resize(heldLength + toRead);
+	mFollowStream.read(mPartialRow.data() + heldLength, toRead);
+	const size_t bytesRead = static_cast<size_t>(mFollowStream.gcount());
+	mPartialRow.resize(heldLength + bytesRead);
+	mLoadedBytes += bytesRead;
+	return bytesRead > 0;
+}
 
-	for (unsigned int i = 0; i < threads; ++i)
+bool FileHandler::takePiped()
+{
+	std::lock_guard<std::mutex> lock(mPipeProgress->mutex);
+	size_t taken = 0;
+	while (!mPipeProgress->chunks.empty() && taken < maxAppendedRead)
 	{
-		allThreads.at(i).join();
-		auto& value = retValues.at(i);
-		const std::vector<FileHandler::Row>& threadFileRows = value.get();
+		const std::string& chunk = mPipeProgress->chunks.front();
+		mPartialRow.append(chunk);
+		taken += chunk.length();
+		mPipeProgress->chunks.pop_front();
+	}
+	mPipeProgress->pendingBytes -= taken;
+	mLoadedBytes += taken;
+	return mPipeProgress->done && mPipeProgress->chunks.empty();
+}
+
+const size_t FileHandler::firstRow() const
+{
+	return mFirstRow;
+}
+
+const size_t FileHandler::lineCount() const
+{
+	if (mPagedFile != nullptr) return std::max(mPagedFile->knownRows(), mFirstRow + mDocument.lineCount());
+	return mDocument.lineCount();
+}
+
+const int64_t FileHandler::followRow(const size_t row)
+{
+	if (mPagedFile == nullptr) return 0;
+
+	//Move the window before the row reaches its edge, so moving a page at a time never runs into the end of the window
+	const size_t rows = mDocument.lineCount();
+	const size_t margin = rows / 4;
+	const bool nearStart = (row < margin && mFirstRow > 0);
+	const bool nearEnd = (row + margin >= rows && !mViewReachesEnd);
+	if (!nearStart && !nearEnd) return 0;
+
+	return showRow(mFirstRow + row);
+}
+
+const int64_t FileHandler::showRow(size_t fileRow)
+{
+	if (mPagedFile == nullptr) return 0;
 
-		mRows.insert(mRows.end(), threadFileRows.begin(), threadFileRows.end());
+	if (fileRow == std::string::npos)
+	{
+		mPagedFile->scanToEnd();
+		fileRow = mPagedFile->knownRows() - 1;
 	}
+
+	//Put the row in the middle of the window, using the current window's size as a guess at the next one's
+	const size_t half = std::max(mDocument.lineCount(), size_t(2)) / 2;
+	const size_t newFirstRow = (fileRow > half) ? fileRow - half : 0;
+	const size_t oldFirstRow = mFirstRow;
+	loadViewWindow(newFirstRow);
+	return static_cast<int64_t>(mFirstRow) - static_cast<int64_t>(oldFirstRow);
+}
+
+void FileHandler::loadViewWindow(const size_t firstRow)
+{
+	std::string window;
+	const size_t rows = mPagedFile->copyRows(firstRow, viewWindowRows, viewWindowBytes, viewMaxRowLength, window);
+	if (rows == 0) return; //Past the end of the file, so keep the current window
+
+	mFirstRow = firstRow;
+	mViewReachesEnd = (mPagedFile->isScanned() && mFirstRow + rows == mPagedFile->knownRows());
+	mDocument = PieceTable(std::move(window));
+	if (mDocument.lineCount() == 0) mDocument.pushBackLine(); //A file with one empty row
 }
 
-std::vector<FileHandler::Row>* FileHandler::getFileContents()
+PieceTable* FileHandler::getFileContents()
 {
-	return &mRows;
+	return &mDocument;
 }
 
-void FileHandler::saveFile()
+void FileHandler::saveFile(const bool sync)
 {
-	std::stringstream output;
-	for (size_t i = 0; i < mRows.size(); ++i)
+	if (mViewOnly) return;
+	waitForSave();
+
+	SaveProgress progress;
+	prepareSave(progress, sync);
+	writeSave(progress);
+	mLastSave = std::move(progress.stats);
+	if (!mLastSave.error.empty())
 	{
-		if (i == mRows.size() - 1)
+		std::cerr << "Error saving file. ERROR: " << mLastSave.error << std::endl;
+		return;
+	}
+	recordSave(progress.journalPosition);
+}
+
+void FileHandler::saveFileInBackground(const bool sync)
+{
+	if (mViewOnly) return;
+	waitForSave(); //The snapshot's views have to stay valid, so only one save runs at a time
+
+	mSaveProgress = std::make_shared<SaveProgress>();
+	prepareSave(*mSaveProgress, sync);
+	mSaveThread = std::thread([progress = mSaveProgress]()
 		{
-			output << mRows.at(i).line;
-		}
-		else [[ likely ]]
+			writeSave(*progress);
+			progress->done = true;
+		});
+}
+
+const bool FileHandler::isSaving() const
+{
+	return mSaveProgress != nullptr && !mSaveProgress->done;
+}
+
+bool FileHandler::collectSave()
+{
+	if (mSaveProgress == nullptr || !mSaveProgress->done) return false;
+	return waitForSave();
+}
+
+bool FileHandler::waitForSave()
+{
+	if (!mSaveThread.joinable()) return false;
+	mSaveThread.join();
+	mLastSave = std::move(mSaveProgress->stats);
+	if (mLastSave.error.empty()) recordSave(mSaveProgress->journalPosition);
+	mSaveProgress.reset();
+	return true;
+}
+
+const FileHandler::SaveStats& FileHandler::lastSave() const
+{
+	return mLastSave;
+}
+
+const size_t FileHandler::recoveredEdits() const
+{
+	return mRecoveredEdits;
+}
+
+const bool FileHandler::hasStaleJournal() const
+{
+	return mJournal != nullptr && !mJournal->stalePath().empty();
+}
+
+EditJournal* FileHandler::journal()
+{
+	return mJournal.get();
+}
+
+void FileHandler::startJournal()
+{
+	const std::filesystem::path journalPath = EditJournal::pathFor(mPath);
+	std::error_code ec;
+	const bool hasJournal = std::filesystem::exists(journalPath, ec);
+	if (hasJournal) waitForIndex(); //The edits can only be replayed onto the whole file. Done before the journal exists, so it isn't attached yet
+
+	mJournal = std::make_unique<EditJournal>(journalPath, EditJournal::identify(mPath));
+	if (hasJournal) mRecoveredEdits = mJournal->recover(mDocument);
+	if (mDocument.isIndexed()) mDocument.setEditListener(mJournal.get()); //Otherwise attached once indexing is done
+}
+
+void FileHandler::recordSave(const uint64_t journalPosition)
+{
+	mDiskIdentity = EditJournal::identify(mPath);
+	if (mJournal == nullptr) return;
+	mJournal->rebase(journalPosition, mDiskIdentity);
+}
+
+FileHandler::Reload FileHandler::reloadIfChanged(const bool hasUnsavedChanges)
+{
+	Reload reload;
+	if (mViewOnly) return reload;
+	if (mWatcher.hasChanged()) mDiskChangePending = true;
+
+	//A truncated file would crash whatever reads the mapping past its new end, so it is dealt with without waiting for the writer to close it
+	if (mDocument.isMapped() && mDocument.mappedOriginal().fileLength() < mDocument.mappedOriginal().view().length()) mDiskChangePending = true;
+	if (!mDiskChangePending || isSaving() || isIndexing()) return reload; //Checked again once the file has settled
+
+	//The document is kept for its unsaved changes, but a file written over in place can't be read through the mapping any more
+	if (hasUnsavedChanges && mDocument.isMapped() && mDocument.mappedOriginal().refersTo(mPath)) reload.lostBytes = mDocument.detachMapping();
+	mDiskChangePending = false;
+
+	const EditJournal::FileIdentity identity = EditJournal::identify(mPath);
+	if (identity == mDiskIdentity) return reload; //Our own save
+	reload.changedOnDisk = true;
+	if (hasUnsavedChanges || identity == EditJournal::FileIdentity()) return reload; //Removed files are left alone too, so the document can be saved again
+
+	const uint64_t journalPosition = (mJournal != nullptr) ? mJournal->position() : 0;
+	mDocument.setEditListener(nullptr); //The reload matches the document to the file, so it isn't an edit to journal
+
+	//The old file is only still readable through the mapping if the new one replaced it, rather than being written over it
+	MappedFile current;
+	const bool canCompare = !mDocument.isMapped() || !mDocument.mappedOriginal().refersTo(mPath);
+	if (canCompare && current.open(mPath) && reloadChangedRegion(current.view(), reload))
+	{
+		reload.reloaded = true;
+	}
+	else
+	{
+		current.close();
+		mDocument = PieceTable();
+		loadFileContents();
+		reload.reloaded = reload.wholeFile = true;
+	}
+
+	mDiskIdentity = identity;
+	if (mJournal != nullptr)
+	{
+		mJournal->rebase(journalPosition, mDiskIdentity);
+		if (mDocument.isIndexed()) mDocument.setEditListener(mJournal.get()); //Otherwise attached once indexing is done
+	}
+	return reload;
+}
+
+bool FileHandler::reloadChangedRegion(const std::string_view current, Reload& reload)
+{
+	std::vector<std::string_view> pieces;
+	mDocument.pieceViews(pieces);
+	const size_t oldLength = mDocument.length();
+	const size_t commonLength = std::min(oldLength, current.length());
+
+	//How much of the start is the same
+	size_t prefix = 0;
+	for (const std::string_view piece : pieces)
+	{
+		const size_t length = std::min(piece.length(), commonLength - prefix);
+		const auto mismatch = std::mismatch(piece.begin(), piece.begin() + length, current.begin() + prefix);
+		prefix += mismatch.first - piece.begin();
+		if (mismatch.first != piece.end()) break;
+	}
+
+	//How much of the end is the same, not overlapping the start
+	size_t suffix = 0;
+	for (auto piece = pieces.rbegin(); piece != pieces.rend() && prefix + suffix < commonLength; ++piece)
+	{
+		const size_t length = std::min(piece->length(), commonLength - prefix - suffix);
+		const auto mismatch = std::mismatch(piece->rbegin(), piece->rbegin() + length, current.rbegin() + suffix);
+		suffix += mismatch.first - piece->rbegin();
+		if (mismatch.first != piece->rend()) break;
+	}
+
+	//Only whole rows are replaced, so every row is either untouched or replaced.
+	//The start moves back to the start of its row, and the end moves forward to the line break ending its row, which both files share
+	const size_t rowStart = (prefix == 0) ? std::string_view::npos : current.find_last_of('\n', prefix - 1);
+	prefix = (rowStart == std::string_view::npos) ? 0 : rowStart + 1;
+	const size_t rowEnd = (suffix == 0) ? std::string_view::npos : current.find('\n', current.length() - suffix);
+	suffix = (rowEnd == std::string_view::npos) ? 0 : current.length() - rowEnd;
+
+	const std::string_view replacement = current.substr(prefix, current.length() - prefix - suffix);
+	if (replacement.find('\r') != std::string_view::npos) return false; //Line endings need normalizing, which loading the whole file does
+	if (mDocument.lineCount() == 0) return false;
+
+	const size_t replacedLength = oldLength - prefix - suffix;
+	if (replacedLength == 0 && replacement.empty()) return true; //Written again without changing anything
+
+	const size_t firstRow = std::count(current.begin(), current.begin() + prefix, '\n');
+	const size_t oldLineCount = mDocument.lineCount();
+	const size_t suffixLineBreaks = std::count(current.end() - suffix, current.end(), '\n');
+	try
+	{
+		mDocument.erase(firstRow, 0, replacedLength);
+		if (mDocument.lineCount() == 0) mDocument.pushBackLine();
+		mDocument.insert(firstRow, 0, replacement);
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+
+	reload.firstRow = firstRow;
+	reload.oldEndRow = oldLineCount - suffixLineBreaks;
+	reload.rowDelta = static_cast<int64_t>(mDocument.lineCount()) - static_cast<int64_t>(oldLineCount);
+	reload.byteDelta = static_cast<int64_t>(replacement.length()) - static_cast<int64_t>(replacedLength);
+	return true;
+}
+
+void FileHandler::prepareSave(SaveProgress& progress, const bool sync)
+{
+	waitForIndex();
+#ifdef _WIN32
+	mDocument.detachMapping(); //Windows won't let a mapped file be replaced
+#endif
+
+	std::error_code ec;
+	progress.target = mPath;
+	if (std::filesystem::is_symlink(progress.target, ec)) progress.target = std::filesystem::canonical(progress.target, ec);
+	progress.sync = sync;
+	progress.stats.version = mDocument.version();
+	if (mJournal != nullptr) progress.journalPosition = mJournal->position();
+	mDocument.pieceViews(progress.pieces);
+	if (mDocument.isMapped())
+	{
+		progress.original = mDocument.mappedOriginal().view();
+		progress.originalFile = mDocument.mappedOriginal().nativeHandle();
+	}
+}
+
+void FileHandler::writeSave(SaveProgress& progress)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	//The document may still be reading from a mapping of the file, so the file is never truncated in place.
+	//The new contents are written next to it and renamed over the top, which leaves the mapped copy untouched
+	//The name is unique, so another editor saving the same file, or a temporary file left behind by a crash, is never written over
+	std::error_code ec;
+	std::filesystem::path tempPrefix = progress.target;
+	tempPrefix += ".mini-save";
+
+	//Each piece is written straight out of the document, instead of first joining them all into one string.
+	//Long ranges that haven't changed since the file was loaded are copied from the original file by the kernel, and the pieces between them are written together
+	FileWriter file;
+	bool written = file.openUnique(tempPrefix);
+	const std::filesystem::path tempPath = file.path();
+	std::vector<std::string_view> pending;
+	for (const std::string_view piece : progress.pieces)
+	{
+		if (!written) break;
+		const bool isOriginal = !progress.original.empty() && piece.data() >= progress.original.data() && piece.data() < progress.original.data() + progress.original.length();
+		if (!isOriginal || piece.length() < minCopyLength)
 		{
-			output << mRows.at(i).line << '\n';
+			pending.push_back(piece);
+			continue;
 		}
+
+		written = file.write(pending) && file.copy(progress.originalFile, piece.data() - progress.original.data(), piece);
+		pending.clear();
+	}
+	written = written && file.write(pending);
+	if (written && progress.sync) written = file.sync();
+	const size_t bytesWritten = file.bytesWritten();
+	const size_t bytesCopied = file.bytesCopied();
+	written = file.close() && written;
+	if (!written)
+	{
+		if (!tempPath.empty()) std::filesystem::remove(tempPath, ec);
+		progress.stats.error = "could not write " + (tempPath.empty() ? tempPrefix : tempPath).string();
+		return;
 	}
-	std::ofstream file(mPath);
 
-	try
+	if (std::filesystem::exists(progress.target, ec))
 	{
-		file << output.str();
+		std::filesystem::permissions(tempPath, std::filesystem::status(progress.target, ec).permissions(), ec);
 	}
-	catch (std::exception ex)
+	std::filesystem::rename(tempPath, progress.target, ec);
+	if (ec)
 	{
-		file.close();
-		std::cerr << "Error saving file. ERROR: " << ex.what() << std::endl;
+		progress.stats.error = ec.message();
+		std::filesystem::remove(tempPath, ec);
+		return;
 	}
+
+	//The rename is only an entry in the directory, which has to reach the disk as well for the new contents to survive a crash
+	if (progress.sync)
+	{
+		const std::filesystem::path directory = progress.target.has_parent_path() ? progress.target.parent_path() : std::filesystem::path(".");
+		if (!FileWriter::syncDirectory(directory))
+		{
+			progress.stats.error = "could not sync " + directory.string();
+			return;
+		}
+	}
+
+	progress.stats.bytes = bytesWritten;
+	progress.stats.bytesCopied = bytesCopied;
+	progress.stats.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
 }
\ No newline at end of file
@@ -23,25 +23,101 @@ SOFTWARE.
 */
 
 #pragma once
+#include "PieceTable/PieceTable.hpp"
+#include "PagedFile.hpp"
+#include "EditJournal.hpp"
+#include "Utility/FileWatcher/FileWatcher.hpp"
+#include "Utility/PipeReader/PipeReader.hpp"
+
 #include <string>
 #include <string_view>
 #include <vector>
+#include <deque>
 #include <filesystem>
-#include <future>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <chrono>
 
 class FileHandler
 {
 public:
-	FileHandler(const std::string_view fName);
 	/// <summary>
-	/// The structure of each row in the file.
-	/// line is what is actually stored, including \t and other characters
-	/// renderedLine is what gets displayed to the user
+	/// Edit loads the whole file into the document.
+	/// View is read-only, for files too large to index in full: the document only holds a window of rows around the cursor,
+	/// copied out of a PagedFile, and the window moves as the file is scrolled through.
+	/// Follow is read-only too, for files that are still being written (like logs). The whole file is copied in rather than mapped, and readAppended() adds whatever is written to the end of it
+	/// </summary>
+	enum class OpenMode
+	{
+		Edit,
+		View,
+		Follow
+	};
+
+	/// <param name="fName"></param>
+	/// <param name="mode"></param>
+	/// <param name="useIndexCache"> Whether a file large enough to be indexed in the background keeps its line breaks in a LineIndexCache next to it </param>
+	FileHandler(const std::string_view fName, const OpenMode mode = OpenMode::Edit, const bool useIndexCache = true);
+
+	/// <summary>
+	/// Reads the document from a pipe instead of a file, such as another program's output (cmd | mini -).
+	/// A thread reads the pipe as the output arrives, and readAppended() adds it to the document the same way as in follow mode
+	/// </summary>
+	/// <param name="pipe"></param>
+	FileHandler(PipeReader&& pipe);
+	~FileHandler();
+	FileHandler(FileHandler&&) = default;
+	FileHandler& operator=(FileHandler&&) = delete;
+
+	/// <summary>
+	/// The state shared with the thread that indexes the rest of a large file after the first screen has been drawn.
+	/// Each chunk's line breaks wait in lineBreaks until the editor thread moves them into the document
+	/// </summary>
+	struct IndexProgress
+	{
+		std::mutex mutex;
+		std::condition_variable indexed;
+		std::vector<std::vector<size_t>> lineBreaks;
+		size_t indexedLength = 0;
+		bool foundCarriageReturn = false;
+		bool fromCache = false; //Whether the line breaks were read from a LineIndexCache instead of the file
+		bool done = false;
+		std::atomic<bool> stop = false;
+	};
+
+	/// <summary>
+	/// The state shared with the thread that reads piped input. What has been read waits in chunks until readAppended() adds it to the document
+	/// </summary>
+	struct PipeProgress
+	{
+		std::mutex mutex;
+		std::deque<std::string> chunks;
+		size_t pendingBytes = 0;
+		bool done = false; //The other end of the pipe was closed
+		std::atomic<bool> stop = false;
+	};
+
+	inline static constexpr size_t progressiveLoadSize = 64 * 1024 * 1024; //Files larger than this are indexed in the background
+	inline static constexpr size_t progressiveChunkSize = 4 * 1024 * 1024; //How much gets indexed before the line breaks are handed over
+	inline static constexpr size_t maxAppendedRead = 16 * 1024 * 1024; //The most readAppended() reads at once in follow mode
+	inline static constexpr size_t pipeChunkSize = 1024 * 1024; //The most read from a pipe at once
+	inline static constexpr size_t maxPipeBacklog = 64 * 1024 * 1024; //The pipe stops being read while this much is waiting to be added to the document
+	inline static constexpr size_t viewWindowRows = 4096; //The most rows the document holds in view mode
+	inline static constexpr size_t viewWindowBytes = 16 * 1024 * 1024; //The most text the document holds in view mode
+	inline static constexpr size_t viewMaxRowLength = 64 * 1024; //Rows longer than this are cut off in view mode
+	inline static constexpr size_t minCopyLength = 64 * 1024; //Unchanged ranges shorter than this are saved from memory along with the edits around them
+	/// <summary>
+	/// The structure of a row pulled out of the document.
+	/// line is what is actually stored, including \t and other characters. What gets displayed lives in the editor's ViewportCache
 	/// </summary>
 	struct Row
 	{
 		std::string line;
-		std::string renderedLine;
 
 		bool operator==(const Row& other) const
 		{
@@ -50,10 +126,10 @@ public:
 	};
 
 	/// <summary>
-	/// Moves the file contents to the editor since the file handler no longer needs it. 
+	/// Gives the editor access to the document. The file handler keeps ownership so it can save it.
 	/// </summary>
 	/// <returns></returns>
-	std::vector<Row>* getFileContents();
+	PieceTable* getFileContents();
 
 	/// <summary>
 	/// Called when the editor needs access to the file name (for display purposes)
@@ -62,27 +138,363 @@ public:
 	const std::string_view fileName();
 
 	/// <summary>
-	/// Saves the current contents to the file
-	/// Called when a save or save/quit command is used.
+	/// Whether a large file is still being indexed in the background
 	/// </summary>
-	void saveFile();
+	/// <returns></returns>
+	const bool isIndexing() const;
+
+	/// <summary>
+	/// How much of the file has been indexed, as a percentage. Only updated by syncIndex()
+	/// </summary>
+	/// <returns></returns>
+	const uint8_t indexProgress() const;
+
+	/// <summary>
+	/// Whether the last background indexing read its line breaks from a LineIndexCache. Only updated by syncIndex()
+	/// </summary>
+	/// <returns></returns>
+	const bool indexedFromCache() const;
+
+	/// <summary>
+	/// Moves any line breaks found in the background into the document, without waiting for more
+	/// </summary>
+	void syncIndex();
+
+	/// <summary>
+	/// Waits until the document has at least rowCount rows, or the whole file has been indexed.
+	/// Used when jumping to part of the file that hasn't been indexed yet
+	/// </summary>
+	/// <param name="rowCount"></param>
+	void waitForRows(const size_t rowCount);
+
+	/// <summary>
+	/// Waits until the whole file has been indexed. Needed before the document is edited, searched, or saved
+	/// </summary>
+	void waitForIndex();
+
+	/// <summary>
+	/// Whether the file was opened in view or follow mode, where it can't be edited or saved
+	/// </summary>
+	/// <returns></returns>
+	const bool isViewOnly() const;
+
+	/// <summary>
+	/// Whether the file was opened in follow mode
+	/// </summary>
+	/// <returns></returns>
+	const bool isFollowing() const;
+
+	/// <summary>
+	/// What readAppended() did
+	/// </summary>
+	struct Appended
+	{
+		bool changed = false;
+		bool truncated = false; //The file got shorter (a log being rotated, for example), so the whole document was loaded again
+		size_t firstRow = 0; //The first row that changed. Rows before it are untouched
+		size_t newRows = 0;
+		bool ended = false; //Reading from a pipe, and the other program just closed it, so nothing more will be added
+	};
+
+	/// <summary>
+	/// In follow mode, adds the complete rows written to the end of the file since the last call to the end of the document.
+	/// Only the new bytes are read. A row that hasn't been finished yet is held back until its line break is written.
+	/// Reading from a pipe, adds whatever has arrived the same way. Does nothing otherwise, or while the file is still being indexed
+	/// </summary>
+	/// <returns></returns>
+	Appended readAppended();
+
+	/// <summary>
+	/// The size of the file as it was loaded, plus anything added to it in follow mode
+	/// </summary>
+	/// <returns></returns>
+	const uint64_t fileSize() const;
+
+	/// <summary>
+	/// The length of the longest row in the file as it was loaded. Only complete once indexing is done, and always 0 in view mode
+	/// </summary>
+	/// <returns></returns>
+	const size_t longestRow() const;
+
+	/// <summary>
+	/// The row in the file that the document's first row is. Always 0 outside of view mode
+	/// </summary>
+	/// <returns></returns>
+	const size_t firstRow() const;
+
+	/// <summary>
+	/// The number of rows in the file. In view mode, only the rows found so far until indexProgress() reaches 100
+	/// </summary>
+	/// <returns></returns>
+	const size_t lineCount() const;
+
+	/// <summary>
+	/// In view mode, moves the window of rows held in the document when the given document row gets close to either end of it.
+	/// Does nothing outside of view mode
+	/// </summary>
+	/// <param name="row"></param>
+	/// <returns> How many rows the window moved forward (negative if it moved back). Document rows need to be moved back by this much </returns>
+	const int64_t followRow(const size_t row);
+
+	/// <summary>
+	/// In view mode, moves the window of rows held in the document so it includes the given row of the file.
+	/// npos shows the last row, which means scanning the rest of the file
+	/// </summary>
+	/// <param name="fileRow"></param>
+	/// <returns> How many rows the window moved forward (negative if it moved back) </returns>
+	const int64_t showRow(size_t fileRow);
+
+	/// <summary>
+	/// How long the last save took, and how much it wrote
+	/// </summary>
+	struct SaveStats
+	{
+		size_t bytes = 0;
+		size_t bytesCopied = 0; //How many of the bytes were unchanged ranges copied straight from the original file
+		std::chrono::microseconds duration{ 0 };
+		uint64_t version = 0; //The version of the document that was written
+		std::string error; //Empty if the save worked
+
+		const double bytesPerSecond() const
+		{
+			return duration.count() > 0 ? bytes * 1'000'000.0 / duration.count() : 0.0;
+		}
+	};
+
+	/// <summary>
+	/// The state shared with the thread that writes a background save.
+	/// pieces is a snapshot of the document: the piece table never changes text it has already stored, so the views stay valid while editing carries on.
+	/// Pieces that lie in original, the mapped file, are ranges of the file that haven't changed since it was loaded
+	/// </summary>
+	struct SaveProgress
+	{
+		std::vector<std::string_view> pieces;
+		std::string_view original;
+		intptr_t originalFile = -1;
+		uint64_t journalPosition = 0; //Where the edit journal was up to when the snapshot was taken
+		std::filesystem::path target;
+		bool sync = false;
+		SaveStats stats;
+		std::atomic<bool> done = false;
+	};
+
+	/// <summary>
+	/// Saves the current contents to the file, and waits for it to be written.
+	/// The contents are written to a temporary file next to it, which is then renamed over the top so the file is never left half written
+	/// </summary>
+	/// <param name="sync"> Waits for the contents to reach the disk before renaming </param>
+	void saveFile(const bool sync = false);
+
+	/// <summary>
+	/// Takes a snapshot of the document and writes it on another thread, so editing can carry on while a large file is saved.
+	/// Waits for any save that is already running first. Called when a save command is used.
+	/// collectSave() picks up the result
+	/// </summary>
+	/// <param name="sync"> Waits for the contents to reach the disk before renaming </param>
+	void saveFileInBackground(const bool sync = false);
+
+	/// <summary>
+	/// Whether a background save is still being written
+	/// </summary>
+	/// <returns></returns>
+	const bool isSaving() const;
+
+	/// <summary>
+	/// Finishes a background save if it is done writing, without waiting for it
+	/// </summary>
+	/// <returns> True if a save finished, meaning lastSave() holds its result </returns>
+	bool collectSave();
+
+	/// <summary>
+	/// Waits for a background save to finish
+	/// </summary>
+	/// <returns> True if there was a save to wait for, meaning lastSave() holds its result </returns>
+	bool waitForSave();
+
+	/// <summary>
+	/// How the last save went. Zeroed until something has been saved
+	/// </summary>
+	/// <returns></returns>
+	const SaveStats& lastSave() const;
+
+	/// <summary>
+	/// How many unsaved edits were recovered from a journal left behind by a session that didn't close normally
+	/// </summary>
+	/// <returns></returns>
+	const size_t recoveredEdits() const;
+
+	/// <summary>
+	/// Whether a journal left behind by a session that didn't close normally couldn't be replayed, because the file has changed since.
+	/// It is kept next to the file as <file>.mini-journal.stale
+	/// </summary>
+	/// <returns></returns>
+	const bool hasStaleJournal() const;
+
+	/// <summary>
+	/// The journal that unsaved edits are recorded in. nullptr in view mode
+	/// </summary>
+	/// <returns></returns>
+	EditJournal* journal();
+
+	/// <summary>
+	/// What reloadIfChanged() did.
+	/// After a partial reload, rows before firstRow are untouched, rows from oldEndRow on are unchanged but moved by rowDelta,
+	/// and the rows between were replaced
+	/// </summary>
+	struct Reload
+	{
+		bool changedOnDisk = false; //Another program changed the file
+		bool reloaded = false;
+		bool wholeFile = false; //Nothing from before can be kept, because the whole document was loaded again
+		size_t firstRow = 0, oldEndRow = 0;
+		int64_t rowDelta = 0, byteDelta = 0;
+		size_t lostBytes = 0; //How much of the original was gone when it was copied out of a file that was truncated under unsaved changes
+	};
+
+	/// <summary>
+	/// Checks whether another program has changed the file, and if so, loads the changes into the document.
+	/// Only the region between the unchanged start and end of the file is replaced, so the rest of the document keeps pointing at the same text.
+	/// If the file was written over in place rather than replaced, the mapped original already shows the new contents, so the whole file is loaded again.
+	/// If that happens under unsaved changes, the original is copied out of the mapping before a truncated file can be read past its end.
+	/// Never waits when nothing has changed
+	/// </summary>
+	/// <param name="hasUnsavedChanges"> If true, the document is left alone so the unsaved changes aren't lost </param>
+	/// <returns></returns>
+	Reload reloadIfChanged(const bool hasUnsavedChanges);
 
-private:
 	/// <summary>
-	/// Splits the file contents into rows for the editor to use
-	/// Called by loadFileContents()
+	/// Builds the line-break index for the whole file.
+	/// The file is split into chunks of about the same size that end on a line break, and a pool of threads indexes them.
+	/// Each chunk's line breaks are moved into lineBreaks as their own segment.
+	/// Called by loadFileContents(). Public so the scaling can be benchmarked
 	/// </summary>
-	/// <param name=""></param>
-	void loadRows(const size_t startPos, const size_t endPos, const std::string_view str, std::promise<std::vector<Row>>&& p);
+	/// <param name="fileStr"></param>
+	/// <param name="lineBreaks"></param>
+	/// <param name="threads"> How many threads to use, including the calling thread. 0 uses one per hardware thread </param>
+	/// <returns> True if the file has any "\r\n" line endings </returns>
+	static bool findLineBreaks(const std::string_view fileStr, LineIndex& lineBreaks, unsigned int threads = 0);
 
 	/// <summary>
-	/// Loads the file into a stringstream for loadRows to work with.
+	/// Reads a whole file into text, with "\r\n" line endings normalized the same way as in a loaded document.
+	/// Used for the document's own copy of a file, and for files inserted into the document
+	/// </summary>
+	/// <param name="path"></param>
+	/// <param name="text"></param>
+	/// <returns> How many bytes were read from the file, or -1 if it couldn't be opened </returns>
+	static int64_t readText(const std::filesystem::path& path, std::string& text);
+
+private:
+	/// <summary>
+	/// Maps the file into memory and hands the mapping to the document, so rows are read straight from the file until they are edited.
+	/// Large files only have their head indexed before this returns; a background thread indexes the rest.
+	/// Files that can't be mapped, or that need their "\r\n" line endings normalized, are read into memory instead.
 	/// Called on initialization
 	/// </summary>
 	void loadFileContents();
 
+	/// <summary>
+	/// Reads the file into memory, normalizing "\r\n" line endings, and hands it to the document
+	/// </summary>
+	void loadFileCopy();
+
+	/// <summary>
+	/// Updates mLongestRow with the rows that end at the given line breaks, which come after the ones measured so far
+	/// </summary>
+	/// <param name="lineBreaks"></param>
+	void measureRows(const std::vector<size_t>& lineBreaks);
+
+	/// <summary>
+	/// Measures the rows ending at each segment of lineBreaks in turn
+	/// </summary>
+	/// <param name="lineBreaks"></param>
+	void measureRows(const LineIndex& lineBreaks);
+
+	/// <summary>
+	/// Replaces the document with the rows of the file starting at firstRow. Only used in view mode
+	/// </summary>
+	/// <param name="firstRow"></param>
+	void loadViewWindow(const size_t firstRow);
+
+	/// <summary>
+	/// Sets up the edit journal, first replaying any journal left behind for the file. Called on initialization outside of view mode
+	/// </summary>
+	void startJournal();
+
+	/// <summary>
+	/// Called once a save has been written. Remembers what the file on disk now looks like, so the save isn't mistaken for another program's change,
+	/// and starts the journal again from the saved file, keeping only the edits made since the snapshot
+	/// </summary>
+	/// <param name="journalPosition"></param>
+	void recordSave(const uint64_t journalPosition);
+
+	/// <summary>
+	/// Used by readAppended() in follow mode. Reads what has been written to the end of the file onto mPartialRow
+	/// </summary>
+	/// <returns> False if there is nothing new to add. If the file got shorter it was loaded again, and appended says so </returns>
+	bool readFileEnd(Appended& appended);
+
+	/// <summary>
+	/// Used by readAppended() when reading from a pipe. Moves what the pipe's thread has read onto mPartialRow
+	/// </summary>
+	/// <returns> True once the pipe has been closed and everything read from it has been taken </returns>
+	bool takePiped();
+
+	/// <summary>
+	/// Replaces the part of the document that differs from the file on disk. Used by reloadIfChanged()
+	/// </summary>
+	/// <param name="current"> The file on disk </param>
+	/// <returns> False if the change couldn't be found this way, so the whole file needs loading again </returns>
+	bool reloadChangedRegion(const std::string_view current, Reload& reload);
+
+	/// <summary>
+	/// Waits for indexing to finish, then fills progress with a snapshot of the document and where to write it
+	/// </summary>
+	/// <param name="progress"></param>
+	/// <param name="sync"></param>
+	void prepareSave(SaveProgress& progress, const bool sync);
+
+	/// <summary>
+	/// Writes the snapshot in progress to a temporary file and renames it over the target, filling in progress.stats.
+	/// Only touches progress, so it can run on another thread
+	/// </summary>
+	/// <param name="progress"></param>
+	static void writeSave(SaveProgress& progress);
+
 private:
 	std::string mFileName;
 	std::filesystem::path mPath;
-	std::vector<Row> mRows;
+	PieceTable mDocument;
+
+	std::shared_ptr<IndexProgress> mIndexProgress; //Only set while indexing in the background
+	std::thread mIndexThread;
+	size_t mIndexedLength = 0;
+	bool mIndexedFromCache = false;
+	bool mUseIndexCache = true;
+
+	std::unique_ptr<PagedFile> mPagedFile; //Only set in view mode
+	size_t mFirstRow = 0;
+	bool mViewReachesEnd = false; //Whether the document holds the last row of the file
+	bool mViewOnly = false;
+	bool mFollowing = false;
+
+	uint64_t mLoadedBytes = 0; //How much of the file has been read. In follow mode, anything after this hasn't been seen yet
+	size_t mLongestRow = 0;
+	size_t mNextRowStart = 0; //Where the row after the last one measured starts
+	std::string mPartialRow; //Read from the end of the file in follow mode, but not in the document until its line break is written
+	std::ifstream mFollowStream;
+
+	std::shared_ptr<PipeProgress> mPipeProgress; //Only set when reading from a pipe
+	std::thread mPipeThread;
+	bool mPipeEnded = false;
+
+	std::unique_ptr<EditJournal> mJournal; //Kept on the heap so the document's pointer to it survives the file handler being moved
+	size_t mRecoveredEdits = 0;
+
+	FileWatcher mWatcher;
+	EditJournal::FileIdentity mDiskIdentity; //The file on disk as it was last loaded or saved
+	bool mDiskChangePending = false; //The watcher saw a change that couldn't be looked at yet
+
+	std::shared_ptr<SaveProgress> mSaveProgress; //Only set while saving in the background
+	std::thread mSaveThread;
+	SaveStats mLastSave;
 };
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LineIndexCache.hpp"
+
+#include <fstream>
+#include <cstring>
+
+LineIndexCache::LineIndexCache(std::filesystem::path cachePath, const EditJournal::FileIdentity identity) : mPath(std::move(cachePath)), mIdentity(identity)
+{}
+
+std::filesystem::path LineIndexCache::pathFor(const std::filesystem::path& filePath)
+{
+	std::filesystem::path cachePath = filePath;
+	cachePath += ".mini-index";
+	return cachePath;
+}
+
+bool LineIndexCache::open(const std::string_view file)
+{
+	if (!mMapping.open(mPath)) return false;
+	const std::string_view cache = mMapping.view();
+
+	Header header, expected;
+	if (cache.length() < sizeof(Header)) return false;
+	std::memcpy(&header, cache.data(), sizeof(Header));
+	const bool matches = std::memcmp(header.tag, expected.tag, sizeof(header.tag)) == 0 && header.version == version
+		&& header.fileSize == mIdentity.size && header.modified == mIdentity.modified && header.fileSize == file.length()
+		&& header.encodedLength == cache.length() - sizeof(Header)
+		&& (header.lineBreakCount == 0 || (header.lastLineBreak < file.length() && file[header.lastLineBreak] == '\n'));
+	if (!matches)
+	{
+		mMapping.close();
+		return false;
+	}
+
+	mEncoded = cache.substr(sizeof(Header));
+	mRemaining = header.lineBreakCount;
+	mFileSize = header.fileSize;
+	mNext = 0;
+	return true;
+}
+
+bool LineIndexCache::read(const size_t end, std::vector<size_t>& lineBreaks)
+{
+	size_t pos = 0;
+	while (mRemaining > 0)
+	{
+		//Each gap is stored low bits first, with the top bit of a byte set if another byte follows
+		uint64_t gap = 0;
+		size_t used = pos;
+		for (unsigned int shift = 0; ; shift += 7)
+		{
+			if (used == mEncoded.length() || shift > 63) return false;
+			const uint8_t byte = static_cast<uint8_t>(mEncoded[used++]);
+			gap |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) break;
+		}
+
+		const uint64_t lineBreak = mNext + gap;
+		if (lineBreak >= mFileSize || lineBreak < mNext) return false;
+		if (lineBreak >= end) break;
+		lineBreaks.push_back(lineBreak);
+		mNext = lineBreak + 1;
+		pos = used;
+		--mRemaining;
+	}
+	mEncoded.remove_prefix(pos);
+	if (mRemaining == 0 && !mEncoded.empty()) return false;
+	if (end >= mFileSize && mRemaining > 0) return false; //Every line break should have been read by the end of the file
+	return true;
+}
+
+void LineIndexCache::add(const std::vector<size_t>& lineBreaks)
+{
+	for (const size_t lineBreak : lineBreaks)
+	{
+		uint64_t gap = lineBreak - mNext;
+		while (gap >= 0x80)
+		{
+			mBuilt.push_back(static_cast<char>((gap & 0x7F) | 0x80));
+			gap >>= 7;
+		}
+		mBuilt.push_back(static_cast<char>(gap));
+		mNext = lineBreak + 1;
+	}
+	mBuiltCount += lineBreaks.size();
+}
+
+bool LineIndexCache::save(const std::filesystem::path& filePath)
+{
+	if (EditJournal::identify(filePath) != mIdentity) return false; //Changed while it was being indexed
+
+	Header header;
+	header.fileSize = mIdentity.size;
+	header.modified = mIdentity.modified;
+	header.lineBreakCount = mBuiltCount;
+	header.lastLineBreak = (mBuiltCount > 0) ? mNext - 1 : 0;
+	header.encodedLength = mBuilt.length();
+
+	//Written under another name first, so a cache cut short by a crash is never opened
+	std::filesystem::path tempPath = mPath;
+	tempPath += ".tmp";
+	std::ofstream cache(tempPath, std::ios::binary | std::ios::trunc);
+	if (!cache.is_open()) return false;
+	cache.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	cache.write(mBuilt.data(), mBuilt.length());
+	cache.close();
+
+	std::error_code ec;
+	if (!cache.good()) //close() failing sets failbit too
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	std::filesystem::rename(tempPath, mPath, ec);
+	if (!ec) return true;
+	std::filesystem::remove(tempPath, ec);
+	return false;
+}
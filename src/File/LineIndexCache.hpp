@@ -0,0 +1,115 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file LineIndexCache.hpp
+* @brief Saves the line breaks of a large file next to it, so reopening the file doesn't have to scan it again
+*
+* The cache starts with the size and modification time of the file it was made from, and is only used while those still match.
+* The line breaks are stored as the gaps between them, each written in as few bytes as it fits in (7 bits per byte),
+* so the cache is a fraction of the size of the index it holds. It is in the machine's byte order, since it is only ever read back where it was written
+*/
+#pragma once
+#include "EditJournal.hpp"
+#include "Utility/MappedFile/MappedFile.hpp"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+class LineIndexCache
+{
+public:
+	/// <param name="cachePath"></param>
+	/// <param name="identity"> The file the line breaks are read from or saved for </param>
+	LineIndexCache(std::filesystem::path cachePath, const EditJournal::FileIdentity identity);
+
+	/// <summary>
+	/// The cache's name for the given file
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <returns></returns>
+	static std::filesystem::path pathFor(const std::filesystem::path& filePath);
+
+	/// <summary>
+	/// Maps the cache and checks it was saved for this version of the file. Only the header is read
+	/// </summary>
+	/// <param name="file"> The contents of the file </param>
+	/// <returns> False if there is no cache, or it can't be used for the file </returns>
+	bool open(const std::string_view file);
+
+	/// <summary>
+	/// Reads the next line breaks from an open cache, up to (but not including) position end
+	/// </summary>
+	/// <param name="end"></param>
+	/// <param name="lineBreaks"> Added to </param>
+	/// <returns> False if the cache turns out to be damaged. The line breaks added before that are still right </returns>
+	bool read(const size_t end, std::vector<size_t>& lineBreaks);
+
+	/// <summary>
+	/// Adds line breaks to the cache being built. They have to come after every line break added so far
+	/// </summary>
+	/// <param name="lineBreaks"></param>
+	void add(const std::vector<size_t>& lineBreaks);
+
+	/// <summary>
+	/// Writes the line breaks that were added, replacing any cache already there. Nothing is written if the file has changed since
+	/// </summary>
+	/// <param name="filePath"> The file the line breaks are from </param>
+	/// <returns> False if the cache couldn't be written </returns>
+	bool save(const std::filesystem::path& filePath);
+
+	inline static constexpr uint32_t version = 1;
+
+private:
+	/// <summary>
+	/// Comes first in the cache file
+	/// </summary>
+	struct Header
+	{
+		char tag[8] = { 'm', 'i', 'n', 'i', 'i', 'd', 'x', '\0' };
+		uint32_t version = LineIndexCache::version;
+		uint32_t reserved = 0;
+		uint64_t fileSize = 0;
+		int64_t modified = 0;
+		uint64_t lineBreakCount = 0;
+		uint64_t lastLineBreak = 0;
+		uint64_t encodedLength = 0;
+	};
+
+private:
+	std::filesystem::path mPath;
+	EditJournal::FileIdentity mIdentity;
+
+	MappedFile mMapping; //Open while reading
+	std::string_view mEncoded; //The part of the cache that hasn't been read yet
+	size_t mRemaining = 0; //Line breaks that haven't been read yet
+	uint64_t mFileSize = 0;
+
+	std::string mBuilt; //Added to while building
+	size_t mBuiltCount = 0;
+	size_t mNext = 0; //Line breaks are stored relative to the position after the previous one
+};
@@ -0,0 +1,150 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "PagedFile.hpp"
+#include "Utility/LineScanner/LineScanner.hpp"
+
+#include <algorithm>
+#include <cstring> //memchr
+
+bool PagedFile::open(const std::filesystem::path& path)
+{
+	if (!mFile.open(path)) return false;
+
+	mCheckpoints.assign(1, 0);
+	mScannedLength = 0;
+	mLineBreaks = 0;
+	mLastCopiedRow = 0;
+	return true;
+}
+
+const size_t PagedFile::knownRows() const
+{
+	return mLineBreaks + 1;
+}
+
+const bool PagedFile::isScanned() const
+{
+	return mScannedLength == mFile.view().length();
+}
+
+const uint8_t PagedFile::scanProgress() const
+{
+	if (isScanned()) return 100;
+	return static_cast<uint8_t>(mScannedLength * 100 / mFile.view().length());
+}
+
+const size_t PagedFile::checkpointCount() const
+{
+	return mCheckpoints.size();
+}
+
+const size_t PagedFile::rowStart(const size_t row)
+{
+	const size_t checkpoint = row / checkpointInterval;
+	while (checkpoint >= mCheckpoints.size() && !isScanned())
+	{
+		scanChunk();
+	}
+	if (checkpoint >= mCheckpoints.size()) return std::string::npos;
+
+	//Walk forward from the checkpoint. This is at most checkpointInterval rows
+	const std::string_view text = mFile.view();
+	size_t pos = mCheckpoints[checkpoint];
+	for (size_t r = checkpoint * checkpointInterval; r < row; ++r)
+	{
+		const void* lineBreak = std::memchr(text.data() + pos, '\n', text.length() - pos);
+		if (lineBreak == nullptr) return std::string::npos;
+		pos = static_cast<const char*>(lineBreak) - text.data() + 1;
+	}
+	return pos;
+}
+
+void PagedFile::scanToEnd()
+{
+	while (!isScanned())
+	{
+		scanChunk();
+	}
+}
+
+size_t PagedFile::copyRows(const size_t firstRow, const size_t maxRows, const size_t maxBytes, const size_t maxRowLength, std::string& out)
+{
+	out.clear();
+	const size_t start = rowStart(firstRow);
+	if (start == std::string::npos) return 0;
+
+	const std::string_view text = mFile.view();
+	size_t pos = start;
+	size_t rows = 0;
+	while (rows < maxRows && out.length() < maxBytes)
+	{
+		const void* lineBreak = std::memchr(text.data() + pos, '\n', text.length() - pos);
+		const size_t lineEnd = (lineBreak == nullptr) ? text.length() : static_cast<const char*>(lineBreak) - text.data();
+
+		size_t rowLength = lineEnd - pos;
+		if (rowLength > 0 && text[lineEnd - 1] == '\r') --rowLength;
+
+		if (rows > 0) out.push_back('\n');
+		out.append(text.substr(pos, std::min(rowLength, maxRowLength)));
+		++rows;
+
+		pos = lineEnd + 1;
+		if (lineBreak == nullptr) break;
+	}
+	const size_t end = std::min(pos, text.length());
+
+	//Keep the row count shown to the user ahead of the rows that were just copied
+	while (mScannedLength < end && !isScanned())
+	{
+		scanChunk();
+	}
+
+	//The rows now live in out, so the pages they came from can go. Walking to the first row, and the pages the OS maps in around
+	//each one that is touched, reach past the rows that were copied, so the whole mapping is dropped. The page cache keeps the pages, so this is cheap.
+	//Then start reading the next pages in the direction of the scroll
+	mFile.advise(0, text.length(), MappedFile::Advice::DontNeed);
+	if (firstRow >= mLastCopiedRow) mFile.advise(end, readAheadSize, MappedFile::Advice::WillNeed);
+	else if (start > 0) mFile.advise(start - std::min(start, readAheadSize), std::min(start, readAheadSize), MappedFile::Advice::WillNeed);
+	mLastCopiedRow = firstRow;
+
+	return rows;
+}
+
+void PagedFile::scanChunk()
+{
+	const std::string_view text = mFile.view();
+	const std::string_view chunk = text.substr(mScannedLength, scanChunkSize);
+
+	mChunkLineBreaks.clear();
+	LineScanner::findLineBreaks(chunk, mScannedLength, mChunkLineBreaks);
+	for (const size_t lineBreak : mChunkLineBreaks)
+	{
+		++mLineBreaks;
+		if (mLineBreaks % checkpointInterval == 0) mCheckpoints.push_back(lineBreak + 1);
+	}
+
+	mFile.advise(mScannedLength, chunk.length(), MappedFile::Advice::DontNeed);
+	mScannedLength += chunk.length();
+}
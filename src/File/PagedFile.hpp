@@ -0,0 +1,117 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file PagedFile.hpp
+* @brief Provides read-only access to the rows of a file too large to index in full
+*
+* Used by view mode. The file is mapped, and only the start of every checkpointInterval-th row is kept,
+* so the index stays small whatever the file size. Rows are copied out a page at a time, and the mapped pages that have been
+* read are handed back to the OS, so memory use doesn't grow as the file is scrolled through
+*/
+#pragma once
+#include "Utility/MappedFile/MappedFile.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class PagedFile
+{
+public:
+	/// <summary>
+	/// Maps the file. Nothing is scanned until rows are asked for
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns> False if the file couldn't be mapped </returns>
+	bool open(const std::filesystem::path& path);
+
+	/// <summary>
+	/// The number of rows found so far. Only the exact number of rows in the file once isScanned() is true
+	/// </summary>
+	/// <returns></returns>
+	const size_t knownRows() const;
+
+	/// <summary>
+	/// Whether the whole file has been scanned for line breaks
+	/// </summary>
+	/// <returns></returns>
+	const bool isScanned() const;
+
+	/// <summary>
+	/// How much of the file has been scanned, as a percentage
+	/// </summary>
+	/// <returns></returns>
+	const uint8_t scanProgress() const;
+
+	/// <summary>
+	/// The number of row starts kept in the sparse index
+	/// </summary>
+	/// <returns></returns>
+	const size_t checkpointCount() const;
+
+	/// <summary>
+	/// Finds where the given row starts, scanning further into the file if needed
+	/// </summary>
+	/// <param name="row"></param>
+	/// <returns> The offset of the row in the file, or npos if the file doesn't have that many rows </returns>
+	const size_t rowStart(const size_t row);
+
+	/// <summary>
+	/// Scans the rest of the file, so the number of rows is known
+	/// </summary>
+	void scanToEnd();
+
+	/// <summary>
+	/// Copies rows starting at firstRow into out, separated by '\n'. Stops after maxRows rows, once out is at least maxBytes long, or at the end of the file.
+	/// Rows longer than maxRowLength are cut off, and "\r\n" line endings are copied as '\n'.
+	/// The pages in the direction the file is being scrolled are read ahead of time
+	/// </summary>
+	/// <param name="firstRow"></param>
+	/// <param name="maxRows"></param>
+	/// <param name="maxBytes"></param>
+	/// <param name="maxRowLength"></param>
+	/// <param name="out"></param>
+	/// <returns> The number of rows copied </returns>
+	size_t copyRows(const size_t firstRow, const size_t maxRows, const size_t maxBytes, const size_t maxRowLength, std::string& out);
+
+	inline static constexpr size_t checkpointInterval = 1024; //Every checkpointInterval-th row start is kept in the index
+	inline static constexpr size_t scanChunkSize = 1024 * 1024; //How much of the file is scanned at once before its pages are dropped
+	inline static constexpr size_t readAheadSize = 4 * 1024 * 1024; //How much is read ahead of the rows that were just copied
+
+private:
+	/// <summary>
+	/// Scans the next chunk of the file for line breaks, keeping the row starts that land on a checkpoint
+	/// </summary>
+	void scanChunk();
+
+private:
+	MappedFile mFile;
+	std::vector<size_t> mCheckpoints; //mCheckpoints[i] is where row i * checkpointInterval starts
+	std::vector<size_t> mChunkLineBreaks; //Reused for every chunk that is scanned
+	size_t mScannedLength = 0;
+	size_t mLineBreaks = 0; //Line breaks found in [0, mScannedLength)
+	size_t mLastCopiedRow = 0; //Tells which way the file is being scrolled
+};
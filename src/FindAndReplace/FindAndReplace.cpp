@@ -25,13 +25,14 @@ SOFTWARE.
 
 namespace FindAndReplace
 {
-	std::vector<FindLocation> find(const std::string_view strToFind, const std::vector<FileHandler::Row>& fileRows)
+	std::vector<FindLocation> find(const std::string_view strToFind, const PieceTable& document)
 	{
 		std::vector<FindLocation> findLocations;
+		std::string line;
 
-		for (size_t i = 0; i < fileRows.size(); ++i)
+		for (size_t i = 0; i < document.lineCount(); ++i)
 		{
-			const std::string_view line = fileRows.at(i).line;
+			document.line(i, line);
 			size_t findPos;
 			size_t offset = 0;
 			while ((findPos = line.find(strToFind, offset)) != std::string_view::npos)
@@ -44,9 +45,9 @@ namespace FindAndReplace
 		return findLocations;
 	}
 
-	void replace(std::string& line, const std::string& insertStr, const FindLocation location)
+	void replace(PieceTable& document, const std::string& insertStr, const FindLocation location)
 	{
-		line.erase(location.startCol, location.length);
-		line.insert(location.startCol, insertStr);
+		document.erase(location.row, location.startCol, location.length);
+		document.insert(location.row, location.startCol, insertStr);
 	}
 }
\ No newline at end of file
@@ -23,7 +23,7 @@ SOFTWARE.
 */
 #pragma once
 
-#include "File/File.hpp"
+#include "PieceTable/PieceTable.hpp"
 
 #include <vector>
 #include <string_view>
@@ -44,15 +44,15 @@ namespace FindAndReplace
 	/// Currently this is a blocking call, so on large files this may cause performance issues
 	/// </summary>
 	/// <param name="strToFind"></param>
-	/// <param name="fileRows"></param>
+	/// <param name="document"></param>
 	/// <returns></returns>
-	std::vector<FindLocation> find(const std::string_view strToFind, const std::vector<FileHandler::Row>& fileRows);
+	std::vector<FindLocation> find(const std::string_view strToFind, const PieceTable& document);
 
 	/// <summary>
-	/// Replaces the find location in the given line with the new string
+	/// Replaces the find location in the document with the new string
 	/// </summary>
-	/// <param name="line"></param>
+	/// <param name="document"></param>
 	/// <param name="insertStr"></param>
 	/// <param name="location"></param>
-	void replace(std::string& line, const std::string& insertStr, const FindLocation location);
+	void replace(PieceTable& document, const std::string& insertStr, const FindLocation location);
 }
\ No newline at end of file
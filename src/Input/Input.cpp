@@ -264,11 +264,22 @@ namespace InputHandler
 		{
 			editor.save();
 		}
+		else if (command == "ws") //Save and wait for the file to reach the disk ([w]rite [s]ync)
+		{
+			editor.save(true);
+		}
 		else if (command == "wq" || command == "sq") //Save and quit commands ([w]rite [q]uit / [s]ave [q]uit)
 		{
 			editor.save();
-			editor.enableExitMode();
-			shouldExit = true;
+			if (!editor.isDirty()) //Waits for the save, and stays open if it failed
+			{
+				editor.enableExitMode();
+				shouldExit = true;
+			}
+		}
+		else if (command.starts_with("r ") && command.length() > 2) //Read a file into the document at the cursor ([r]ead <filename>)
+		{
+			editor.insertFile(std::string_view(command).substr(2));
 		}
 
 		editor.updateCommandBuffer(std::string());
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <cstdlib>
 #include <cstdint>
 #include <cstdio>
+#include <cerrno>
 
 using KeyActions::KeyAction;
 
@@ -40,10 +41,14 @@ namespace InputImpl
 	/// <returns></returns>
 	const KeyAction getInput()
 	{
-		int8_t nread;
 		char c;
-		while (nread = read(fileno(stdin), &c, 1) == 0); //While nothing is being read
-		if (nread == -1) exit(EXIT_FAILURE); //You've met with a terrible fate, haven't you
+		const ssize_t nread = read(fileno(stdin), &c, 1);
+		if (nread == 0) return KeyAction::None; //Nothing was typed before the read timed out. The screen still gets refreshed, in case a followed file grew
+		if (nread == -1)
+		{
+			if (errno == EINTR || errno == EAGAIN) return KeyAction::None;
+			exit(EXIT_FAILURE); //You've met with a terrible fate, haven't you
+		}
 
 		if (c == static_cast<char>(KeyAction::Esc))
 		{
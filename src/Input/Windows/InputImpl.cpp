@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include <conio.h>
 #include <cstdint>
+#include <thread>
+#include <chrono>
 
 using KeyActions::KeyAction;
 
@@ -34,6 +36,12 @@ namespace InputImpl
 {
 	const KeyActions::KeyAction getInput()
 	{
+		if (!_kbhit())
+		{
+			//Waits like read() does on Unix, so the screen still gets refreshed when nothing is typed, in case a followed file grew
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			if (!_kbhit()) return KeyAction::None;
+		}
 		uint8_t input = _getch();
 		static constexpr uint8_t specialKeyCode = 224;
 		static constexpr uint8_t functionKeyCode = 0;
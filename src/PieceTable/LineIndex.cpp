@@ -0,0 +1,96 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LineIndex.hpp"
+#include "Utility/LineScanner/LineScanner.hpp"
+
+#include <algorithm>
+
+LineIndex::LineIndex(std::vector<size_t> lineBreaks)
+{
+	append(std::move(lineBreaks));
+}
+
+void LineIndex::append(std::vector<size_t> lineBreaks)
+{
+	if (lineBreaks.empty()) return;
+
+	mSegmentStarts.push_back(mSize);
+	mSize += lineBreaks.size();
+	mSegments.push_back(std::move(lineBreaks));
+}
+
+bool LineIndex::scan(const std::string_view text, const size_t base)
+{
+	if (mSegments.empty())
+	{
+		mSegments.emplace_back();
+		mSegmentStarts.push_back(0);
+	}
+
+	std::vector<size_t>& lastSegment = mSegments.back();
+	const size_t oldSize = lastSegment.size();
+	const bool foundCarriageReturn = LineScanner::findLineBreaks(text, base, lastSegment);
+	mSize += lastSegment.size() - oldSize;
+
+	if (lastSegment.empty()) //Keep the no-empty-segments rule
+	{
+		mSegments.pop_back();
+		mSegmentStarts.pop_back();
+	}
+	return foundCarriageReturn;
+}
+
+const size_t LineIndex::size() const
+{
+	return mSize;
+}
+
+const size_t LineIndex::operator[](const size_t i) const
+{
+	if (mSegments.size() == 1) return mSegments.front()[i];
+
+	const size_t segment = (std::upper_bound(mSegmentStarts.begin(), mSegmentStarts.end(), i) - mSegmentStarts.begin()) - 1;
+	return mSegments[segment][i - mSegmentStarts[segment]];
+}
+
+const size_t LineIndex::lowerBound(const size_t pos) const
+{
+	//The first segment that has a line break at or after pos
+	const auto segment = std::partition_point(mSegments.begin(), mSegments.end(), [pos](const std::vector<size_t>& lineBreaks) { return lineBreaks.back() < pos; });
+	if (segment == mSegments.end()) return mSize;
+
+	const size_t segmentIndex = segment - mSegments.begin();
+	return mSegmentStarts[segmentIndex] + (std::lower_bound(segment->begin(), segment->end(), pos) - segment->begin());
+}
+
+const size_t LineIndex::segmentCount() const
+{
+	return mSegments.size();
+}
+
+const std::vector<size_t>& LineIndex::segment(const size_t i) const
+{
+	return mSegments[i];
+}
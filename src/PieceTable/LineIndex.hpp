@@ -0,0 +1,99 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file LineIndex.hpp
+* @brief Provides the line-break index the piece table keeps for each of its buffers
+*
+* The index is made of segments, each a sorted run of line-break positions that comes after the one before it.
+* Chunks indexed on different threads, or in the background, are moved in as their own segment instead of being copied into one big array
+*/
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+class LineIndex
+{
+public:
+	LineIndex() = default;
+
+	/// <summary>
+	/// Creates an index with a single segment
+	/// </summary>
+	/// <param name="lineBreaks"></param>
+	LineIndex(std::vector<size_t> lineBreaks);
+
+	/// <summary>
+	/// Moves a segment onto the end of the index. Every position in it must come after the positions already in the index
+	/// </summary>
+	/// <param name="lineBreaks"></param>
+	void append(std::vector<size_t> lineBreaks);
+
+	/// <summary>
+	/// Finds the line breaks in text, which starts at position base, and adds them to the end of the index
+	/// </summary>
+	/// <param name="text"></param>
+	/// <param name="base"></param>
+	/// <returns> True if text contains a "\r\n" line ending </returns>
+	bool scan(const std::string_view text, const size_t base);
+
+	/// <summary>
+	/// The number of line breaks in the index
+	/// </summary>
+	/// <returns></returns>
+	const size_t size() const;
+
+	/// <summary>
+	/// The position of the i-th line break
+	/// </summary>
+	/// <param name="i"></param>
+	/// <returns></returns>
+	const size_t operator[](const size_t i) const;
+
+	/// <summary>
+	/// The number of line breaks before position pos
+	/// </summary>
+	/// <param name="pos"></param>
+	/// <returns></returns>
+	const size_t lowerBound(const size_t pos) const;
+
+	/// <summary>
+	/// The number of segments the index is made of
+	/// </summary>
+	/// <returns></returns>
+	const size_t segmentCount() const;
+
+	/// <summary>
+	/// The line breaks in the i-th segment
+	/// </summary>
+	/// <param name="i"></param>
+	/// <returns></returns>
+	const std::vector<size_t>& segment(const size_t i) const;
+
+private:
+	std::vector<std::vector<size_t>> mSegments; //Never holds an empty segment
+	std::vector<size_t> mSegmentStarts; //The number of line breaks before each segment
+	size_t mSize = 0;
+};
@@ -0,0 +1,599 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "PieceTable.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+PieceTable::PieceTable() {}
+
+PieceTable::PieceTable(std::string original) : mOriginal(std::move(original))
+{
+	mOriginalLineBreaks.scan(mOriginal, 0);
+	if (mOriginal.length() > 0)
+	{
+		mRoot = createNode(Piece{ Source::Original, 0, mOriginal.length() });
+		mHasLines = true;
+	}
+}
+
+PieceTable::PieceTable(std::string original, LineIndex lineBreaks) : mOriginal(std::move(original)), mOriginalLineBreaks(std::move(lineBreaks))
+{
+	if (mOriginal.length() > 0)
+	{
+		mRoot = createNode(Piece{ Source::Original, 0, mOriginal.length() });
+		mHasLines = true;
+	}
+}
+
+PieceTable::PieceTable(MappedFile original, LineIndex lineBreaks, const bool indexed) : mMappedOriginal(std::move(original)), 
+	mOriginalLineBreaks(std::move(lineBreaks)), mIndexed(indexed)
+{
+	if (mMappedOriginal.view().length() > 0)
+	{
+		mRoot = createNode(Piece{ Source::Original, 0, mMappedOriginal.view().length() });
+		mHasLines = true;
+	}
+}
+
+void PieceTable::appendOriginalLineBreaks(std::vector<size_t> lineBreaks, const bool indexed)
+{
+	if (mIndexed) throw std::logic_error("PieceTable: the document is already indexed");
+
+	//Nothing can be edited until indexing is done, so the root is still the only piece
+	const size_t newLineBreaks = lineBreaks.size();
+	mOriginalLineBreaks.append(std::move(lineBreaks));
+	if (mRoot != nullNode)
+	{
+		mNodes[mRoot].lineBreaks += newLineBreaks;
+		update(mRoot);
+	}
+	mIndexed = indexed;
+	mVersion = ++sLastVersion;
+}
+
+const bool PieceTable::isIndexed() const
+{
+	return mIndexed;
+}
+
+const bool PieceTable::isMapped() const
+{
+	return mMappedOriginal.isOpen();
+}
+
+const MappedFile& PieceTable::mappedOriginal() const
+{
+	return mMappedOriginal;
+}
+
+const size_t PieceTable::detachMapping()
+{
+	if (!mMappedOriginal.isOpen()) return 0;
+
+	//Reading past the end of a truncated file would crash, so only what is still there is copied
+	const std::string_view mapped = mMappedOriginal.view();
+	const size_t readable = mMappedOriginal.fileLength();
+	mOriginal.assign(mapped.substr(0, readable));
+	if (readable < mapped.length())
+	{
+		mOriginal.resize(mapped.length(), ' ');
+		for (size_t i = mOriginalLineBreaks.lowerBound(readable); i < mOriginalLineBreaks.size(); ++i) mOriginal[mOriginalLineBreaks[i]] = '\n';
+	}
+	mMappedOriginal.close();
+	return mapped.length() - readable;
+}
+
+const size_t PieceTable::length() const
+{
+	return subtreeLength(mRoot);
+}
+
+const size_t PieceTable::lineCount() const
+{
+	if (!mHasLines) return 0;
+	return subtreeLineBreaks(mRoot) + (mIndexed ? 1 : 0); //The row after the last known line break isn't complete until indexing is done
+}
+
+const size_t PieceTable::pieceCount() const
+{
+	return mNodes.size() - mFreeNodes.size();
+}
+
+std::string PieceTable::line(const size_t row) const
+{
+	std::string out;
+	line(row, out);
+	return out;
+}
+
+void PieceTable::line(const size_t row, std::string& out) const
+{
+	out.clear();
+	appendRange(lineStart(row), lineEnd(row), out);
+}
+
+std::string PieceTable::line(const size_t row, const size_t col, const size_t count) const
+{
+	std::string out;
+	line(row, col, count, out);
+	return out;
+}
+
+void PieceTable::line(const size_t row, const size_t col, const size_t count, std::string& out) const
+{
+	out.clear();
+	const size_t start = lineStart(row);
+	const size_t end = lineEnd(row);
+	if (start + col > end) throw std::out_of_range("PieceTable: column is past the end of the row");
+	appendRange(start + col, start + col + std::min(count, end - start - col), out);
+}
+
+const size_t PieceTable::lineLength(const size_t row) const
+{
+	return lineEnd(row) - lineStart(row);
+}
+
+const char PieceTable::at(const size_t row, const size_t col) const
+{
+	const size_t start = lineStart(row);
+	if (start + col >= lineEnd(row)) return '\0';
+
+	size_t pos = start + col;
+	uint32_t node = mRoot;
+	while (node != nullNode)
+	{
+		const Node& n = mNodes[node];
+		const size_t leftLength = subtreeLength(n.left);
+		if (pos < leftLength)
+		{
+			node = n.left;
+		}
+		else if (pos < leftLength + n.piece.length)
+		{
+			return pieceText(n.piece)[pos - leftLength];
+		}
+		else
+		{
+			pos -= leftLength + n.piece.length;
+			node = n.right;
+		}
+	}
+	return '\0';
+}
+
+void PieceTable::insert(const size_t row, const size_t col, const std::string_view text)
+{
+	if (!mIndexed) throw std::logic_error("PieceTable: the document can't be edited until it is indexed");
+	if (text.empty()) return;
+	insertAt(offset(row, col), text);
+	mHasLines = true;
+	if (mEditListener != nullptr) mEditListener->inserted(row, col, text);
+}
+
+void PieceTable::erase(const size_t row, const size_t col, const size_t count)
+{
+	if (!mIndexed) throw std::logic_error("PieceTable: the document can't be edited until it is indexed");
+	if (count == 0) return;
+	eraseAt(offset(row, col), count);
+	if (mEditListener != nullptr) mEditListener->erased(row, col, count);
+}
+
+void PieceTable::pushBackLine()
+{
+	if (!mIndexed) throw std::logic_error("PieceTable: the document can't be edited until it is indexed");
+	if (!mHasLines)
+	{
+		mHasLines = true;
+		mVersion = ++sLastVersion;
+		return;
+	}
+	const size_t lastRow = lineCount() - 1;
+	const size_t lastRowLength = lineLength(lastRow);
+	insertAt(length(), "\n");
+	if (mEditListener != nullptr) mEditListener->inserted(lastRow, lastRowLength, "\n");
+}
+
+std::string PieceTable::text() const
+{
+	std::string out;
+	out.reserve(length());
+	appendRange(0, length(), out);
+	return out;
+}
+
+const size_t PieceTable::offset(const size_t row, const size_t col) const
+{
+	const size_t start = lineStart(row);
+	if (start + col > lineEnd(row)) throw std::out_of_range("PieceTable: column is past the end of the row");
+	return start + col;
+}
+
+const size_t PieceTable::lineStart(const size_t row) const
+{
+	if (row == 0) return 0;
+	if (row > subtreeLineBreaks(mRoot)) throw std::out_of_range("PieceTable: row is past the end of the document");
+
+	//The start of a row is one character after the row-th line break
+	size_t breaksLeft = row;
+	size_t pos = 0;
+	uint32_t node = mRoot;
+	while (node != nullNode)
+	{
+		const Node& n = mNodes[node];
+		const size_t leftBreaks = subtreeLineBreaks(n.left);
+		if (breaksLeft <= leftBreaks)
+		{
+			node = n.left;
+			continue;
+		}
+
+		breaksLeft -= leftBreaks;
+		pos += subtreeLength(n.left);
+		if (breaksLeft <= n.lineBreaks) //The line break we're looking for is inside this piece
+		{
+			const LineIndex& lineBreaks = (n.piece.source == Source::Original) ? mOriginalLineBreaks : mAddLineBreaks;
+			const size_t firstBreak = lineBreaks.lowerBound(n.piece.start);
+			return pos + (lineBreaks[firstBreak + breaksLeft - 1] - n.piece.start) + 1;
+		}
+		breaksLeft -= n.lineBreaks;
+		pos += n.piece.length;
+		node = n.right;
+	}
+	return length();
+}
+
+const size_t PieceTable::lineEnd(const size_t row) const
+{
+	const size_t lineBreaks = subtreeLineBreaks(mRoot);
+	if (row > lineBreaks || (row == lineBreaks && !mIndexed)) throw std::out_of_range("PieceTable: row is past the end of the document");
+	if (row == lineBreaks) return length(); //The last row runs to the end of the document
+	return lineStart(row + 1) - 1;
+}
+
+void PieceTable::insertAt(const size_t pos, const std::string_view text)
+{
+	const size_t slabsBefore = mAdd.slabCount();
+	const size_t addStart = mAdd.append(text);
+	mStats.slabAllocations += mAdd.slabCount() - slabsBefore;
+	mAddLineBreaks.scan(text, addStart);
+	mVersion = ++sLastVersion;
+
+	if (!extendPiece(mRoot, pos, addStart, text.length()))
+	{
+		uint32_t left, right;
+		split(mRoot, pos, left, right);
+		const uint32_t node = createNode(Piece{ Source::Add, addStart, text.length() });
+		mRoot = merge(merge(left, node), right);
+	}
+	compactIfNeeded();
+}
+
+void PieceTable::eraseAt(const size_t pos, const size_t count)
+{
+	uint32_t left, middle, right;
+	split(mRoot, pos, left, right);
+	split(right, count, middle, right);
+	freeTree(middle);
+	mRoot = merge(left, right);
+	mVersion = ++sLastVersion;
+	compactIfNeeded();
+}
+
+void PieceTable::setEditListener(EditListener* listener)
+{
+	mEditListener = listener;
+}
+
+void PieceTable::pieceViews(std::vector<std::string_view>& out) const
+{
+	std::vector<Piece> pieces;
+	pieces.reserve(pieceCount());
+	collectPieces(mRoot, pieces);
+
+	out.reserve(out.size() + pieces.size());
+	for (const Piece& piece : pieces)
+	{
+		out.push_back(pieceText(piece));
+	}
+}
+
+const uint64_t PieceTable::version() const
+{
+	return mVersion;
+}
+
+const PieceTable::Stats PieceTable::stats() const
+{
+	return mStats;
+}
+
+void PieceTable::compact()
+{
+	std::vector<Piece> pieces;
+	pieces.reserve(pieceCount());
+	collectPieces(mRoot, pieces);
+
+	std::vector<Piece> compacted;
+	compacted.reserve(pieces.size());
+	std::string smallPieces; //A run of small pieces, copied together into a single new piece
+
+	size_t runStart = 0;
+	for (size_t i = 0; i <= pieces.size(); ++i)
+	{
+		const bool isSmall = (i < pieces.size() && pieces[i].length < smallPieceLength);
+		if (isSmall) continue;
+
+		//pieces[runStart, i) are small. A run of two or more is copied into one new piece
+		if (i - runStart > 1)
+		{
+			smallPieces.clear();
+			for (size_t j = runStart; j < i; ++j) smallPieces.append(pieceText(pieces[j]));
+
+			const size_t slabsBefore = mAdd.slabCount();
+			const size_t addStart = mAdd.append(smallPieces);
+			mStats.slabAllocations += mAdd.slabCount() - slabsBefore;
+			mAddLineBreaks.scan(smallPieces, addStart);
+			compacted.push_back(Piece{ Source::Add, addStart, smallPieces.length() });
+		}
+		else if (i - runStart == 1)
+		{
+			compacted.push_back(pieces[runStart]);
+		}
+
+		if (i < pieces.size())
+		{
+			const Piece& piece = pieces[i];
+			Piece* previous = compacted.empty() ? nullptr : &compacted.back();
+			if (previous != nullptr && previous->source == piece.source && previous->start + previous->length == piece.start)
+			{
+				previous->length += piece.length; //Already next to each other in the same buffer, so no copy is needed
+			}
+			else
+			{
+				compacted.push_back(piece);
+			}
+		}
+		runStart = i + 1;
+	}
+
+	freeTree(mRoot);
+	mRoot = nullNode;
+	for (const Piece& piece : compacted)
+	{
+		mRoot = merge(mRoot, createNode(piece));
+	}
+
+	++mStats.compactions;
+	mEditsSinceCompaction = 0;
+}
+
+void PieceTable::compactIfNeeded()
+{
+	if (++mEditsSinceCompaction < compactionInterval) return;
+	if (pieceCount() < compactionMinPieces)
+	{
+		mEditsSinceCompaction = 0;
+		return;
+	}
+	compact();
+}
+
+void PieceTable::collectPieces(const uint32_t node, std::vector<Piece>& pieces) const
+{
+	if (node == nullNode) return;
+	collectPieces(mNodes[node].left, pieces);
+	pieces.push_back(mNodes[node].piece);
+	collectPieces(mNodes[node].right, pieces);
+}
+
+void PieceTable::appendRange(const size_t from, const size_t to, std::string& out) const
+{
+	appendRange(mRoot, 0, from, to, out);
+}
+
+void PieceTable::appendRange(const uint32_t node, const size_t nodeStart, const size_t from, const size_t to, std::string& out) const
+{
+	if (node == nullNode || from >= to) return;
+
+	const Node& n = mNodes[node];
+	const size_t pieceStart = nodeStart + subtreeLength(n.left);
+	const size_t pieceEnd = pieceStart + n.piece.length;
+
+	if (from < pieceStart)
+	{
+		appendRange(n.left, nodeStart, from, std::min(to, pieceStart), out);
+	}
+	if (from < pieceEnd && to > pieceStart)
+	{
+		const size_t start = std::max(from, pieceStart) - pieceStart;
+		const size_t end = std::min(to, pieceEnd) - pieceStart;
+		out.append(pieceText(n.piece).substr(start, end - start));
+	}
+	if (to > pieceEnd)
+	{
+		appendRange(n.right, pieceEnd, std::max(from, pieceEnd), to, out);
+	}
+}
+
+const std::string_view PieceTable::pieceText(const Piece& piece) const
+{
+	if (piece.source == Source::Add) return mAdd.view(piece.start, piece.length);
+
+	const std::string_view original = mMappedOriginal.isOpen() ? mMappedOriginal.view() : std::string_view(mOriginal);
+	return original.substr(piece.start, piece.length);
+}
+
+const size_t PieceTable::countLineBreaks(const Piece& piece) const
+{
+	const LineIndex& lineBreaks = (piece.source == Source::Original) ? mOriginalLineBreaks : mAddLineBreaks;
+	return lineBreaks.lowerBound(piece.start + piece.length) - lineBreaks.lowerBound(piece.start);
+}
+
+uint32_t PieceTable::createNode(const Piece& piece)
+{
+	uint32_t node;
+	if (!mFreeNodes.empty())
+	{
+		node = mFreeNodes.back();
+		mFreeNodes.pop_back();
+		mNodes[node] = Node();
+	}
+	else
+	{
+		if (mNodes.size() == mNodes.capacity()) ++mStats.nodePoolAllocations;
+		node = static_cast<uint32_t>(mNodes.size());
+		mNodes.emplace_back();
+	}
+
+	Node& n = mNodes[node];
+	n.piece = piece;
+	n.lineBreaks = countLineBreaks(piece);
+	n.priority = static_cast<uint32_t>(mRandom());
+	update(node);
+	return node;
+}
+
+void PieceTable::freeTree(const uint32_t node)
+{
+	if (node == nullNode) return;
+	freeTree(mNodes[node].left);
+	freeTree(mNodes[node].right);
+	mFreeNodes.push_back(node);
+}
+
+void PieceTable::update(const uint32_t node)
+{
+	Node& n = mNodes[node];
+	n.subtreeLength = subtreeLength(n.left) + n.piece.length + subtreeLength(n.right);
+	n.subtreeLineBreaks = subtreeLineBreaks(n.left) + n.lineBreaks + subtreeLineBreaks(n.right);
+}
+
+void PieceTable::split(const uint32_t node, const size_t pos, uint32_t& left, uint32_t& right)
+{
+	if (node == nullNode)
+	{
+		left = right = nullNode;
+		return;
+	}
+
+	const size_t leftLength = subtreeLength(mNodes[node].left);
+	const size_t pieceLength = mNodes[node].piece.length;
+	if (pos <= leftLength)
+	{
+		uint32_t newLeft;
+		split(mNodes[node].left, pos, left, newLeft);
+		mNodes[node].left = newLeft;
+		update(node);
+		right = node;
+	}
+	else if (pos >= leftLength + pieceLength)
+	{
+		uint32_t newRight;
+		split(mNodes[node].right, pos - leftLength - pieceLength, newRight, right);
+		mNodes[node].right = newRight;
+		update(node);
+		left = node;
+	}
+	else //The split position is inside this piece, so cut it in two
+	{
+		const size_t cut = pos - leftLength;
+		const Piece& piece = mNodes[node].piece;
+		const uint32_t tail = createNode(Piece{ piece.source, piece.start + cut, piece.length - cut });
+
+		Node& n = mNodes[node]; //createNode may have reallocated mNodes
+		n.piece.length = cut;
+		n.lineBreaks = countLineBreaks(n.piece);
+		const uint32_t oldRight = n.right;
+		n.right = nullNode;
+		update(node);
+
+		left = node;
+		right = merge(tail, oldRight);
+	}
+}
+
+uint32_t PieceTable::merge(const uint32_t left, const uint32_t right)
+{
+	if (left == nullNode) return right;
+	if (right == nullNode) return left;
+
+	if (mNodes[left].priority > mNodes[right].priority)
+	{
+		const uint32_t newRight = merge(mNodes[left].right, right);
+		mNodes[left].right = newRight;
+		update(left);
+		return left;
+	}
+	else
+	{
+		const uint32_t newLeft = merge(left, mNodes[right].left);
+		mNodes[right].left = newLeft;
+		update(right);
+		return right;
+	}
+}
+
+bool PieceTable::extendPiece(const uint32_t node, const size_t pos, const size_t addStart, const size_t length)
+{
+	if (node == nullNode) return false;
+
+	Node& n = mNodes[node];
+	const size_t leftLength = subtreeLength(n.left);
+	bool extended = false;
+	if (pos <= leftLength)
+	{
+		extended = extendPiece(n.left, pos, addStart, length);
+	}
+	else if (pos < leftLength + n.piece.length) //pos is in the middle of this piece, so nothing ends there
+	{
+		return false;
+	}
+	else if (pos == leftLength + n.piece.length)
+	{
+		if (n.piece.source != Source::Add || n.piece.start + n.piece.length != addStart) return false;
+
+		n.piece.length += length;
+		n.lineBreaks = countLineBreaks(n.piece);
+		extended = true;
+	}
+	else
+	{
+		extended = extendPiece(n.right, pos - leftLength - n.piece.length, addStart, length);
+	}
+
+	if (extended) update(node);
+	return extended;
+}
+
+const size_t PieceTable::subtreeLength(const uint32_t node) const
+{
+	return (node == nullNode) ? 0 : mNodes[node].subtreeLength;
+}
+
+const size_t PieceTable::subtreeLineBreaks(const uint32_t node) const
+{
+	return (node == nullNode) ? 0 : mNodes[node].subtreeLineBreaks;
+}
@@ -0,0 +1,433 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file PieceTable.hpp
+* @brief Provides the interface for the document store the editor works on
+*
+* The document is never stored as a list of rows. Instead, the text lives in two buffers:
+* the original buffer (read-only, filled once when the file is loaded) and an append buffer (every inserted character).
+* A balanced tree of pieces describes which parts of those buffers make up the document, in order.
+* Each buffer has a line-break index, so finding a row and editing the document are O(log n)
+*/
+#pragma once
+#include "LineIndex.hpp"
+#include "SlabArena.hpp"
+#include "Utility/MappedFile/MappedFile.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <cstdint>
+
+class PieceTable
+{
+public:
+	/// <summary>
+	/// Told about each edit made through insert(), erase() and pushBackLine(), straight after it is made.
+	/// Replaying the same calls on the document as it was loaded gives back the edited document
+	/// </summary>
+	class EditListener
+	{
+	public:
+		virtual ~EditListener() = default;
+		virtual void inserted(const size_t row, const size_t col, const std::string_view text) = 0;
+		virtual void erased(const size_t row, const size_t col, const size_t count) = 0;
+	};
+
+	/// <summary>
+	/// Creates an empty document with no rows
+	/// </summary>
+	PieceTable();
+
+	/// <summary>
+	/// Creates a document from the given text, building the line-break index from scratch
+	/// </summary>
+	/// <param name="original"></param>
+	PieceTable(std::string original);
+
+	/// <summary>
+	/// Creates a document from the given text and an already built line-break index.
+	/// lineBreaks must hold the position of every '\n' in original, in ascending order
+	/// </summary>
+	/// <param name="original"></param>
+	/// <param name="lineBreaks"></param>
+	PieceTable(std::string original, LineIndex lineBreaks);
+
+	/// <summary>
+	/// Creates a document that reads straight out of a mapped file instead of a copy of it.
+	/// The mapping is never written to; edited text goes to the append buffer like always.
+	/// lineBreaks must hold the position of every '\n' in the mapping, in ascending order.
+	/// If indexed is false, lineBreaks only covers the start of the mapping, and the rest gets added with appendOriginalLineBreaks()
+	/// </summary>
+	/// <param name="original"></param>
+	/// <param name="lineBreaks"></param>
+	/// <param name="indexed"></param>
+	PieceTable(MappedFile original, LineIndex lineBreaks, const bool indexed = true);
+
+	/// <summary>
+	/// Moves the next line breaks found in the original buffer onto its index while it is still being indexed.
+	/// Pass indexed = true with the last of them
+	/// </summary>
+	/// <param name="lineBreaks"></param>
+	/// <param name="indexed"></param>
+	void appendOriginalLineBreaks(std::vector<size_t> lineBreaks, const bool indexed);
+
+	/// <summary>
+	/// Whether every line break in the original buffer is known. Until it is, only the rows that end in a known line break
+	/// are available, and the document can't be edited
+	/// </summary>
+	/// <returns></returns>
+	const bool isIndexed() const;
+
+	/// <summary>
+	/// Whether the original buffer is a mapped file
+	/// </summary>
+	/// <returns></returns>
+	const bool isMapped() const;
+
+	/// <summary>
+	/// The mapping the original buffer reads from. Closed unless isMapped()
+	/// </summary>
+	/// <returns></returns>
+	const MappedFile& mappedOriginal() const;
+
+	/// <summary>
+	/// Copies the mapped file into memory and unmaps it, so the file on disk can be replaced. Does nothing if the document isn't mapped.
+	/// If the file has been truncated, the part of it that is gone is filled with spaces, keeping its line breaks where they were
+	/// </summary>
+	/// <returns> How many bytes of the original were gone from the file </returns>
+	const size_t detachMapping();
+
+	/// <summary>
+	/// The number of characters in the document, including the '\n' characters between rows
+	/// </summary>
+	/// <returns></returns>
+	const size_t length() const;
+
+	/// <summary>
+	/// The number of rows in the document. An empty file has no rows until one is added.
+	/// While the document is still being indexed, this is the number of rows found so far
+	/// </summary>
+	/// <returns></returns>
+	const size_t lineCount() const;
+
+	/// <summary>
+	/// The number of pieces the document is currently made of. Mostly useful for testing and benchmarking
+	/// </summary>
+	/// <returns></returns>
+	const size_t pieceCount() const;
+
+	/// <summary>
+	/// Returns a copy of the given row, without the trailing '\n'
+	/// </summary>
+	/// <param name="row"></param>
+	/// <returns></returns>
+	std::string line(const size_t row) const;
+
+	/// <summary>
+	/// Copies the given row into out, re-using its storage. Used when many rows need to be read in a row
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="out"></param>
+	void line(const size_t row, std::string& out) const;
+
+	/// <summary>
+	/// Returns part of the given row, starting at col and clamped to the end of the row like std::string::substr.
+	/// Only the requested part is copied, so this stays cheap on very long rows
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="count"></param>
+	/// <returns></returns>
+	std::string line(const size_t row, const size_t col, const size_t count) const;
+
+	/// <summary>
+	/// Copies part of the given row into out, re-using its storage
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="count"></param>
+	/// <param name="out"></param>
+	void line(const size_t row, const size_t col, const size_t count, std::string& out) const;
+
+	/// <summary>
+	/// The length of the given row, without the trailing '\n'
+	/// </summary>
+	/// <param name="row"></param>
+	/// <returns></returns>
+	const size_t lineLength(const size_t row) const;
+
+	/// <summary>
+	/// Returns the character at the given row and column, or '\0' if the column is at/past the end of the row
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <returns></returns>
+	const char at(const size_t row, const size_t col) const;
+
+	/// <summary>
+	/// Inserts text (which may contain '\n') at the given row and column
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="text"></param>
+	void insert(const size_t row, const size_t col, const std::string_view text);
+
+	/// <summary>
+	/// Erases count characters starting at the given row and column. Erasing a '\n' joins two rows
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="count"></param>
+	void erase(const size_t row, const size_t col, const size_t count);
+
+	/// <summary>
+	/// Adds an empty row to the end of the document
+	/// </summary>
+	void pushBackLine();
+
+	/// <summary>
+	/// Builds the whole document as a single string
+	/// </summary>
+	/// <returns></returns>
+	std::string text() const;
+
+	/// <summary>
+	/// Appends a view of each piece's text to out, in document order, so the document can be written out without copying it.
+	/// The views are only valid until the document is changed
+	/// </summary>
+	/// <param name="out"></param>
+	void pieceViews(std::vector<std::string_view>& out) const;
+
+	/// <summary>
+	/// Identifies the document's current contents. Changes whenever the text or the indexed rows change, and is never shared between two documents,
+	/// so anything cached from the document can tell when it is out of date
+	/// </summary>
+	/// <returns></returns>
+	const uint64_t version() const;
+
+	/// <summary>
+	/// Counters for the allocations the document makes, and how often it has been compacted
+	/// </summary>
+	struct Stats
+	{
+		size_t slabAllocations = 0; //Slabs allocated for the append buffer
+		size_t nodePoolAllocations = 0; //Times the node pool had to grow
+		size_t compactions = 0;
+	};
+
+	/// <summary>
+	/// Returns the document's allocation and compaction counters
+	/// </summary>
+	/// <returns></returns>
+	const Stats stats() const;
+
+	/// <summary>
+	/// Rebuilds the piece tree with as few pieces as possible.
+	/// Pieces that already sit next to each other in the same buffer are joined, and runs of small pieces (left behind by scattered edits)
+	/// are copied into a single new piece. Called automatically every compactionInterval edits
+	/// </summary>
+	void compact();
+
+	/// <summary>
+	/// Sets the listener told about each edit, or clears it with nullptr. The listener has to outlive the document or be cleared first
+	/// </summary>
+	/// <param name="listener"></param>
+	void setEditListener(EditListener* listener);
+
+private:
+	/// <summary>
+	/// Which buffer a piece points into
+	/// </summary>
+	enum class Source : uint8_t
+	{
+		Original,
+		Add
+	};
+
+	/// <summary>
+	/// A span of one of the buffers
+	/// </summary>
+	struct Piece
+	{
+		Source source = Source::Original;
+		size_t start = 0, length = 0;
+	};
+
+	/// <summary>
+	/// A node in the piece tree. Nodes are stored in mNodes and refer to each other by index.
+	/// The tree is ordered by document position and balanced by a random heap priority (a treap).
+	/// subtreeLength/subtreeLineBreaks are the totals for the node and everything beneath it
+	/// </summary>
+	struct Node
+	{
+		Piece piece;
+		size_t lineBreaks = 0;
+		size_t subtreeLength = 0, subtreeLineBreaks = 0;
+		uint32_t left = nullNode, right = nullNode;
+		uint32_t priority = 0;
+	};
+
+	/// <summary>
+	/// Converts a row and column into a position in the document
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <returns></returns>
+	const size_t offset(const size_t row, const size_t col) const;
+
+	/// <summary>
+	/// The position of the first character of the given row
+	/// </summary>
+	/// <param name="row"></param>
+	/// <returns></returns>
+	const size_t lineStart(const size_t row) const;
+
+	/// <summary>
+	/// The position one past the last character of the given row (the position of its '\n', if it has one)
+	/// </summary>
+	/// <param name="row"></param>
+	/// <returns></returns>
+	const size_t lineEnd(const size_t row) const;
+
+	/// <summary>
+	/// Inserts text at the given position in the document
+	/// </summary>
+	/// <param name="pos"></param>
+	/// <param name="text"></param>
+	void insertAt(const size_t pos, const std::string_view text);
+
+	/// <summary>
+	/// Erases count characters starting at the given position in the document
+	/// </summary>
+	/// <param name="pos"></param>
+	/// <param name="count"></param>
+	void eraseAt(const size_t pos, const size_t count);
+
+	/// <summary>
+	/// Appends the characters in [from, to) of the document to out
+	/// </summary>
+	/// <param name="from"></param>
+	/// <param name="to"></param>
+	/// <param name="out"></param>
+	void appendRange(const size_t from, const size_t to, std::string& out) const;
+
+	/// <summary>
+	/// Recursive helper for appendRange. nodeStart is the document position of the first character in the subtree
+	/// </summary>
+	void appendRange(const uint32_t node, const size_t nodeStart, const size_t from, const size_t to, std::string& out) const;
+
+	/// <summary>
+	/// Returns the text a piece points to
+	/// </summary>
+	/// <param name="piece"></param>
+	/// <returns></returns>
+	const std::string_view pieceText(const Piece& piece) const;
+
+	/// <summary>
+	/// Counts the '\n' characters in a piece using the buffer's line-break index
+	/// </summary>
+	/// <param name="piece"></param>
+	/// <returns></returns>
+	const size_t countLineBreaks(const Piece& piece) const;
+
+	/// <summary>
+	/// Creates a new node for the piece, re-using a freed node if possible
+	/// </summary>
+	/// <param name="piece"></param>
+	/// <returns></returns>
+	uint32_t createNode(const Piece& piece);
+
+	/// <summary>
+	/// Returns the node and everything beneath it to the free list
+	/// </summary>
+	/// <param name="node"></param>
+	void freeTree(const uint32_t node);
+
+	/// <summary>
+	/// Recalculates the subtree totals of a node from its children
+	/// </summary>
+	/// <param name="node"></param>
+	void update(const uint32_t node);
+
+	/// <summary>
+	/// Splits the tree into the first pos characters (left) and everything else (right).
+	/// A piece that straddles pos gets cut in two
+	/// </summary>
+	void split(const uint32_t node, const size_t pos, uint32_t& left, uint32_t& right);
+
+	/// <summary>
+	/// Joins two trees, where every character of left comes before every character of right
+	/// </summary>
+	uint32_t merge(const uint32_t left, const uint32_t right);
+
+	/// <summary>
+	/// If a piece ends at pos, and its text ends right where the new text was appended (addStart), grow it by length instead of adding a new piece.
+	/// This keeps normal typing from creating one piece per keystroke
+	/// </summary>
+	/// <returns> True if a piece was extended </returns>
+	bool extendPiece(const uint32_t node, const size_t pos, const size_t addStart, const size_t length);
+
+	/// <summary>
+	/// Compacts the document once enough edits have been made since the last compaction, and there are enough pieces for it to matter
+	/// </summary>
+	void compactIfNeeded();
+
+	/// <summary>
+	/// Appends the pieces in the subtree to pieces, in document order
+	/// </summary>
+	void collectPieces(const uint32_t node, std::vector<Piece>& pieces) const;
+
+	const size_t subtreeLength(const uint32_t node) const;
+	const size_t subtreeLineBreaks(const uint32_t node) const;
+
+private:
+	std::string mOriginal;
+	SlabArena mAdd;
+	MappedFile mMappedOriginal; //When open, used as the original buffer in place of mOriginal
+	LineIndex mOriginalLineBreaks, mAddLineBreaks; //Positions of each '\n' in the buffers
+
+	std::vector<Node> mNodes;
+	std::vector<uint32_t> mFreeNodes;
+	uint32_t mRoot = nullNode;
+	std::minstd_rand mRandom;
+
+	bool mHasLines = false; //Separates an empty file (no rows) from a file with one empty row
+	bool mIndexed = true; //False while the original buffer's line breaks are still being found
+
+	Stats mStats;
+	size_t mEditsSinceCompaction = 0;
+	uint64_t mVersion = ++sLastVersion;
+	EditListener* mEditListener = nullptr;
+
+	inline static std::atomic<uint64_t> sLastVersion = 0; //Shared by all documents so versions are never reused
+
+	inline static constexpr uint32_t nullNode = UINT32_MAX;
+	inline static constexpr size_t compactionInterval = 4096; //Edits between compaction checks
+	inline static constexpr size_t compactionMinPieces = 1024; //Fewer pieces than this aren't worth compacting
+	inline static constexpr size_t smallPieceLength = 64; //Runs of pieces shorter than this get copied together when compacting
+};
@@ -0,0 +1,68 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "SlabArena.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+size_t SlabArena::append(const std::string_view text)
+{
+	if (mSlabs.empty() || mSlabs.back().capacity - mSlabs.back().used < text.length())
+	{
+		Slab slab;
+		slab.base = mSlabs.empty() ? 0 : mSlabs.back().base + mSlabs.back().capacity + 1;
+		slab.capacity = std::max(slabSize, text.length());
+		slab.data = std::unique_ptr<char[]>(new char[slab.capacity]); //Left uninitialized, since it is about to be written over
+		mSlabs.push_back(std::move(slab));
+	}
+
+	Slab& slab = mSlabs.back();
+	const size_t pos = slab.base + slab.used;
+	std::memcpy(slab.data.get() + slab.used, text.data(), text.length());
+	slab.used += text.length();
+	mSize += text.length();
+	return pos;
+}
+
+const std::string_view SlabArena::view(const size_t pos, const size_t length) const
+{
+	//Most reads are of recent edits, so check the newest slab before searching
+	const Slab* slab = &mSlabs.back();
+	if (pos < slab->base)
+	{
+		slab = &*(std::upper_bound(mSlabs.begin(), mSlabs.end(), pos, [](const size_t p, const Slab& s) { return p < s.base; }) - 1);
+	}
+	return std::string_view(slab->data.get() + (pos - slab->base), length);
+}
+
+const size_t SlabArena::size() const
+{
+	return mSize;
+}
+
+const size_t SlabArena::slabCount() const
+{
+	return mSlabs.size();
+}
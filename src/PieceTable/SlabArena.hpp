@@ -0,0 +1,84 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file SlabArena.hpp
+* @brief Provides the storage behind the piece table's append buffer
+*
+* Text is copied into fixed-size slabs instead of one growing string, so adding text never moves what is already stored.
+* Views into the arena stay valid for as long as the arena lives.
+* Each append is kept inside a single slab, so any span that was appended together can be read back as one view
+*/
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <memory>
+
+class SlabArena
+{
+public:
+	/// <summary>
+	/// Copies text into the arena. Text larger than a slab gets a slab of its own
+	/// </summary>
+	/// <param name="text"></param>
+	/// <returns> The position of the copied text </returns>
+	size_t append(const std::string_view text);
+
+	/// <summary>
+	/// Returns the text at [pos, pos + length). The span must not cross from one append into a different slab
+	/// </summary>
+	/// <param name="pos"></param>
+	/// <param name="length"></param>
+	/// <returns></returns>
+	const std::string_view view(const size_t pos, const size_t length) const;
+
+	/// <summary>
+	/// The number of bytes stored
+	/// </summary>
+	/// <returns></returns>
+	const size_t size() const;
+
+	/// <summary>
+	/// The number of slabs allocated so far
+	/// </summary>
+	/// <returns></returns>
+	const size_t slabCount() const;
+
+	inline static constexpr size_t slabSize = 64 * 1024;
+
+private:
+	/// <summary>
+	/// Positions are unique across all slabs. Each slab starts one past where the previous slab's capacity ends,
+	/// so a span ending at the end of one slab is never mistaken for one continuing into the next
+	/// </summary>
+	struct Slab
+	{
+		size_t base = 0, used = 0, capacity = 0;
+		std::unique_ptr<char[]> data;
+	};
+
+	std::vector<Slab> mSlabs;
+	size_t mSize = 0;
+};
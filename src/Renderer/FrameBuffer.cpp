@@ -0,0 +1,376 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "FrameBuffer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+void FrameBuffer::resize(const size_t rows, const size_t cols)
+{
+	mSized = true;
+	mRows = rows;
+	mCols = cols;
+	mCells.assign(mRows * mCols, Cell());
+	mPreviousCells.assign(mRows * mCols, Cell());
+	mPreviousKnown.assign(mRows, false);
+	mStyle = Style();
+}
+
+void FrameBuffer::invalidate()
+{
+	std::fill(mPreviousKnown.begin(), mPreviousKnown.end(), false);
+}
+
+void FrameBuffer::setScrollRegion(const size_t top, const size_t bottom)
+{
+	mScrollTop = top;
+	mScrollBottom = bottom;
+}
+
+void FrameBuffer::scroll(const size_t top, const size_t bottom, const int64_t count)
+{
+	shiftRows(mCells, top, std::min(bottom, mRows), count);
+}
+
+const size_t FrameBuffer::write(const size_t row, size_t col, const std::string_view text)
+{
+	if (row >= mRows)
+	{
+		if (mSized) return col;
+		grow(row + 1, mCols);
+	}
+
+	Cell* sequence = nullptr; //Cell of the UTF-8 character being written, while its continuation bytes are still to come
+	size_t sequenceLength = 0, sequenceFilled = 0;
+	size_t i = 0;
+	while (i < text.length())
+	{
+		const char character = text[i];
+		if (character == '\x1b' && i + 1 < text.length() && text[i + 1] == '[')
+		{
+			//Control sequences end with a byte in the range 0x40 to 0x7E
+			size_t end = i + 2;
+			while (end < text.length() && (text[end] < 0x40 || text[end] > 0x7E)) ++end;
+			if (end == text.length()) break;
+
+			if (text[end] == 'm') applyEscape(text.substr(i + 2, end - i - 2));
+			else if (text[end] == 'K')
+			{
+				const Cell erased = { ' ', {}, Style{ .background = mStyle.background } }; //Erasing only keeps the background color
+				std::fill(mCells.begin() + row * mCols + std::min(col, mCols), mCells.begin() + (row + 1) * mCols, erased);
+			}
+			i = end + 1;
+			continue;
+		}
+
+		++i;
+		if (character == '\r' || character == '\n') continue;
+		const uint8_t byte = static_cast<uint8_t>(character);
+		if ((byte & 0xC0) == 0x80 && sequenceFilled < sequenceLength)
+		{
+			//Continuation bytes belong to the character before them and don't take a column
+			if (sequence) sequence->continuation[sequenceFilled] = character;
+			++sequenceFilled;
+			continue;
+		}
+
+		sequenceLength = (byte >= 0xF0 && byte <= 0xF7) ? 3 : (byte >= 0xE0 && byte <= 0xEF) ? 2 : (byte >= 0xC0 && byte <= 0xDF) ? 1 : 0;
+		sequenceFilled = 0;
+		sequence = nullptr;
+		if (col >= mCols)
+		{
+			if (mSized) continue;
+			grow(mRows, col + 1);
+		}
+		Cell& cell = mCells[row * mCols + col];
+		cell = { character, {}, mStyle };
+		if (sequenceLength > 0) sequence = &cell;
+		++col;
+	}
+	return col;
+}
+
+void FrameBuffer::setStyle(const Style& style)
+{
+	mStyle = style;
+}
+
+void FrameBuffer::flush(std::string& output)
+{
+	mEncoder.reset();
+	mCursorRow = std::numeric_limits<size_t>::max();
+	mCursorCol = std::numeric_limits<size_t>::max();
+
+	if (mScrollBottom <= mRows && mScrollBottom > mScrollTop + 1) appendScroll(output);
+	for (size_t row = 0; row < mRows; ++row)
+	{
+		if (!mPreviousKnown[row])
+		{
+			appendRun(output, row, 0, mCols);
+			continue;
+		}
+
+		const Cell* cells = mCells.data() + row * mCols;
+		const Cell* previousCells = mPreviousCells.data() + row * mCols;
+		size_t col = 0;
+		while (col < mCols)
+		{
+			if (cells[col] == previousCells[col])
+			{
+				++col;
+				continue;
+			}
+			if (!rowIsAscii(mCells, row) || !rowIsAscii(mPreviousCells, row))
+			{
+				//The terminal's columns may not line up with the cells, so the cursor is only moved to the start of the row
+				appendRun(output, row, 0, mCols);
+				break;
+			}
+
+			//The run ends once there are more than maxSkippedCells unchanged cells in a row
+			size_t end = col + 1;
+			for (size_t next = end; next < mCols && next - end < maxSkippedCells; ++next)
+			{
+				if (cells[next] != previousCells[next]) end = next + 1;
+			}
+			appendRun(output, row, col, end);
+			col = end;
+		}
+	}
+	mEncoder.encode(output, Style());
+
+	mCells.swap(mPreviousCells);
+	std::fill(mCells.begin(), mCells.end(), Cell());
+	std::fill(mPreviousKnown.begin(), mPreviousKnown.end(), true);
+	mStyle = Style();
+}
+
+const size_t FrameBuffer::rows() const
+{
+	return mRows;
+}
+
+const size_t FrameBuffer::cols() const
+{
+	return mCols;
+}
+
+const FrameBuffer::Cell& FrameBuffer::at(const size_t row, const size_t col) const
+{
+	if (row >= mRows || col >= mCols) throw std::out_of_range("Cell is outside of the frame");
+	return mCells[row * mCols + col];
+}
+
+void FrameBuffer::grow(const size_t rows, const size_t cols)
+{
+	std::vector<Cell> cells(rows * cols);
+	for (size_t row = 0; row < mRows; ++row)
+	{
+		std::copy(mCells.begin() + row * mCols, mCells.begin() + (row + 1) * mCols, cells.begin() + row * cols);
+	}
+	mCells = std::move(cells);
+	mPreviousCells.assign(rows * cols, Cell());
+
+	//The previous frame isn't kept, so everything is drawn next time
+	mPreviousKnown.assign(rows, false);
+	mRows = rows;
+	mCols = cols;
+}
+
+void FrameBuffer::appendScroll(std::string& output)
+{
+	const size_t height = mScrollBottom - mScrollTop;
+	mRowHashes.resize(height);
+	mPreviousRowHashes.resize(height);
+	size_t unchangedRows = 0;
+	for (size_t i = 0; i < height; ++i)
+	{
+		if (!mPreviousKnown[mScrollTop + i]) return; //Nothing to scroll, it is all being drawn anyway
+		mRowHashes[i] = hashRow(mCells, mScrollTop + i);
+		mPreviousRowHashes[i] = hashRow(mPreviousCells, mScrollTop + i);
+		if (mRowHashes[i] == mPreviousRowHashes[i]) ++unchangedRows;
+	}
+	if (unchangedRows > height / 2) return; //Most of the rows are already right, so it isn't a scroll
+
+	//Finds how far the rows moved, by which distance lines up the most rows with where they were last frame
+	int64_t bestCount = 0;
+	size_t bestMatches = unchangedRows;
+	for (size_t distance = 1; distance < height; ++distance)
+	{
+		size_t upMatches = 0, downMatches = 0;
+		for (size_t i = 0; i + distance < height; ++i)
+		{
+			if (mRowHashes[i] == mPreviousRowHashes[i + distance]) ++upMatches;
+			if (mRowHashes[i + distance] == mPreviousRowHashes[i]) ++downMatches;
+		}
+		if (upMatches > bestMatches)
+		{
+			bestMatches = upMatches;
+			bestCount = static_cast<int64_t>(distance);
+		}
+		if (downMatches > bestMatches)
+		{
+			bestMatches = downMatches;
+			bestCount = -static_cast<int64_t>(distance);
+		}
+	}
+	if (bestMatches <= unchangedRows + 1) return; //Scrolling wouldn't save enough to be worth the escape sequences
+
+	//DECSTBM limits scrolling to the region, SU/SD scroll it, and the region is then set back to the whole screen
+	output.append("\x1b[");
+	appendNumber(output, mScrollTop + 1);
+	output.push_back(';');
+	appendNumber(output, mScrollBottom);
+	output.append("r\x1b[");
+	appendNumber(output, static_cast<size_t>((bestCount > 0) ? bestCount : -bestCount));
+	output.append((bestCount > 0) ? "S\x1b[r" : "T\x1b[r");
+	shiftRows(mPreviousCells, mScrollTop, mScrollBottom, bestCount); //What is on screen now, to diff the frame against
+}
+
+void FrameBuffer::shiftRows(std::vector<Cell>& cells, const size_t top, const size_t bottom, const int64_t count) const
+{
+	if (top >= bottom || count == 0) return;
+	const size_t distance = std::min(static_cast<size_t>((count > 0) ? count : -count), bottom - top);
+	const auto regionStart = cells.begin() + top * mCols;
+	const auto regionEnd = cells.begin() + bottom * mCols;
+	if (count > 0)
+	{
+		std::move(regionStart + distance * mCols, regionEnd, regionStart);
+		std::fill(regionEnd - distance * mCols, regionEnd, Cell());
+	}
+	else
+	{
+		std::move_backward(regionStart, regionEnd - distance * mCols, regionEnd);
+		std::fill(regionStart, regionStart + distance * mCols, Cell());
+	}
+}
+
+const uint64_t FrameBuffer::hashRow(const std::vector<Cell>& cells, const size_t row) const
+{
+	//FNV-1a over each cell's character and style
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t col = 0; col < mCols; ++col)
+	{
+		const Cell& cell = cells[row * mCols + col];
+		const uint64_t value = static_cast<uint8_t>(cell.glyph) | (static_cast<uint64_t>(cell.style.foreground) << 8)
+			| (static_cast<uint64_t>(cell.style.background) << 24) | (static_cast<uint64_t>(cell.style.inverse) << 40);
+		hash = (hash ^ value) * 1099511628211ull;
+		if (cell.continuation[0] != '\0')
+		{
+			const uint64_t continuation = static_cast<uint8_t>(cell.continuation[0]) | (static_cast<uint64_t>(static_cast<uint8_t>(cell.continuation[1])) << 8)
+				| (static_cast<uint64_t>(static_cast<uint8_t>(cell.continuation[2])) << 16);
+			hash = (hash ^ continuation) * 1099511628211ull;
+		}
+	}
+	return hash;
+}
+
+const bool FrameBuffer::rowIsAscii(const std::vector<Cell>& cells, const size_t row) const
+{
+	const Cell* rowCells = cells.data() + row * mCols;
+	return std::all_of(rowCells, rowCells + mCols, [](const Cell& cell) { return (static_cast<uint8_t>(cell.glyph) & 0x80) == 0; });
+}
+
+void FrameBuffer::applyEscape(const std::string_view parameters)
+{
+	//Parameters are separated by ';', and an empty parameter counts as 0
+	uint16_t values[16] = {};
+	size_t count = 1;
+	for (const char character : parameters)
+	{
+		if (character == ';')
+		{
+			if (count == std::size(values)) break;
+			++count;
+		}
+		else if (character >= '0' && character <= '9') values[count - 1] = values[count - 1] * 10 + (character - '0');
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint16_t value = values[i];
+		if (value == 0) mStyle = Style();
+		else if (value == 7) mStyle.inverse = true;
+		else if (value == 27) mStyle.inverse = false;
+		else if (value >= 30 && value <= 37) mStyle.foreground = value - 30;
+		else if (value >= 40 && value <= 47) mStyle.background = value - 40;
+		else if (value >= 90 && value <= 97) mStyle.foreground = value - 90 + 8;
+		else if (value >= 100 && value <= 107) mStyle.background = value - 100 + 8;
+		else if (value == 39) mStyle.foreground = Style::defaultColor;
+		else if (value == 49) mStyle.background = Style::defaultColor;
+		else if ((value == 38 || value == 48) && i + 2 < count && values[i + 1] == 5)
+		{
+			(value == 38 ? mStyle.foreground : mStyle.background) = values[i + 2] % 256;
+			i += 2;
+		}
+	}
+}
+
+void FrameBuffer::appendRun(std::string& output, const size_t row, const size_t startCol, const size_t endCol)
+{
+	const Cell* cells = mCells.data() + row * mCols;
+
+	//Blank cells at the end of the row are cleared in one go rather than written out
+	size_t blankCol = endCol;
+	if (endCol == mCols)
+	{
+		while (blankCol > startCol && cells[blankCol - 1] == Cell()) --blankCol;
+	}
+
+	if (mCursorRow != row || mCursorCol != startCol) appendCursorMove(output, row, startCol);
+	for (size_t col = startCol; col < blankCol; ++col)
+	{
+		mEncoder.encode(output, cells[col].style);
+		output.push_back(cells[col].glyph);
+		for (size_t i = 0; i < std::size(cells[col].continuation) && cells[col].continuation[i] != '\0'; ++i) output.push_back(cells[col].continuation[i]);
+	}
+	if (blankCol < endCol)
+	{
+		mEncoder.encode(output, Style());
+		output.append("\x1b[K");
+	}
+
+	mCursorRow = row;
+	mCursorCol = (blankCol == mCols) ? std::numeric_limits<size_t>::max() : blankCol; //Writing the last column leaves the cursor waiting to wrap
+}
+
+void FrameBuffer::appendCursorMove(std::string& output, const size_t row, const size_t col)
+{
+	output.append("\x1b[");
+	appendNumber(output, row + 1);
+	output.push_back(';');
+	appendNumber(output, col + 1);
+	output.push_back('H');
+}
+
+void FrameBuffer::appendNumber(std::string& output, const size_t number)
+{
+	char digits[20];
+	const std::to_chars_result result = std::to_chars(std::begin(digits), std::end(digits), number);
+	output.append(digits, result.ptr);
+}
@@ -0,0 +1,145 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file FrameBuffer.hpp
+* @brief A grid of the cells on screen, used to only send the terminal what changed since the last frame
+*
+* Each frame is drawn into the grid as text with SGR color escapes, the same way it would be written to the terminal.
+* When the frame is sent, each row is compared against the previous frame and only the runs of cells that changed are written,
+* each one after a cursor move to where it starts. When the rows in the scroll region have only moved up or down, the terminal
+* is told to scroll them first, so only the rows that came into view are drawn.
+* A cell holds a whole UTF-8 character, and rows with characters outside of ASCII are rewritten in full when they change, as their
+* width on the terminal isn't known well enough to move the cursor into the middle of them
+*/
+#pragma once
+#include "SgrEncoder.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class FrameBuffer
+{
+public:
+	using Style = SgrEncoder::Style;
+
+	struct Cell
+	{
+		char glyph = ' '; //First byte of the character
+		char continuation[3] = {}; //The rest of a UTF-8 character, or 0
+		Style style;
+
+		bool operator==(const Cell& other) const = default;
+	};
+
+	/// <summary>
+	/// Sets the size of the screen. Nothing from the previous frame is kept, so the next frame is drawn in full
+	/// </summary>
+	/// <param name="rows"></param>
+	/// <param name="cols"></param>
+	void resize(const size_t rows, const size_t cols);
+
+	/// <summary>
+	/// Forgets what is on screen, so the next frame is drawn in full
+	/// </summary>
+	void invalidate();
+
+	/// <summary>
+	/// Sets the rows [top, bottom) that may be scrolled with DECSTBM and SU/SD instead of being redrawn. An empty region turns scrolling off
+	/// </summary>
+	/// <param name="top"></param>
+	/// <param name="bottom"></param>
+	void setScrollRegion(const size_t top, const size_t bottom);
+
+	/// <summary>
+	/// Moves the rows [top, bottom) of the frame up by count rows, or down if count is negative, the same way a terminal scrolls them.
+	/// The rows that are moved into are blank
+	/// </summary>
+	/// <param name="top"></param>
+	/// <param name="bottom"></param>
+	/// <param name="count"></param>
+	void scroll(const size_t top, const size_t bottom, const int64_t count);
+
+	/// <summary>
+	/// Writes text to a row of the frame, starting at col. SGR escapes in the text change the style of the cells after them,
+	/// and the style carries on to later writes in the same frame, like it would on a terminal. "\x1b[K" clears the rest of the row.
+	/// Until resize() is called the frame grows to fit what is written, after that anything outside of it is dropped
+	/// </summary>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	/// <param name="text"></param>
+	/// <returns> The column after the text </returns>
+	const size_t write(const size_t row, size_t col, const std::string_view text);
+
+	/// <summary>
+	/// Sets the style that following writes start with
+	/// </summary>
+	/// <param name="style"></param>
+	void setStyle(const Style& style);
+
+	/// <summary>
+	/// Appends the escape sequences that change the screen from the previous frame to this one, then starts a new blank frame.
+	/// The terminal's style is reset at the end if it was changed
+	/// </summary>
+	/// <param name="output"></param>
+	void flush(std::string& output);
+
+	/// <summary>
+	/// Appends a cursor move to the 0-based row and col
+	/// </summary>
+	/// <param name="output"></param>
+	/// <param name="row"></param>
+	/// <param name="col"></param>
+	static void appendCursorMove(std::string& output, const size_t row, const size_t col);
+
+	const size_t rows() const;
+	const size_t cols() const;
+	const Cell& at(const size_t row, const size_t col) const;
+
+private:
+	void grow(const size_t rows, const size_t cols);
+	void appendScroll(std::string& output);
+	void shiftRows(std::vector<Cell>& cells, const size_t top, const size_t bottom, const int64_t count) const;
+	const uint64_t hashRow(const std::vector<Cell>& cells, const size_t row) const;
+	const bool rowIsAscii(const std::vector<Cell>& cells, const size_t row) const;
+	void applyEscape(const std::string_view parameters);
+	void appendRun(std::string& output, const size_t row, const size_t startCol, const size_t endCol);
+	static void appendNumber(std::string& output, const size_t number);
+
+private:
+	//Unchanged cells this close together are rewritten rather than moving the cursor past them, as the move would take more bytes
+	inline static constexpr size_t maxSkippedCells = 8;
+
+	std::vector<Cell> mCells, mPreviousCells; //Row-major, mRows * mCols
+	std::vector<bool> mPreviousKnown; //Per row. Rows that aren't known are redrawn in full
+	size_t mRows = 0, mCols = 0;
+	bool mSized = false;
+	size_t mScrollTop = 0, mScrollBottom = 0;
+	std::vector<uint64_t> mRowHashes, mPreviousRowHashes; //Only used while looking for a scroll, kept so they don't allocate
+	Style mStyle; //Style for the next write, carried over between writes in a frame
+	SgrEncoder mEncoder; //Keeps track of the terminal's style while flushing
+	size_t mCursorRow = 0, mCursorCol = 0; //Where the terminal's cursor is while flushing
+};
@@ -25,87 +25,109 @@ SOFTWARE.
 #include "Renderer.hpp"
 
 #include <format>
-#include <iostream>
+#include <cstdlib>
 
 constexpr char MiniVersion[7] = "0.8.0a";
 
-Renderer::Renderer() : mTextRenderBuffer("\x1b[H") {}
+Renderer::Renderer() {}
+
+void Renderer::resize(const size_t rows, const size_t cols)
+{
+	mFrame.resize(rows, cols);
+	mFullRedraw = true;
+}
+
+void Renderer::setScrollRegion(const size_t top, const size_t bottom)
+{
+	static const bool scrollsRegions = terminalScrollsRegions();
+	if (scrollsRegions) mFrame.setScrollRegion(top, bottom);
+}
+
+StyleCompositor& Renderer::styles()
+{
+	return mStyles;
+}
 
 void Renderer::addRenderedLineToBuffer(const std::string& renderedLine)
 {
-	mTextRenderBuffer.append(renderedLine);
-	mTextRenderBuffer.append("\x1b[0K\r\n");
+	mStyles.compose(mFrame, mTextRow, renderedLine);
+	++mTextRow;
 }
 
 void Renderer::addEndOfFileToBuffer(const uint16_t rowsToEnter, const uint16_t colCount, const bool emptyFile)
 {
 	constexpr char emptyRowCharacter[2] = "~";
-	mTextRenderBuffer.append("\x1b[0m");
+	mFrame.setStyle(FrameBuffer::Style());
 	for (uint16_t i = 1; i <= rowsToEnter; ++i)
 	{
 		if (emptyFile && i == rowsToEnter / 3)
 		{
-			const std::string emptyFileMessage = std::format("Mini Editor -- version {}\x1b[0K\r\n", MiniVersion);
-			uint16_t padding = (colCount - emptyFileMessage.length()) / 2;
-			if (padding > 0)
-			{
-				mTextRenderBuffer.append(emptyRowCharacter);
-				--padding;
-
-				mTextRenderBuffer.insert(mTextRenderBuffer.length(), padding, ' ');
-			}
-			mTextRenderBuffer.append(emptyFileMessage);
+			const std::string emptyFileMessage = std::format("Mini Editor -- version {}", MiniVersion);
+			const uint16_t padding = (colCount > emptyFileMessage.length()) ? (colCount - emptyFileMessage.length()) / 2 : 0;
+			if (padding > 0) mFrame.write(mTextRow, 0, emptyRowCharacter);
+			mFrame.write(mTextRow, padding, emptyFileMessage);
 		}
 		else
 		{
-			mTextRenderBuffer.append(emptyRowCharacter);
-			mTextRenderBuffer.append("\x1b[0K\r\n");
+			mFrame.write(mTextRow, 0, emptyRowCharacter);
 		}
+		++mTextRow;
 	}
 }
 
 void Renderer::renderScreen(const bool forceDraw, const bool renderCommandBuffer)
 {
-	std::string bufferToRender;
-	mTextRenderBuffer.append("\x1b[3J");
-
-	if (mTextRenderBuffer != mPreviousTextRenderBuffer || forceDraw)
+	if (renderCommandBuffer)
 	{
-		bufferToRender.append(mTextRenderBuffer);
-		mPreviousTextRenderBuffer = mTextRenderBuffer;
+		const size_t endCol = mFrame.write(mCommandRow, 0, mCommandBuffer);
+		mFrame.write(mCommandRow, endCol, "\x1b[0K");
 	}
-	bufferToRender.append(mStatusBuffer);
-
-	if (renderCommandBuffer) bufferToRender.append(mCommandBuffer);
 
-	bufferToRender.append(mCursorBuffer);
+	std::string& output = mWriter.beginFrame();
+	if (forceDraw || mFullRedraw)
+	{
+		output.append("\x1b[2J\x1b[3J"); //Clear screen and saved lines
+		mFrame.invalidate();
+		mFullRedraw = false;
+	}
+	mFrame.flush(output);
+	if (mCursorRow > 0 && mCursorCol > 0) FrameBuffer::appendCursorMove(output, mCursorRow - 1, mCursorCol - 1);
+	mWriter.endFrame();
 
-	std::cout << bufferToRender;
-	std::cout.flush();
+	mTextRow = 0;
+	mStyles.clear();
+}
 
-	mTextRenderBuffer = "\x1b[H";
+const FrameWriter::Stats& Renderer::lastFrameStats() const
+{
+	return mWriter.lastFrame();
 }
 
-void Renderer::setStatusBuffer(const uint16_t statusRowStart, const bool dirty, const std::string_view fileName, const size_t numRows, const size_t currentRow, const size_t currentCol, const std::string& mode, const std::string& rStatus, const size_t maxLength)
+void Renderer::setStatusBuffer(const uint16_t statusRowStart, const bool dirty, const std::string_view fileName, const size_t numRows, const uint8_t indexProgress, const size_t currentRow, const size_t currentCol, const std::string& mode, const std::string& rStatus, const size_t maxLength)
 {
-	constexpr uint8_t statusColStart = 0;
-	mStatusBuffer = std::format("\x1b[{};{}H", statusRowStart, statusColStart);
-	mStatusBuffer.append("\x1b[0m\x1b[0K\x1b[7m");
+	mStatusBuffer = "\x1b[0m\x1b[7m";
 	
-	std::string fileInfo = std::format("{} - {} lines {}", fileName, numRows, dirty ? "(modified)" : "");
+	std::string fileInfo;
+	if (indexProgress < 100) fileInfo = std::format("{} - {}+ lines (indexing {}%) {}", fileName, numRows, indexProgress, dirty ? "(modified)" : "");
+	else fileInfo = std::format("{} - {} lines {}", fileName, numRows, dirty ? "(modified)" : "");
 
+	if (fileInfo.length() > maxLength) fileInfo.resize(maxLength); //Long file names are cut off rather than pushing the rest off the screen
 	mStatusBuffer.append(fileInfo);
 
 	size_t currentStatusLength = fileInfo.length();
 
-	while ((maxLength / 2) - currentStatusLength > mode.length() / 2)
+	//The mode is centered, unless the file info already reaches past where it would start
+	const size_t modeStart = (maxLength / 2 > mode.length() / 2) ? maxLength / 2 - mode.length() / 2 : 0;
+	if (modeStart > currentStatusLength)
 	{
-		mStatusBuffer.append(" ");
-		++currentStatusLength;
+		mStatusBuffer.append(modeStart - currentStatusLength, ' ');
+		currentStatusLength = modeStart;
 	}
 
-	mStatusBuffer.append(mode);
-	currentStatusLength += mode.length();
+	//The mode can be long when it names the large file policy, so it only takes the space that is left
+	const std::string_view shownMode = std::string_view(mode).substr(0, maxLength - currentStatusLength);
+	mStatusBuffer.append(shownMode);
+	currentStatusLength += shownMode.length();
 
 	while (currentStatusLength + rStatus.length() < maxLength)
 	{
@@ -113,27 +135,38 @@ void Renderer::setStatusBuffer(const uint16_t statusRowStart, const bool dirty,
 		++currentStatusLength;
 	}
 	mStatusBuffer.append(rStatus);
-	mStatusBuffer.append("\r\n\x1b[0K");
-
 	mStatusBuffer.append("\x1b[0m");
+
+	const size_t statusRow = (statusRowStart > 0) ? statusRowStart - 1 : 0; //Rows in escape sequences start at 1
+	const size_t endCol = mFrame.write(statusRow, 0, mStatusBuffer);
+	mFrame.write(statusRow, endCol, "\x1b[0K");
 }
 
 void Renderer::setCursorBuffer(const uint16_t cursorRow, const uint16_t cursorCol)
 {
-	mCursorBuffer = std::format("\x1b[{};{}H", cursorRow, cursorCol);
+	mCursorRow = cursorRow;
+	mCursorCol = cursorCol;
 }
 
 void Renderer::setCommandBuffer(const std::string& commandBuffer, const size_t commandBufferRow)
 {
-	constexpr uint8_t statusColStart = 0;
-	mCommandBuffer = std::format("\x1b[{};{}H", commandBufferRow, statusColStart);
-	mCommandBuffer.append("\x1b[0K");
-	mCommandBuffer.append(commandBuffer);
+	mCommandRow = (commandBufferRow > 0) ? commandBufferRow - 1 : 0;
+	mCommandBuffer = commandBuffer;
+}
+
+bool Renderer::terminalScrollsRegions()
+{
+#ifdef _WIN32
+	return true; //Consoles with virtual terminal processing support both
+#else
+	const char* term = std::getenv("TERM"); //Anything that isn't a dumb terminal is taken to be xterm compatible
+	return term != nullptr && std::string_view(term) != "" && std::string_view(term) != "dumb";
+#endif
 }
 
 void Renderer::clearScreen()
 {
-	std::string clearScreen = "\x1b[2J\x1b[3J\x1b[H"; //Clear screen, clear saved lines, and move cursor to Home (0,0)
-	std::cout << clearScreen;
-	std::cout.flush();
-}
\ No newline at end of file
+	FrameWriter writer;
+	writer.beginFrame().append("\x1b[2J\x1b[3J\x1b[H"); //Clear screen, clear saved lines, and move cursor to Home (0,0)
+	writer.endFrame();
+}
@@ -23,6 +23,10 @@ SOFTWARE.
 */
 
 #pragma once
+#include "FrameBuffer.hpp"
+#include "StyleCompositor.hpp"
+#include "Utility/FrameWriter/FrameWriter.hpp"
+
 #include <cstdint>
 #include <string>
 #include <string_view>
@@ -35,7 +39,28 @@ public:
 	Renderer();
 
 	/// <summary>
-	/// Adds the rendered line to the text buffer to later be rendered
+	/// Sets the size of the terminal. The next frame is drawn in full
+	/// </summary>
+	/// <param name="rows"></param>
+	/// <param name="cols"></param>
+	void resize(const size_t rows, const size_t cols);
+
+	/// <summary>
+	/// Sets the rows [top, bottom) that hold the file's text. When they have only moved up or down since the last frame, the terminal
+	/// scrolls them and only the rows that came into view are drawn. Terminals that can't scroll a region get them redrawn instead
+	/// </summary>
+	/// <param name="top"></param>
+	/// <param name="bottom"></param>
+	void setScrollRegion(const size_t top, const size_t bottom);
+
+	/// <summary>
+	/// The colors for the rendered lines of the next frame. They are cleared once the frame is rendered
+	/// </summary>
+	/// <returns></returns>
+	StyleCompositor& styles();
+
+	/// <summary>
+	/// Adds the rendered line to the text buffer to later be rendered, colored by the spans in styles() for its row
 	/// </summary>
 	/// <param name="renderedLine"></param>
 	void addRenderedLineToBuffer(const std::string& renderedLine);
@@ -49,7 +74,9 @@ public:
 	void addEndOfFileToBuffer(const uint16_t rowsToEnter, const uint16_t colCount, const bool emptyFile);
 
 	/// <summary>
-	/// Renders the main text buffer, status buffer, cursor buffer, and command buffer when applicable
+	/// Renders the main text buffer, status buffer, cursor buffer, and command buffer when applicable.
+	/// Only the cells that changed since the last frame are written, unless forceDraw is set, in which case the screen is cleared first.
+	/// The frame is sent to the terminal in a single write
 	/// </summary>
 	/// <param name="forceDraw"></param>
 	/// <param name="renderCommandBuffer"></param>
@@ -62,12 +89,13 @@ public:
 	/// <param name="dirty"></param>
 	/// <param name="fileName"></param>
 	/// <param name="numRows"></param>
+	/// <param name="indexProgress"> How much of the file has been indexed. Anything under 100 shows numRows as a lower bound </param>
 	/// <param name="currentRow"></param>
 	/// <param name="currentCol"></param>
 	/// <param name="mode"></param>
 	/// <param name="rStatus"></param>
 	/// <param name="maxLength"></param>
-	void setStatusBuffer(const uint16_t statusRowStart, const bool dirty, const std::string_view fileName, const size_t numRows, const size_t currentRow, const size_t currentCol, const std::string& mode, const std::string& rStatus, const size_t maxLength);
+	void setStatusBuffer(const uint16_t statusRowStart, const bool dirty, const std::string_view fileName, const size_t numRows, const uint8_t indexProgress, const size_t currentRow, const size_t currentCol, const std::string& mode, const std::string& rStatus, const size_t maxLength);
 
 	/// <summary>
 	/// Sets the cursor buffer responsible for displaying the cursor in the correct position
@@ -83,13 +111,32 @@ public:
 	/// <param name="commandBufferRow"></param>
 	void setCommandBuffer(const std::string& commandBuffer, const size_t commandBufferRow);
 
+	/// <summary>
+	/// The bytes and write calls it took to send the last frame
+	/// </summary>
+	/// <returns></returns>
+	const FrameWriter::Stats& lastFrameStats() const;
+
 	/// <summary>
 	/// Clears the terminal
 	/// </summary>
 	static void clearScreen();
 
 private:
-	std::string mTextRenderBuffer, mPreviousTextRenderBuffer;
-	std::string mCursorBuffer, mStatusBuffer;
+	/// <summary>
+	/// Whether the terminal is known to handle DECSTBM scroll regions and SU/SD
+	/// </summary>
+	/// <returns></returns>
+	static bool terminalScrollsRegions();
+
+private:
+	FrameBuffer mFrame;
+	StyleCompositor mStyles;
+	size_t mTextRow = 0; //Row the next rendered line goes on
+	bool mFullRedraw = true;
+	FrameWriter mWriter;
+	uint16_t mCursorRow = 0, mCursorCol = 0; //Where the cursor is left at the end of the frame, starting at 1
+	std::string mStatusBuffer;
 	std::string mCommandBuffer;
+	size_t mCommandRow = 0;
 };
\ No newline at end of file
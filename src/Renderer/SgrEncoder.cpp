@@ -0,0 +1,94 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "SgrEncoder.hpp"
+
+#include <array>
+
+struct Sequence
+{
+	std::array<char, 12> text{};
+	uint8_t length = 0;
+};
+
+static constexpr std::array<Sequence, 256> buildTable(const char layer)
+{
+	std::array<Sequence, 256> table{};
+	for (size_t color = 0; color < table.size(); ++color)
+	{
+		Sequence& sequence = table[color];
+		for (const char c : { '\x1b', '[', layer, '8', ';', '5', ';' }) sequence.text[sequence.length++] = c;
+		if (color >= 100) sequence.text[sequence.length++] = static_cast<char>('0' + color / 100);
+		if (color >= 10) sequence.text[sequence.length++] = static_cast<char>('0' + (color / 10) % 10);
+		sequence.text[sequence.length++] = static_cast<char>('0' + color % 10);
+		sequence.text[sequence.length++] = 'm';
+	}
+	return table;
+}
+
+//Built by the compiler, so there is nothing to format or allocate at run time
+static constexpr std::array<Sequence, 256> foregroundTable = buildTable('3');
+static constexpr std::array<Sequence, 256> backgroundTable = buildTable('4');
+
+void SgrEncoder::reset()
+{
+	mStyle = Style();
+}
+
+void SgrEncoder::encode(std::string& output, const Style& style)
+{
+	if (style == mStyle) return;
+	if (style == Style())
+	{
+		output.append("\x1b[0m"); //Shorter than undoing each attribute
+		mStyle = style;
+		return;
+	}
+
+	if (style.inverse != mStyle.inverse) output.append(style.inverse ? "\x1b[7m" : "\x1b[27m");
+	if (style.foreground != mStyle.foreground)
+	{
+		output.append((style.foreground == Style::defaultColor) ? std::string_view("\x1b[39m") : foreground(static_cast<uint8_t>(style.foreground)));
+	}
+	if (style.background != mStyle.background)
+	{
+		output.append((style.background == Style::defaultColor) ? std::string_view("\x1b[49m") : background(static_cast<uint8_t>(style.background)));
+	}
+	mStyle = style;
+}
+
+const SgrEncoder::Style& SgrEncoder::style() const
+{
+	return mStyle;
+}
+
+std::string_view SgrEncoder::foreground(const uint8_t color)
+{
+	return std::string_view(foregroundTable[color].text.data(), foregroundTable[color].length);
+}
+
+std::string_view SgrEncoder::background(const uint8_t color)
+{
+	return std::string_view(backgroundTable[color].text.data(), backgroundTable[color].length);
+}
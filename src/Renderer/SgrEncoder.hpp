@@ -0,0 +1,87 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file SgrEncoder.hpp
+* @brief Writes the SGR escape sequences that move the terminal from one style to another
+*
+* The sequences for all 256 foreground and background colors are built at compile time, so changing color is a copy out of a table.
+* The encoder remembers the terminal's style, and only writes the attributes that differ from it
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class SgrEncoder
+{
+public:
+	/// <summary>
+	/// The SGR attributes of a cell. Colors are 256 color palette indices, or defaultColor for the terminal's own color
+	/// </summary>
+	struct Style
+	{
+		inline static constexpr uint16_t defaultColor = 256;
+		uint16_t foreground = defaultColor;
+		uint16_t background = defaultColor;
+		bool inverse = false;
+
+		bool operator==(const Style& other) const = default;
+	};
+
+	/// <summary>
+	/// Starts again from the terminal's default style, as it is after "\x1b[0m"
+	/// </summary>
+	void reset();
+
+	/// <summary>
+	/// Appends what it takes to change the terminal to style. Nothing is appended if it is already in that style
+	/// </summary>
+	/// <param name="output"></param>
+	/// <param name="style"></param>
+	void encode(std::string& output, const Style& style);
+
+	/// <summary>
+	/// The style the terminal is in after what has been encoded so far
+	/// </summary>
+	/// <returns></returns>
+	const Style& style() const;
+
+	/// <summary>
+	/// "\x1b[38;5;{color}m"
+	/// </summary>
+	/// <param name="color"></param>
+	/// <returns></returns>
+	static std::string_view foreground(const uint8_t color);
+
+	/// <summary>
+	/// "\x1b[48;5;{color}m"
+	/// </summary>
+	/// <param name="color"></param>
+	/// <returns></returns>
+	static std::string_view background(const uint8_t color);
+
+private:
+	Style mStyle;
+};
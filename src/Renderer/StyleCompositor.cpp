@@ -0,0 +1,112 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "StyleCompositor.hpp"
+
+#include <algorithm>
+
+void StyleCompositor::setBaseStyle(const FrameBuffer::Style& style)
+{
+	mBaseStyle = style;
+}
+
+void StyleCompositor::clear()
+{
+	mForeground.spans.clear();
+	mBackground.spans.clear();
+	mForeground.sorted = mBackground.sorted = true;
+	mComposing = false;
+}
+
+void StyleCompositor::addForeground(const Span& span)
+{
+	mForeground.add(span);
+}
+
+void StyleCompositor::addBackground(const Span& span)
+{
+	mBackground.add(span);
+}
+
+void StyleCompositor::compose(FrameBuffer& frame, const size_t row, const std::string_view text)
+{
+	if (!mComposing)
+	{
+		mForeground.startFrame();
+		mBackground.startFrame();
+		mComposing = true;
+	}
+
+	//Spans are in bytes of the text, but a cell holds a whole UTF-8 character, so the frame's column is kept separately
+	size_t col = 0, frameCol = 0;
+	while (col < text.length())
+	{
+		//Each run goes until the next span starts or ends, in either layer
+		size_t runEnd = text.length();
+		FrameBuffer::Style style = mBaseStyle;
+		if (const Span* span = mForeground.at(row, col, runEnd)) style.foreground = span->color;
+		if (const Span* span = mBackground.at(row, col, runEnd)) style.background = span->color;
+
+		frame.setStyle(style);
+		frameCol = frame.write(row, frameCol, text.substr(col, runEnd - col));
+		col = runEnd;
+	}
+	frame.setStyle(FrameBuffer::Style());
+}
+
+void StyleCompositor::Layer::add(const Span& span)
+{
+	if (span.startCol >= span.endCol) return;
+	if (!spans.empty() && (span.row < spans.back().row || (span.row == spans.back().row && span.startCol < spans.back().startCol))) sorted = false;
+	spans.push_back(span);
+}
+
+void StyleCompositor::Layer::startFrame()
+{
+	if (!sorted)
+	{
+		std::stable_sort(spans.begin(), spans.end(), [](const Span& a, const Span& b)
+			{
+				return (a.row != b.row) ? a.row < b.row : a.startCol < b.startCol;
+			});
+		sorted = true;
+	}
+	next = 0;
+}
+
+const StyleCompositor::Span* StyleCompositor::Layer::at(const size_t row, const size_t col, size_t& nextChange)
+{
+	//Spans on earlier rows, or that end before col, are done with
+	while (next < spans.size() && (spans[next].row < row || (spans[next].row == row && spans[next].endCol <= col))) ++next;
+	if (next == spans.size() || spans[next].row != row) return nullptr;
+
+	const Span& span = spans[next];
+	if (span.startCol > col)
+	{
+		nextChange = std::min(nextChange, span.startCol);
+		return nullptr;
+	}
+	nextChange = std::min(nextChange, span.endCol);
+	return &span;
+}
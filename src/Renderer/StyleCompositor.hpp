@@ -0,0 +1,103 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file StyleCompositor.hpp
+* @brief Turns the plain text of each row and the spans of color on it into styled cells
+*
+* Syntax highlights color the text and find matches color the background. The spans for a frame are collected first, then each
+* row is written to the frame in one pass over its text and its spans, so nothing has to be inserted into the text or shifted afterwards
+*/
+#pragma once
+#include "FrameBuffer.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+class StyleCompositor
+{
+public:
+	/// <summary>
+	/// A color over the columns [startCol, endCol) of a row on screen, counted in bytes of the row's text
+	/// </summary>
+	struct Span
+	{
+		size_t row = 0;
+		size_t startCol = 0, endCol = 0;
+		uint8_t color = 0;
+	};
+
+	/// <summary>
+	/// Sets the style of text that isn't in any span
+	/// </summary>
+	/// <param name="style"></param>
+	void setBaseStyle(const FrameBuffer::Style& style);
+
+	/// <summary>
+	/// Removes the spans of the last frame
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Adds a span that colors the text. Spans don't have to be added in order
+	/// </summary>
+	/// <param name="span"></param>
+	void addForeground(const Span& span);
+
+	/// <summary>
+	/// Adds a span that colors the background, drawn over the text's color
+	/// </summary>
+	/// <param name="span"></param>
+	void addBackground(const Span& span);
+
+	/// <summary>
+	/// Writes text to a row of the frame, styled by the spans on that row. Rows have to be written from the top down,
+	/// so the spans for each row are found by carrying on from the last one
+	/// </summary>
+	/// <param name="frame"></param>
+	/// <param name="row"></param>
+	/// <param name="text"></param>
+	void compose(FrameBuffer& frame, const size_t row, const std::string_view text);
+
+private:
+	struct Layer
+	{
+		std::vector<Span> spans;
+		size_t next = 0; //The first span that could still be on the row being written
+		bool sorted = true;
+
+		void add(const Span& span);
+		void startFrame();
+
+		/// <summary>
+		/// Finds the color at col on the row being written, if there is one, and the next column where that could change
+		/// </summary>
+		const Span* at(const size_t row, const size_t col, size_t& nextChange);
+	};
+
+	FrameBuffer::Style mBaseStyle;
+	Layer mForeground, mBackground;
+	bool mComposing = false; //Set once the first row of a frame is written, so the spans are only sorted once
+};
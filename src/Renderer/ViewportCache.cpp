@@ -0,0 +1,112 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ViewportCache.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+void ViewportCache::resize(const size_t rows)
+{
+	if (mLines.size() < rows) mLines.resize(rows);
+}
+
+void ViewportCache::load(const PieceTable& document, const size_t startRow, const size_t endRow, const size_t startCol, const size_t maxLength)
+{
+	const size_t lineCount = document.lineCount();
+	const size_t newCount = (startRow < lineCount) ? std::min(endRow + 1, lineCount) - startRow : 0;
+	if (mLines.size() < newCount) mLines.resize(newCount);
+
+	//Move the rows that are still wanted to their new positions, so only the rows that came on screen need to be pulled out
+	size_t validStart = 0, validEnd = 0;
+	if (document.version() == mDocumentVersion && startCol == mStartCol && maxLength == mMaxLength && mCount > 0)
+	{
+		if (startRow >= mFirstRow && startRow - mFirstRow < mCount)
+		{
+			const size_t shift = startRow - mFirstRow;
+			std::rotate(mLines.begin(), mLines.begin() + shift, mLines.end());
+			validEnd = mCount - shift;
+		}
+		else if (startRow < mFirstRow && mFirstRow - startRow < newCount)
+		{
+			const size_t shift = mFirstRow - startRow;
+			std::rotate(mLines.begin(), mLines.end() - shift, mLines.end());
+			validStart = shift;
+			validEnd = shift + mCount;
+		}
+	}
+
+	mRowsLoaded = 0;
+	for (size_t i = 0; i < newCount; ++i)
+	{
+		Line& line = mLines[i];
+		if (i < validStart || i >= validEnd)
+		{
+			if (startCol == 0 || startCol < document.lineLength(startRow + i)) document.line(startRow + i, startCol, maxLength, line.line);
+			else line.line.clear();
+			++mRowsLoaded;
+		}
+		line.renderedLine.assign(line.line);
+	}
+
+	mFirstRow = startRow;
+	mCount = newCount;
+	mStartCol = startCol;
+	mMaxLength = maxLength;
+	mDocumentVersion = document.version();
+}
+
+void ViewportCache::keepRowsBefore(const PieceTable& document, const uint64_t previousVersion, const size_t firstChangedRow)
+{
+	if (mDocumentVersion != previousVersion) return;
+	mCount = (firstChangedRow > mFirstRow) ? std::min(mCount, firstChangedRow - mFirstRow) : 0;
+	mDocumentVersion = document.version();
+}
+
+const size_t ViewportCache::firstRow() const
+{
+	return mFirstRow;
+}
+
+const size_t ViewportCache::size() const
+{
+	return mFirstRow + mCount;
+}
+
+ViewportCache::Line& ViewportCache::at(const size_t row)
+{
+	if (row < mFirstRow || row >= size()) throw std::out_of_range("ViewportCache: row is not cached");
+	return mLines[row - mFirstRow];
+}
+
+const ViewportCache::Line& ViewportCache::at(const size_t row) const
+{
+	if (row < mFirstRow || row >= size()) throw std::out_of_range("ViewportCache: row is not cached");
+	return mLines[row - mFirstRow];
+}
+
+const size_t ViewportCache::rowsLoaded() const
+{
+	return mRowsLoaded;
+}
@@ -0,0 +1,101 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file ViewportCache.hpp
+* @brief Holds the rows that are on screen while a frame is being rendered
+*
+* Only the rows that are about to be drawn are pulled out of the document. The cache is sized to the window and keeps its
+* strings between frames, so a frame normally doesn't allocate, and rows that are still on screen after scrolling aren't pulled out again
+*/
+#pragma once
+#include "PieceTable/PieceTable.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class ViewportCache
+{
+public:
+	/// <summary>
+	/// A row pulled out of the document.
+	/// line is the document text, including \t and other characters
+	/// renderedLine is what gets displayed to the user, rebuilt from line every frame
+	/// </summary>
+	struct Line
+	{
+		std::string line;
+		std::string renderedLine;
+	};
+
+	/// <summary>
+	/// Makes sure the cache can hold a window of the given number of rows without allocating while rendering
+	/// </summary>
+	/// <param name="rows"></param>
+	void resize(const size_t rows);
+
+	/// <summary>
+	/// Fills the cache with the rows [startRow, endRow] of the document, stopping at the end of the document.
+	/// Rows that were cached last frame are reused if the document hasn't changed since. Every renderedLine is reset to its line
+	/// </summary>
+	/// <param name="document"></param>
+	/// <param name="startRow"></param>
+	/// <param name="endRow"></param>
+	/// <param name="startCol"> The characters before this aren't pulled out </param>
+	/// <param name="maxLength"> Rows longer than this only have maxLength characters pulled out, starting at startCol </param>
+	void load(const PieceTable& document, const size_t startRow, const size_t endRow, const size_t startCol = 0, const size_t maxLength = std::string::npos);
+
+	/// <summary>
+	/// Called when rows were only added to the end of the document, so the cached rows before firstChangedRow can still be used with the new version
+	/// </summary>
+	/// <param name="document"></param>
+	/// <param name="previousVersion"> The document's version before the rows were added. Nothing is kept if the cache is older than this </param>
+	/// <param name="firstChangedRow"></param>
+	void keepRowsBefore(const PieceTable& document, const uint64_t previousVersion, const size_t firstChangedRow);
+
+	/// <summary>
+	/// Rows are accessed by their row number in the file, so only rows in [firstRow(), size()) are available
+	/// </summary>
+	/// <returns></returns>
+	const size_t firstRow() const;
+	const size_t size() const;
+	Line& at(const size_t row);
+	const Line& at(const size_t row) const;
+
+	/// <summary>
+	/// How many rows had to be pulled out of the document by the last load()
+	/// </summary>
+	/// <returns></returns>
+	const size_t rowsLoaded() const;
+
+private:
+	std::vector<Line> mLines; //Only the first mCount are in use. The rest keep their buffers for later frames
+	size_t mFirstRow = 0;
+	size_t mCount = 0;
+	size_t mRowsLoaded = 0;
+	size_t mStartCol = 0;
+	size_t mMaxLength = std::string::npos;
+	uint64_t mDocumentVersion = 0; //PieceTable versions start at 1, so nothing matches an empty cache
+};
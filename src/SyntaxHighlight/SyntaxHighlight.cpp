@@ -136,7 +136,7 @@ const uint8_t SyntaxHighlight::color(HighlightType type) const
 	return mColors[static_cast<uint8_t>(type)];
 }
 
-void SyntaxHighlight::findEndMarker(const std::vector<FileHandler::Row>& fileRows, std::string_view& currentWord, size_t& row, size_t& posOffset, size_t& findPos, size_t startRow, size_t startCol, const std::string_view& strToFind, const HighlightType hlType)
+void SyntaxHighlight::findEndMarker(const ViewportCache& fileRows, std::string_view& currentWord, size_t& row, size_t& posOffset, size_t& findPos, size_t startRow, size_t startCol, const std::string_view& strToFind, const HighlightType hlType)
 {
 	size_t endPos;
 
@@ -180,7 +180,7 @@ void SyntaxHighlight::findEndMarker(const std::vector<FileHandler::Row>& fileRow
 	posOffset += endPos + strToFind.length();
 }
 
-bool SyntaxHighlight::highlightCommentCheck(const std::vector<FileHandler::Row>& fileRows, std::string_view& currentWord, FileHandler::Row* row, size_t findPos, size_t& posOffset, size_t& i)
+bool SyntaxHighlight::highlightCommentCheck(const ViewportCache& fileRows, std::string_view& currentWord, ViewportCache::Line* row, size_t findPos, size_t& posOffset, size_t& i)
 {
 	bool gotoNextRow = false;
 
@@ -28,7 +28,7 @@ SOFTWARE.
  */
 
 #pragma once
-#include "File/File.hpp"
+#include "Renderer/ViewportCache.hpp"
 #include "Utility/JsonParser/JsonParser.hpp"
 
 #include <vector>
@@ -102,11 +102,9 @@ public:
 	{
 		HighlightType highlightType = HighlightType::Normal;
 		size_t startRow = 0, startCol = 0, endRow = 0, endCol = 0;
-		size_t startPosAdjustment = 0, endPosAdjustment = 0;
 		bool endFound = true, drawColor = true;
 
 		//Adding constructors depending on what type of highlight is being inserted
-		//StartPosAdjustment and EndPosAdjustment will always be 0 at time of insert, so they don't need to be involved with constructor
 		HighlightLocation(HighlightType hl, size_t sr, size_t sc, size_t er, size_t ec)
 			: highlightType(hl), startRow(sr), startCol(sc), endRow(er), endCol(ec) {}
 		HighlightLocation(HighlightType hl, size_t sr, size_t sc, size_t er, size_t ec, bool ef, bool dc)
@@ -131,7 +129,7 @@ public:
 	/// <param name="startCol"></param>
 	/// <param name="strToFind"></param>
 	/// <param name=""></param>
-	void findEndMarker(const std::vector<FileHandler::Row>& fileRows, std::string_view& currentWord, size_t& row, size_t& posOffset, size_t& findPos, size_t startRow, size_t startCol, const std::string_view& strToFind, const HighlightType);
+	void findEndMarker(const ViewportCache& fileRows, std::string_view& currentWord, size_t& row, size_t& posOffset, size_t& findPos, size_t startRow, size_t startCol, const std::string_view& strToFind, const HighlightType);
 
 	/// <summary>
 	/// Checks the type of comment highlight currently found, if one is found
@@ -143,7 +141,7 @@ public:
 	/// <param name="posOffset"></param>
 	/// <param name="i"></param>
 	/// <returns></returns>
-	bool highlightCommentCheck(const std::vector<FileHandler::Row>& fileRows, std::string_view& currentWord, FileHandler::Row* row, size_t findPos, size_t& posOffset, size_t& i);
+	bool highlightCommentCheck(const ViewportCache& fileRows, std::string_view& currentWord, ViewportCache::Line* row, size_t findPos, size_t& posOffset, size_t& i);
 
 	/// <summary>
 	/// Removes all the un-needed highlights that are off-screen, and returns the position of the rowOffset to start checking for highlights on again.
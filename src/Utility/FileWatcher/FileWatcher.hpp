@@ -0,0 +1,86 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file FileWatcher.hpp
+* @brief Notices when another program writes to a file
+*
+* On Linux the file's directory is watched with inotify, which also catches the file being replaced by a rename (how most tools save).
+* Elsewhere the file's size and modification time are compared each time hasChanged() is called
+*/
+#pragma once
+#include <filesystem>
+#include <string>
+#include <utility> //std::exchange
+#include <cstdint>
+
+class FileWatcher
+{
+public:
+	FileWatcher() = default;
+	~FileWatcher() { stop(); }
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+	FileWatcher(FileWatcher&& other) noexcept : mPath(std::move(other.mPath)), mWatch(std::exchange(other.mWatch, -1)),
+		mSize(other.mSize), mModified(other.mModified) {}
+	FileWatcher& operator=(FileWatcher&& other) noexcept
+	{
+		if (this != &other)
+		{
+			stop();
+			mPath = std::move(other.mPath);
+			mWatch = std::exchange(other.mWatch, -1);
+			mSize = other.mSize;
+			mModified = other.mModified;
+		}
+		return *this;
+	}
+
+	/// <summary>
+	/// Starts watching the file. It doesn't need to exist yet
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns> False if the file can't be watched </returns>
+	bool watch(const std::filesystem::path& path);
+
+	/// <summary>
+	/// Whether the file has been written, replaced or removed since the last call. Never waits
+	/// </summary>
+	/// <returns></returns>
+	bool hasChanged();
+
+	/// <summary>
+	/// Stops watching the file
+	/// </summary>
+	void stop();
+
+private:
+	std::filesystem::path mPath;
+	intptr_t mWatch = -1; //The inotify descriptor, where it is used
+
+	//What the file looked like on the last call, where the file is compared instead of watched
+	uintmax_t mSize = 0;
+	std::filesystem::file_time_type mModified;
+};
@@ -0,0 +1,108 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FileWatcher/FileWatcher.hpp"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+bool FileWatcher::watch(const std::filesystem::path& path)
+{
+	stop();
+	mPath = path;
+
+	const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd == -1) return false;
+
+	//The directory is watched rather than the file, since a file replaced by a rename is a new file that a watch on the old one wouldn't see
+	const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+	if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) == -1)
+	{
+		::close(fd);
+		return false;
+	}
+	mWatch = fd;
+	return true;
+}
+
+bool FileWatcher::hasChanged()
+{
+	if (mWatch == -1) return false;
+
+	const std::string fileName = mPath.filename().string();
+	bool changed = false;
+	alignas(inotify_event) char buffer[4096];
+	while (true)
+	{
+		const ssize_t length = ::read(static_cast<int>(mWatch), buffer, sizeof(buffer));
+		if (length == -1 && errno == EINTR) continue;
+		if (length <= 0) break; //EAGAIN once everything queued has been read
+
+		for (ssize_t pos = 0; pos < length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + pos);
+			if (event->len > 0 && fileName == event->name) changed = true;
+			pos += sizeof(inotify_event) + event->len;
+		}
+	}
+	return changed;
+}
+
+void FileWatcher::stop()
+{
+	if (mWatch == -1) return;
+	::close(static_cast<int>(mWatch));
+	mWatch = -1;
+}
+#else
+bool FileWatcher::watch(const std::filesystem::path& path)
+{
+	mPath = path;
+	std::error_code ec;
+	mSize = std::filesystem::file_size(mPath, ec);
+	mModified = std::filesystem::last_write_time(mPath, ec);
+	return true;
+}
+
+bool FileWatcher::hasChanged()
+{
+	if (mPath.empty()) return false;
+
+	std::error_code ec;
+	const uintmax_t size = std::filesystem::file_size(mPath, ec);
+	const std::filesystem::file_time_type modified = std::filesystem::last_write_time(mPath, ec);
+	const bool changed = (size != mSize || modified != mModified);
+	mSize = size;
+	mModified = modified;
+	return changed;
+}
+
+void FileWatcher::stop()
+{
+	mPath.clear();
+}
+#endif
@@ -0,0 +1,53 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FileWatcher/FileWatcher.hpp"
+
+bool FileWatcher::watch(const std::filesystem::path& path)
+{
+	mPath = path;
+	std::error_code ec;
+	mSize = std::filesystem::file_size(mPath, ec);
+	mModified = std::filesystem::last_write_time(mPath, ec);
+	return true;
+}
+
+bool FileWatcher::hasChanged()
+{
+	if (mPath.empty()) return false;
+
+	//Comparing is a single stat, cheap enough to do on each refresh
+	std::error_code ec;
+	const uintmax_t size = std::filesystem::file_size(mPath, ec);
+	const std::filesystem::file_time_type modified = std::filesystem::last_write_time(mPath, ec);
+	const bool changed = (size != mSize || modified != mModified);
+	mSize = size;
+	mModified = modified;
+	return changed;
+}
+
+void FileWatcher::stop()
+{
+	mPath.clear();
+}
@@ -0,0 +1,124 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file FileWriter.hpp
+* @brief Writes a file straight from buffers that are already in memory
+*
+* Saving hands the writer a view of each piece of the document, so the document never has to be copied into one string first.
+* On Unix the views are written with writev, many at a time, and long unchanged ranges of the original file are copied inside the kernel.
+* Windows writes everything through a small buffer that turns '\n' into "\r\n", the same as the text-mode stream that was used before
+*/
+#pragma once
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+class FileWriter
+{
+public:
+	FileWriter() = default;
+	~FileWriter() { close(); }
+
+	FileWriter(const FileWriter&) = delete;
+	FileWriter& operator=(const FileWriter&) = delete;
+
+	/// <summary>
+	/// Creates the file, or empties it if it already exists
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns> False if the file couldn't be opened for writing </returns>
+	bool open(const std::filesystem::path& path);
+
+	/// <summary>
+	/// Creates a new file named prefix plus a suffix no other file has (mkstemp on Unix), so nothing that's already there is ever written over.
+	/// The name that was picked is available from path()
+	/// </summary>
+	/// <param name="prefix"> The start of the name, which decides the directory the file goes in </param>
+	/// <returns> False if the file couldn't be created </returns>
+	bool openUnique(const std::filesystem::path& prefix);
+
+	/// <summary>
+	/// Writes each of the buffers to the file, in order
+	/// </summary>
+	/// <param name="buffers"></param>
+	/// <returns> False if anything couldn't be written </returns>
+	bool write(const std::vector<std::string_view>& buffers);
+
+	/// <summary>
+	/// Copies a range of another open file onto the end of this one without reading it into memory (copy_file_range on Linux).
+	/// Filesystems that support it share the blocks between the files instead of copying them.
+	/// Where the files can't be copied between, the range is written from fallback instead, which has to hold the same bytes
+	/// </summary>
+	/// <param name="source"> A file descriptor, like MappedFile::nativeHandle() </param>
+	/// <param name="offset"> Where the range starts in source </param>
+	/// <param name="fallback"> The contents of the range </param>
+	/// <returns> False if anything couldn't be written </returns>
+	bool copy(const intptr_t source, const uint64_t offset, const std::string_view fallback);
+
+	/// <summary>
+	/// Waits until everything written so far is on the disk (fsync)
+	/// </summary>
+	/// <returns></returns>
+	bool sync();
+
+	/// <summary>
+	/// Closes the file. Safe to call more than once
+	/// </summary>
+	/// <returns> False if closing failed, which can mean earlier writes didn't make it to the file </returns>
+	bool close();
+
+	/// <summary>
+	/// Waits until the entries of a directory are on the disk, so a file that was just created or renamed in it survives a crash
+	/// </summary>
+	/// <param name="directory"></param>
+	/// <returns> False if the directory couldn't be synced </returns>
+	static bool syncDirectory(const std::filesystem::path& directory);
+
+	/// <summary>
+	/// The path the file was opened with
+	/// </summary>
+	/// <returns></returns>
+	const std::filesystem::path& path() const { return mPath; }
+
+	/// <summary>
+	/// The number of bytes written to the file so far
+	/// </summary>
+	/// <returns></returns>
+	const size_t bytesWritten() const { return mBytesWritten; }
+
+	/// <summary>
+	/// How many of the bytes written were copied straight from another file by copy()
+	/// </summary>
+	/// <returns></returns>
+	const size_t bytesCopied() const { return mBytesCopied; }
+
+private:
+	intptr_t mFile = -1; //The file descriptor, or the HANDLE on Windows
+	std::filesystem::path mPath;
+	size_t mBytesWritten = 0;
+	size_t mBytesCopied = 0;
+	bool mCanCopy = true; //Cleared the first time the kernel refuses to copy between the files
+};
@@ -0,0 +1,158 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FileWriter/FileWriter.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <climits> //IOV_MAX
+#include <cerrno>
+#include <algorithm>
+#include <string>
+
+bool FileWriter::open(const std::filesystem::path& path)
+{
+	close();
+	mFile = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	mPath = path;
+	mBytesWritten = 0;
+	mBytesCopied = 0;
+	mCanCopy = true;
+	return mFile != -1;
+}
+
+bool FileWriter::openUnique(const std::filesystem::path& prefix)
+{
+	close();
+	std::string name = prefix.string() + ".XXXXXX";
+	const int file = ::mkostemp(name.data(), O_CLOEXEC);
+	mPath.clear();
+	mBytesWritten = 0;
+	mBytesCopied = 0;
+	mCanCopy = true;
+	if (file == -1) return false;
+
+	::fchmod(file, 0644); //mkstemp only lets the owner read the file, open() would have used 0644
+	mFile = file;
+	mPath = name;
+	return true;
+}
+
+bool FileWriter::write(const std::vector<std::string_view>& buffers)
+{
+	if (mFile == -1) return false;
+
+	constexpr size_t maxBuffersPerWrite = IOV_MAX;
+	std::vector<iovec> iovecs;
+	iovecs.reserve(std::min(buffers.size(), maxBuffersPerWrite));
+
+	size_t next = 0;
+	while (next < buffers.size())
+	{
+		iovecs.clear();
+		for (; next < buffers.size() && iovecs.size() < maxBuffersPerWrite; ++next)
+		{
+			if (buffers[next].empty()) continue;
+			iovecs.push_back(iovec{ const_cast<char*>(buffers[next].data()), buffers[next].length() });
+		}
+
+		//writev can stop part way through, so skip over what was written and go again
+		iovec* remaining = iovecs.data();
+		size_t remainingCount = iovecs.size();
+		while (remainingCount > 0)
+		{
+			const ssize_t written = ::writev(static_cast<int>(mFile), remaining, static_cast<int>(remainingCount));
+			if (written == -1)
+			{
+				if (errno == EINTR) continue;
+				return false;
+			}
+			mBytesWritten += static_cast<size_t>(written);
+
+			size_t left = static_cast<size_t>(written);
+			while (remainingCount > 0 && left >= remaining->iov_len)
+			{
+				left -= remaining->iov_len;
+				++remaining;
+				--remainingCount;
+			}
+			if (remainingCount > 0)
+			{
+				remaining->iov_base = static_cast<char*>(remaining->iov_base) + left;
+				remaining->iov_len -= left;
+			}
+		}
+	}
+	return true;
+}
+
+bool FileWriter::copy(const intptr_t source, const uint64_t offset, const std::string_view fallback)
+{
+	if (mFile == -1) return false;
+
+	size_t copied = 0;
+#ifdef __linux__
+	loff_t sourceOffset = static_cast<loff_t>(offset);
+	while (mCanCopy && source != -1 && copied < fallback.length())
+	{
+		const ssize_t result = ::copy_file_range(static_cast<int>(source), &sourceOffset, static_cast<int>(mFile), nullptr, fallback.length() - copied, 0);
+		if (result == -1 && errno == EINTR) continue;
+		if (result <= 0) //Unsupported between these files (or the source got shorter), so the rest comes from memory
+		{
+			mCanCopy = false;
+			break;
+		}
+		copied += static_cast<size_t>(result);
+		mBytesWritten += static_cast<size_t>(result);
+		mBytesCopied += static_cast<size_t>(result);
+	}
+#endif
+	if (copied == fallback.length()) return true;
+	return write({ fallback.substr(copied) });
+}
+
+bool FileWriter::sync()
+{
+	if (mFile == -1) return false;
+	return ::fsync(static_cast<int>(mFile)) == 0;
+}
+
+bool FileWriter::close()
+{
+	if (mFile == -1) return true;
+	const bool closed = (::close(static_cast<int>(mFile)) == 0);
+	mFile = -1;
+	return closed;
+}
+
+bool FileWriter::syncDirectory(const std::filesystem::path& directory)
+{
+	const int handle = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (handle == -1) return false;
+	const bool synced = (::fsync(handle) == 0);
+	::close(handle);
+	return synced;
+}
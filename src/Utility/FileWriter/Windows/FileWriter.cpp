@@ -0,0 +1,133 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FileWriter/FileWriter.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#define VC_EXTRALEAN
+#include <Windows.h>
+
+#include <string>
+#include <atomic>
+
+static bool writeAll(HANDLE file, const std::string& buffer)
+{
+	size_t offset = 0;
+	while (offset < buffer.length())
+	{
+		DWORD written = 0;
+		const DWORD toWrite = static_cast<DWORD>((std::min)(buffer.length() - offset, size_t(MAXDWORD))); //Parentheses keep the min macro from Windows.h out of the way
+		if (!WriteFile(file, buffer.data() + offset, toWrite, &written, NULL)) return false;
+		offset += written;
+	}
+	return true;
+}
+
+bool FileWriter::open(const std::filesystem::path& path)
+{
+	close();
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	mPath = path;
+	mBytesWritten = 0;
+	mBytesCopied = 0;
+	if (file == INVALID_HANDLE_VALUE) return false;
+	mFile = reinterpret_cast<intptr_t>(file);
+	return true;
+}
+
+bool FileWriter::openUnique(const std::filesystem::path& prefix)
+{
+	close();
+	mPath.clear();
+	mBytesWritten = 0;
+	mBytesCopied = 0;
+
+	//CREATE_NEW fails when the name is taken, so the counter moves on until a free name turns up
+	static std::atomic<uint32_t> counter = GetTickCount();
+	for (int attempt = 0; attempt < 100; ++attempt)
+	{
+		std::filesystem::path path = prefix;
+		path += "." + std::to_string(GetCurrentProcessId()) + "-" + std::to_string(counter++);
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			mFile = reinterpret_cast<intptr_t>(file);
+			mPath = path;
+			return true;
+		}
+		if (GetLastError() != ERROR_FILE_EXISTS) return false;
+	}
+	return false;
+}
+
+bool FileWriter::write(const std::vector<std::string_view>& buffers)
+{
+	if (mFile == -1) return false;
+	HANDLE file = reinterpret_cast<HANDLE>(mFile);
+
+	constexpr size_t bufferSize = 256 * 1024;
+	std::string buffer;
+	buffer.reserve(bufferSize + 2);
+	for (const std::string_view view : buffers)
+	{
+		for (const char c : view)
+		{
+			if (c == '\n') buffer.push_back('\r'); //Files have always been saved with Windows line endings
+			buffer.push_back(c);
+			if (buffer.length() >= bufferSize)
+			{
+				if (!writeAll(file, buffer)) return false;
+				mBytesWritten += buffer.length();
+				buffer.clear();
+			}
+		}
+	}
+	if (!writeAll(file, buffer)) return false;
+	mBytesWritten += buffer.length();
+	return true;
+}
+
+bool FileWriter::copy(const intptr_t source, const uint64_t offset, const std::string_view fallback)
+{
+	return write({ fallback }); //The line endings have to be changed on the way out, so there is nothing to gain from copying between the files
+}
+
+bool FileWriter::sync()
+{
+	if (mFile == -1) return false;
+	return FlushFileBuffers(reinterpret_cast<HANDLE>(mFile)) != 0;
+}
+
+bool FileWriter::close()
+{
+	if (mFile == -1) return true;
+	const bool closed = (CloseHandle(reinterpret_cast<HANDLE>(mFile)) != 0);
+	mFile = -1;
+	return closed;
+}
+
+bool FileWriter::syncDirectory(const std::filesystem::path&)
+{
+	return true; //NTFS journals renames itself, and a directory can't be flushed like a file
+}
@@ -0,0 +1,43 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FrameWriter/FrameWriter.hpp"
+
+std::string& FrameWriter::beginFrame()
+{
+	mBuffer.assign(beginSynchronizedUpdate);
+	return mBuffer;
+}
+
+bool FrameWriter::endFrame()
+{
+	mLastFrame = Stats();
+	if (mBuffer.length() == sizeof(beginSynchronizedUpdate) - 1) return true; //Nothing changed, so there is nothing to send
+
+	mBuffer.append(endSynchronizedUpdate);
+	const bool written = writeAll(mBuffer);
+	mTotal.bytes += mLastFrame.bytes;
+	mTotal.writes += mLastFrame.writes;
+	return written;
+}
@@ -0,0 +1,94 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file FrameWriter.hpp
+* @brief Sends each frame to the terminal in a single write
+*
+* The frame is built in a buffer that is kept between frames, wrapped in synchronized update mode (DEC private mode 2026) so terminals
+* that support it show the whole frame at once instead of tearing part way through, and written straight to the output's file descriptor
+* (the HANDLE on Windows), bypassing std::cout. Terminals that don't know the mode ignore it
+*/
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+class FrameWriter
+{
+public:
+	/// <summary>
+	/// The number of bytes and write calls it took to send frames
+	/// </summary>
+	struct Stats
+	{
+		size_t bytes = 0;
+		size_t writes = 0;
+	};
+
+	/// <summary>
+	/// Writes to standard output
+	/// </summary>
+	FrameWriter();
+
+	/// <summary>
+	/// Clears the buffer for a new frame, and returns it to be filled
+	/// </summary>
+	/// <returns></returns>
+	std::string& beginFrame();
+
+	/// <summary>
+	/// Sends the frame built since beginFrame(). Nothing is written if the frame is empty
+	/// </summary>
+	/// <returns> False if the frame couldn't be written </returns>
+	bool endFrame();
+
+	/// <summary>
+	/// What it took to send the last frame
+	/// </summary>
+	/// <returns></returns>
+	const Stats& lastFrame() const { return mLastFrame; }
+
+	/// <summary>
+	/// What it took to send every frame so far
+	/// </summary>
+	/// <returns></returns>
+	const Stats& total() const { return mTotal; }
+
+private:
+	/// <summary>
+	/// Writes the whole buffer, going again after partial writes and interrupted calls. Implemented per platform, along with the constructor
+	/// </summary>
+	/// <param name="buffer"></param>
+	/// <returns></returns>
+	bool writeAll(const std::string_view buffer);
+
+private:
+	inline static constexpr char beginSynchronizedUpdate[] = "\x1b[?2026h";
+	inline static constexpr char endSynchronizedUpdate[] = "\x1b[?2026l";
+
+	intptr_t mOutput = -1; //The file descriptor, or the HANDLE on Windows
+	std::string mBuffer;
+	Stats mLastFrame, mTotal;
+};
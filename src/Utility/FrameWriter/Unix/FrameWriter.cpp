@@ -0,0 +1,53 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FrameWriter/FrameWriter.hpp"
+
+#include <unistd.h>
+#include <cerrno>
+
+FrameWriter::FrameWriter() : mOutput(STDOUT_FILENO) {}
+
+bool FrameWriter::writeAll(const std::string_view buffer)
+{
+	size_t offset = 0;
+	while (offset < buffer.length())
+	{
+		const ssize_t written = ::write(static_cast<int>(mOutput), buffer.data() + offset, buffer.length() - offset);
+		++mLastFrame.writes;
+		if (written == -1)
+		{
+			if (errno == EINTR) continue; //Interrupted before anything was written, for example by SIGWINCH
+			if (errno == EAGAIN || errno == EWOULDBLOCK) //A terminal that isn't keeping up, wait for it to take more
+			{
+				::usleep(1000);
+				continue;
+			}
+			return false;
+		}
+		offset += static_cast<size_t>(written);
+		mLastFrame.bytes += static_cast<size_t>(written);
+	}
+	return true;
+}
@@ -0,0 +1,50 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/FrameWriter/FrameWriter.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#define VC_EXTRALEAN
+#include <Windows.h>
+
+#include <string_view>
+#include <algorithm>
+
+FrameWriter::FrameWriter() : mOutput(reinterpret_cast<intptr_t>(GetStdHandle(STD_OUTPUT_HANDLE))) {}
+
+bool FrameWriter::writeAll(const std::string_view buffer)
+{
+	HANDLE output = reinterpret_cast<HANDLE>(mOutput);
+	size_t offset = 0;
+	while (offset < buffer.length())
+	{
+		DWORD written = 0;
+		const DWORD toWrite = static_cast<DWORD>((std::min)(buffer.length() - offset, size_t(MAXDWORD))); //Parentheses keep the min macro from Windows.h out of the way
+		++mLastFrame.writes;
+		if (!WriteFile(output, buffer.data() + offset, toWrite, &written, NULL)) return false;
+		offset += written;
+		mLastFrame.bytes += written;
+	}
+	return true;
+}
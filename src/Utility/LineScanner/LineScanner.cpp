@@ -0,0 +1,195 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/LineScanner/LineScanner.hpp"
+
+#include <bit> //std::countr_zero
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LINE_SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+namespace LineScanner
+{
+	/// <summary>
+	/// Scans str[startPos, end) one character at a time. Also used for the tail the vector loops can't fill a whole block with
+	/// </summary>
+	/// <returns> True if a "\r\n" was found </returns>
+	static bool scalarFindLineBreaks(const std::string_view str, const size_t startPos, const size_t base, std::vector<size_t>& lineBreaks)
+	{
+		bool foundCarriageReturn = false;
+		size_t findPos = startPos;
+		while ((findPos = str.find('\n', findPos)) != std::string_view::npos)
+		{
+			foundCarriageReturn |= (findPos > 0 && str[findPos - 1] == '\r');
+			lineBreaks.push_back(base + findPos);
+			++findPos;
+		}
+		return foundCarriageReturn;
+	}
+
+	/// <summary>
+	/// Turns a mask of matching bytes in the block starting at blockPos into line-break positions
+	/// </summary>
+	static inline void addMatches(uint32_t mask, const size_t blockPos, std::vector<size_t>& lineBreaks)
+	{
+		while (mask != 0)
+		{
+			lineBreaks.push_back(blockPos + std::countr_zero(mask));
+			mask &= mask - 1; //Clear the lowest set bit
+		}
+	}
+
+#ifdef LINE_SCANNER_X86
+	TARGET_SSE2 static bool sse2FindLineBreaks(const std::string_view str, const size_t base, std::vector<size_t>& lineBreaks)
+	{
+		constexpr size_t blockSize = 16;
+		const __m128i newLine = _mm_set1_epi8('\n');
+		const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+		bool foundCarriageReturn = false;
+		size_t pos = 0;
+		for (; pos + blockSize <= str.length(); pos += blockSize)
+		{
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+			const uint32_t newLineMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newLine)));
+			foundCarriageReturn |= (_mm_movemask_epi8(_mm_cmpeq_epi8(block, carriageReturn)) != 0);
+			addMatches(newLineMask, base + pos, lineBreaks);
+		}
+		foundCarriageReturn |= scalarFindLineBreaks(str, pos, base, lineBreaks);
+
+		//A lone '\r' is rare, so only go looking for an actual "\r\n" when one was seen
+		return foundCarriageReturn && str.find("\r\n") != std::string_view::npos;
+	}
+
+	TARGET_AVX2 static bool avx2FindLineBreaks(const std::string_view str, const size_t base, std::vector<size_t>& lineBreaks)
+	{
+		constexpr size_t blockSize = 32;
+		const __m256i newLine = _mm256_set1_epi8('\n');
+		const __m256i carriageReturn = _mm256_set1_epi8('\r');
+
+		bool foundCarriageReturn = false;
+		size_t pos = 0;
+		for (; pos + blockSize <= str.length(); pos += blockSize)
+		{
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos));
+			const uint32_t newLineMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newLine)));
+			foundCarriageReturn |= (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, carriageReturn)) != 0);
+			addMatches(newLineMask, base + pos, lineBreaks);
+		}
+		foundCarriageReturn |= scalarFindLineBreaks(str, pos, base, lineBreaks);
+
+		return foundCarriageReturn && str.find("\r\n") != std::string_view::npos;
+	}
+
+#ifdef _MSC_VER
+	static bool cpuHasSSE2()
+	{
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+	}
+
+	static bool cpuHasAVX2()
+	{
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		__cpuid(info, 1);
+		const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6; //OSXSAVE, and the OS saves the AVX registers
+		if (!osSavesYmm) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}
+#else
+	static bool cpuHasSSE2() { return __builtin_cpu_supports("sse2"); }
+	static bool cpuHasAVX2() { return __builtin_cpu_supports("avx2"); }
+#endif
+#endif
+
+	const bool isSupported(const Implementation implementation)
+	{
+		switch (implementation)
+		{
+#ifdef LINE_SCANNER_X86
+		case Implementation::SSE2:
+		{
+			static const bool supported = cpuHasSSE2();
+			return supported;
+		}
+		case Implementation::AVX2:
+		{
+			static const bool supported = cpuHasAVX2();
+			return supported;
+		}
+#endif
+		case Implementation::Scalar:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	Implementation bestImplementation()
+	{
+		static const Implementation best = isSupported(Implementation::AVX2) ? Implementation::AVX2
+			: isSupported(Implementation::SSE2) ? Implementation::SSE2
+			: Implementation::Scalar;
+		return best;
+	}
+
+	bool findLineBreaks(const std::string_view str, const size_t base, std::vector<size_t>& lineBreaks)
+	{
+		return findLineBreaks(str, base, lineBreaks, bestImplementation());
+	}
+
+	bool findLineBreaks(const std::string_view str, const size_t base, std::vector<size_t>& lineBreaks, const Implementation implementation)
+	{
+		switch (implementation)
+		{
+#ifdef LINE_SCANNER_X86
+		case Implementation::AVX2:
+			return avx2FindLineBreaks(str, base, lineBreaks);
+		case Implementation::SSE2:
+			return sse2FindLineBreaks(str, base, lineBreaks);
+#endif
+		default:
+			return scalarFindLineBreaks(str, 0, base, lineBreaks);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file LineScanner.hpp
+* @brief Provides a vectorized scanner that builds the line-break index of a block of text
+*
+* The scanner compares 16 (SSE2) or 32 (AVX2) bytes at a time against '\n' and '\r', and turns each match mask
+* straight into line-break positions. The fastest implementation the CPU supports is picked the first time the scanner runs.
+* Anything that isn't x86 uses the scalar loop
+*/
+#pragma once
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace LineScanner
+{
+	/// <summary>
+	/// The ways the scanner can look for line breaks
+	/// </summary>
+	enum class Implementation : uint8_t
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	/// <summary>
+	/// The fastest implementation this CPU supports. Checked once, then cached
+	/// </summary>
+	/// <returns></returns>
+	Implementation bestImplementation();
+
+	/// <summary>
+	/// Whether this CPU can run the given implementation
+	/// </summary>
+	/// <param name="implementation"></param>
+	/// <returns></returns>
+	const bool isSupported(const Implementation implementation);
+
+	/// <summary>
+	/// Appends the position of every '\n' in str, offset by base, to lineBreaks in a single pass
+	/// </summary>
+	/// <param name="str"></param>
+	/// <param name="base"></param>
+	/// <param name="lineBreaks"></param>
+	/// <returns> True if str contains a "\r\n" line ending </returns>
+	bool findLineBreaks(const std::string_view str, const size_t base, std::vector<size_t>& lineBreaks);
+
+	/// <summary>
+	/// findLineBreaks, using a specific implementation. Used for testing and benchmarking.
+	/// The implementation must be supported by this CPU
+	/// </summary>
+	bool findLineBreaks(const std::string_view str, const size_t base, std::vector<size_t>& lineBreaks, const Implementation implementation);
+}
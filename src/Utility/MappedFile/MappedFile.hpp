@@ -0,0 +1,127 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file MappedFile.hpp
+* @brief Provides a read-only memory mapping of a whole file
+*
+* The mapped pages are only read in when they are first touched, so a large file can be opened without copying it onto the heap.
+* The mapping is private and read-only. If another program truncates the file while it is mapped, reading the missing pages will crash,
+* which is why the file handler never writes over a file in place while it is mapped, and copies out what is left of it (see fileLength())
+* as soon as another program writes over it.
+*/
+#pragma once
+#include <filesystem>
+#include <string_view>
+#include <utility> //std::exchange
+#include <cstdint>
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept : mData(std::exchange(other.mData, nullptr)), mLength(std::exchange(other.mLength, 0)), mFile(std::exchange(other.mFile, -1)) {}
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			mData = std::exchange(other.mData, nullptr);
+			mLength = std::exchange(other.mLength, 0);
+			mFile = std::exchange(other.mFile, -1);
+		}
+		return *this;
+	}
+
+	/// <summary>
+	/// Maps the whole file into memory, read-only
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns> False if the file couldn't be mapped (it doesn't exist, is empty, or isn't a regular file) </returns>
+	bool open(const std::filesystem::path& path);
+
+	/// <summary>
+	/// Unmaps the file. Any view returned before this is no longer valid
+	/// </summary>
+	void close();
+
+	const bool isOpen() const { return mData != nullptr; }
+
+	/// <summary>
+	/// How part of the mapping is about to be used.
+	/// WillNeed starts reading the pages in ahead of time, DontNeed lets the pages be dropped from memory. They are read back in if touched again
+	/// </summary>
+	enum class Advice
+	{
+		WillNeed,
+		DontNeed
+	};
+
+	/// <summary>
+	/// Tells the OS how part of the mapping is about to be used. Only a hint, so it never changes what the mapping reads as
+	/// </summary>
+	/// <param name="offset"></param>
+	/// <param name="length"></param>
+	/// <param name="advice"></param>
+	void advise(const size_t offset, const size_t length, const Advice advice) const;
+
+	/// <summary>
+	/// The contents of the file. Only valid while the file is mapped
+	/// </summary>
+	/// <returns></returns>
+	const std::string_view view() const { return std::string_view(mData, mLength); }
+
+	/// <summary>
+	/// How much of the mapping can still be read. Less than view().length() if the file has been truncated since it was mapped,
+	/// and reading the mapping past it would crash
+	/// </summary>
+	/// <returns></returns>
+	const size_t fileLength() const;
+
+	/// <summary>
+	/// The file that is mapped, kept open so ranges of it can be copied straight into another file (see FileWriter::copy).
+	/// This is still the file that was mapped after it has been renamed over or removed.
+	/// -1 on Windows, where the file is closed once it has been mapped
+	/// </summary>
+	/// <returns></returns>
+	const intptr_t nativeHandle() const { return mFile; }
+
+	/// <summary>
+	/// Whether path still names the file that is mapped, rather than a file that has replaced it.
+	/// If it does and the file has been written to, the mapping shows the new contents. Always true on Windows, where it can't be told apart
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns></returns>
+	const bool refersTo(const std::filesystem::path& path) const;
+
+private:
+	const char* mData = nullptr;
+	size_t mLength = 0;
+	intptr_t mFile = -1;
+};
@@ -0,0 +1,97 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/MappedFile/MappedFile.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+	close();
+
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) return false;
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) == -1 || !S_ISREG(fileInfo.st_mode) || fileInfo.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		::close(fd);
+		return false;
+	}
+
+	madvise(data, fileInfo.st_size, MADV_SEQUENTIAL); //The first thing done with the mapping is a front-to-back scan for line breaks
+
+	mData = static_cast<const char*>(data);
+	mLength = static_cast<size_t>(fileInfo.st_size);
+	mFile = fd; //Kept open so saving can copy unchanged ranges straight out of the file
+	return true;
+}
+
+void MappedFile::advise(const size_t offset, const size_t length, const Advice advice) const
+{
+	if (mData == nullptr || offset >= mLength) return;
+
+	//madvise needs a page-aligned address, so round the start down to the page it is in
+	static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t start = offset - (offset % pageSize);
+	const size_t end = std::min(offset + length, mLength);
+	madvise(const_cast<char*>(mData) + start, end - start, (advice == Advice::WillNeed) ? MADV_WILLNEED : MADV_DONTNEED);
+}
+
+const bool MappedFile::refersTo(const std::filesystem::path& path) const
+{
+	if (mFile == -1) return false;
+	struct stat mappedInfo, pathInfo;
+	if (fstat(static_cast<int>(mFile), &mappedInfo) == -1 || stat(path.c_str(), &pathInfo) == -1) return false;
+	return mappedInfo.st_dev == pathInfo.st_dev && mappedInfo.st_ino == pathInfo.st_ino;
+}
+
+const size_t MappedFile::fileLength() const
+{
+	struct stat fileInfo;
+	if (mFile == -1 || fstat(static_cast<int>(mFile), &fileInfo) == -1) return 0;
+	return std::min(static_cast<size_t>(fileInfo.st_size), mLength);
+}
+
+void MappedFile::close()
+{
+	if (mData == nullptr) return;
+	munmap(const_cast<char*>(mData), mLength);
+	::close(static_cast<int>(mFile));
+	mData = nullptr;
+	mLength = 0;
+	mFile = -1;
+}
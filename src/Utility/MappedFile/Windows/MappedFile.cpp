@@ -0,0 +1,93 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/MappedFile/MappedFile.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#define VC_EXTRALEAN
+#include <Windows.h>
+
+#include <algorithm>
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+	close();
+
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file); //The mapping keeps its own reference to the file
+	if (mapping == NULL) return false;
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping); //The view keeps its own reference to the mapping
+	if (data == NULL) return false;
+
+	mData = static_cast<const char*>(data);
+	mLength = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::advise(const size_t offset, const size_t length, const Advice advice) const
+{
+	if (mData == nullptr || offset >= mLength) return;
+
+	const size_t end = (std::min)(offset + length, mLength); //Parentheses keep the min macro from Windows.h out of the way
+	void* start = const_cast<char*>(mData) + offset;
+	if (advice == Advice::WillNeed)
+	{
+		WIN32_MEMORY_RANGE_ENTRY range{ start, end - offset };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+	else
+	{
+		VirtualUnlock(start, end - offset); //Unlocking pages that aren't locked removes them from the working set
+	}
+}
+
+const bool MappedFile::refersTo(const std::filesystem::path& path) const
+{
+	return mData != nullptr; //The file isn't kept open, so assume the worst
+}
+
+const size_t MappedFile::fileLength() const
+{
+	return mLength; //Windows won't let a mapped file be truncated
+}
+
+void MappedFile::close()
+{
+	if (mData == nullptr) return;
+	UnmapViewOfFile(mData);
+	mData = nullptr;
+	mLength = 0;
+}
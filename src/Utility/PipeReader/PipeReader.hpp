@@ -0,0 +1,88 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+* @file PipeReader.hpp
+* @brief Reads another program's output, sent to mini through a pipe (cmd | mini -)
+*
+* takeStandardInput() moves the pipe off of stdin, and points stdin back at the terminal so keys can still be read from it.
+* Reads wait a short time at most, so the thread reading the pipe can be stopped while the other program is quiet
+*/
+#pragma once
+#include <utility> //std::exchange
+#include <cstdint>
+#include <cstddef>
+
+class PipeReader
+{
+public:
+	PipeReader() = default;
+	~PipeReader() { close(); }
+
+	PipeReader(const PipeReader&) = delete;
+	PipeReader& operator=(const PipeReader&) = delete;
+	PipeReader(PipeReader&& other) noexcept : mPipe(std::exchange(other.mPipe, -1)) {}
+	PipeReader& operator=(PipeReader&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			mPipe = std::exchange(other.mPipe, -1);
+		}
+		return *this;
+	}
+
+	/// <summary>
+	/// If stdin is a pipe rather than the terminal, gives the pipe its own handle and reopens stdin on the terminal
+	/// </summary>
+	/// <returns> The pipe's handle, or -1 if nothing is being piped in </returns>
+	static intptr_t takeStandardInput();
+
+	/// <summary>
+	/// Takes ownership of the read end of a pipe
+	/// </summary>
+	/// <param name="pipe"> A file descriptor, or a HANDLE on Windows </param>
+	/// <returns> False if pipe isn't valid </returns>
+	bool open(const intptr_t pipe);
+
+	/// <summary>
+	/// Reads whatever has arrived, up to size bytes. Waits up to waitTime for something to arrive if nothing has
+	/// </summary>
+	/// <param name="buffer"></param>
+	/// <param name="size"></param>
+	/// <returns> The number of bytes read, 0 once the other end is closed and everything has been read, or -1 if nothing arrived in time </returns>
+	int64_t read(char* buffer, const size_t size);
+
+	/// <summary>
+	/// Closes the pipe. Safe to call more than once
+	/// </summary>
+	void close();
+
+	const bool isOpen() const { return mPipe != -1; }
+
+	inline static constexpr int waitTime = 100; //Milliseconds
+
+private:
+	intptr_t mPipe = -1;
+};
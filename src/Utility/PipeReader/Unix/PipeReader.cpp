@@ -0,0 +1,71 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/PipeReader/PipeReader.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+
+intptr_t PipeReader::takeStandardInput()
+{
+	if (isatty(STDIN_FILENO)) return -1;
+
+	const int tty = ::open("/dev/tty", O_RDONLY | O_CLOEXEC);
+	if (tty == -1) return -1; //No terminal to read keys from
+	const int pipe = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0);
+	dup2(tty, STDIN_FILENO);
+	::close(tty);
+	return pipe;
+}
+
+bool PipeReader::open(const intptr_t pipe)
+{
+	close();
+	if (pipe < 0) return false;
+	mPipe = pipe;
+	return true;
+}
+
+int64_t PipeReader::read(char* buffer, const size_t size)
+{
+	if (mPipe == -1) return 0;
+
+	pollfd ready{ static_cast<int>(mPipe), POLLIN, 0 };
+	const int result = poll(&ready, 1, waitTime);
+	if (result == 0 || (result == -1 && errno == EINTR)) return -1;
+	if (result == -1) return 0;
+
+	const ssize_t length = ::read(static_cast<int>(mPipe), buffer, size);
+	if (length == -1) return (errno == EINTR || errno == EAGAIN) ? -1 : 0;
+	return length;
+}
+
+void PipeReader::close()
+{
+	if (mPipe == -1) return;
+	::close(static_cast<int>(mPipe));
+	mPipe = -1;
+}
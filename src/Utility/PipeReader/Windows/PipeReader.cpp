@@ -0,0 +1,80 @@
+/**
+* MIT License
+
+Copyright (c) 2025 Nathan Davis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Utility/PipeReader/PipeReader.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#define VC_EXTRALEAN
+#include <Windows.h>
+
+#include <thread>
+#include <chrono>
+
+intptr_t PipeReader::takeStandardInput()
+{
+	//Keys are read from the console itself by _getch, so stdin doesn't need pointing anywhere else
+	const HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+	if (input == INVALID_HANDLE_VALUE || input == nullptr || GetFileType(input) == FILE_TYPE_CHAR) return -1;
+
+	HANDLE pipe;
+	if (!DuplicateHandle(GetCurrentProcess(), input, GetCurrentProcess(), &pipe, 0, FALSE, DUPLICATE_SAME_ACCESS)) return -1;
+	return reinterpret_cast<intptr_t>(pipe);
+}
+
+bool PipeReader::open(const intptr_t pipe)
+{
+	close();
+	if (pipe == -1 || pipe == 0) return false;
+	mPipe = pipe;
+	return true;
+}
+
+int64_t PipeReader::read(char* buffer, const size_t size)
+{
+	if (mPipe == -1) return 0;
+
+	const HANDLE pipe = reinterpret_cast<HANDLE>(mPipe);
+	DWORD available = 0;
+	if (GetFileType(pipe) == FILE_TYPE_PIPE)
+	{
+		if (!PeekNamedPipe(pipe, nullptr, 0, nullptr, &available, nullptr)) return 0; //The other end was closed
+		if (available == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(waitTime));
+			return -1;
+		}
+	}
+
+	DWORD length = 0;
+	const DWORD toRead = static_cast<DWORD>((available > 0 && available < size) ? available : size);
+	if (!ReadFile(pipe, buffer, toRead, &length, nullptr)) return 0;
+	return length;
+}
+
+void PipeReader::close()
+{
+	if (mPipe == -1) return;
+	CloseHandle(reinterpret_cast<HANDLE>(mPipe));
+	mPipe = -1;
+}
@@ -29,6 +29,7 @@ SOFTWARE.
 #include "File/File.hpp"
 #include "Console/Console.hpp"
 #include "Renderer/Renderer.hpp"
+#include "Utility/PipeReader/PipeReader.hpp"
 
 #include <iostream>
 #include <string_view>
@@ -41,13 +42,27 @@ int main(int argc, const char** argv)
 	argc = 2;
 	argv[1] = "test.cpp";
 #endif
-	if (argc != 2)
+	//mini --view <filename> opens the file read-only, paging through it instead of loading all of it.
+	//mini --follow <filename> opens it read-only and keeps adding whatever gets written to the end of it.
+	//mini --no-index-cache <filename> doesn't read or write the line index cache kept next to large files.
+	//cmd | mini - reads cmd's output as it arrives, the same way
+	bool viewOnly = false, follow = false, useIndexCache = true;
+	int arg = 1;
+	for (; arg < argc - 1; ++arg)
 	{
-		std::cerr << "ERROR: Usage: mini <filename>\n";
+		const std::string_view option = argv[arg];
+		if (option == "--view") viewOnly = true;
+		else if (option == "--follow") follow = true;
+		else if (option == "--no-index-cache") useIndexCache = false;
+		else break;
+	}
+	if (argc < 2 || arg != argc - 1 || (viewOnly && follow))
+	{
+		std::cerr << "ERROR: Usage: mini [--view | --follow] [--no-index-cache] <filename>, or cmd | mini -\n";
 		return EXIT_FAILURE;
 	}
 
-	std::string_view fName = argv[1];
+	std::string_view fName = argv[argc - 1];
 	std::string_view extension;
 	size_t extensionIndex;
 	if ((extensionIndex = fName.find_last_of('.')) != std::string_view::npos)
@@ -58,10 +73,22 @@ int main(int argc, const char** argv)
 	{
 		extension = std::string_view();
 	}
-	Editor editor(SyntaxHighlight(extension), FileHandler(fName), std::make_unique<Console>(Console()));
+	FileHandler::OpenMode openMode = FileHandler::OpenMode::Edit;
+	if (viewOnly) openMode = FileHandler::OpenMode::View;
+	else if (follow) openMode = FileHandler::OpenMode::Follow;
+
+	PipeReader pipe;
+	const bool fromPipe = (fName == "-");
+	if (fromPipe && !pipe.open(PipeReader::takeStandardInput()))
+	{
+		std::cerr << "ERROR: mini - reads another program's output, so it needs something piped to it and a terminal to run in\n";
+		return EXIT_FAILURE;
+	}
+	FileHandler file = fromPipe ? FileHandler(std::move(pipe)) : FileHandler(fName, openMode, useIndexCache);
+	Editor editor(SyntaxHighlight(extension), std::move(file), std::make_unique<Console>(Console()));
 
 	std::atomic<bool> running = true;
-	EventHandler evtHandler(running, &editor);
+	EventHandler evtHandler(running);
 
 	while (true)
 	{
@@ -73,7 +100,12 @@ int main(int argc, const char** argv)
 		}
 		else
 		{
-			editor.refreshScreen();
+			if (evtHandler.windowResized())
+			{
+				editor.updateWindowSize();
+				editor.refreshScreen(true);
+			}
+			else editor.refreshScreen();
 			const KeyActions::KeyAction inputCode = InputHandler::getInput();
 			if (inputCode != KeyActions::KeyAction::None)
 			{
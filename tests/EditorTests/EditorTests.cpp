@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
 
 #include "Editor/Editor.hpp"
 #include "MockConsole.hpp"
@@ -57,11 +62,11 @@ TEST(EditorTests, FileBecomesNotDirtyAfterSave)
 TEST(EditorTests, insertRowAddsNewRow)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeRowAddition = *editor.getWindowForTesting().fileRows;
+	const std::string beforeRowAddition = editor.getWindowForTesting().document->text();
 
 	editor.addRow();
 
-	const std::vector<FileHandler::Row> afterRowAddition = *editor.getWindowForTesting().fileRows;
+	const std::string afterRowAddition = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeRowAddition, afterRowAddition) << "Adding row should change the output";
 }
@@ -69,15 +74,15 @@ TEST(EditorTests, insertRowAddsNewRow)
 TEST(EditorTests, UndoRemovesInsertedCharAsExpected)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeChange = *editor.getWindowForTesting().fileRows;
+	const std::string beforeChange = editor.getWindowForTesting().document->text();
 
 	editor.insertChar('x');
 
-	const std::vector<FileHandler::Row> afterInsert = *editor.getWindowForTesting().fileRows;
+	const std::string afterInsert = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
 
-	const std::vector<FileHandler::Row> afterUndo = *editor.getWindowForTesting().fileRows;
+	const std::string afterUndo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterInsert);
 	EXPECT_NE(afterInsert, afterUndo);
@@ -87,19 +92,19 @@ TEST(EditorTests, UndoRemovesInsertedCharAsExpected)
 TEST(EditorTests, RedoReinsertsCharAsExpected)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeChange = *editor.getWindowForTesting().fileRows;
+	const std::string beforeChange = editor.getWindowForTesting().document->text();
 
 	editor.insertChar('x');
 
-	const std::vector<FileHandler::Row> afterInsert = *editor.getWindowForTesting().fileRows;
+	const std::string afterInsert = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
 
-	const std::vector<FileHandler::Row> afterUndo = *editor.getWindowForTesting().fileRows;
+	const std::string afterUndo = editor.getWindowForTesting().document->text();
 
 	editor.redoChange();
 	
-	const std::vector<FileHandler::Row> afterRedo = *editor.getWindowForTesting().fileRows;
+	const std::string afterRedo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterInsert);
 	EXPECT_NE(afterInsert, afterUndo);
@@ -111,15 +116,15 @@ TEST(EditorTests, RedoReinsertsCharAsExpected)
 TEST(EditorTests, UndoRemovesInsertedRowAsExpected)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeChange = *editor.getWindowForTesting().fileRows;
+	const std::string beforeChange = editor.getWindowForTesting().document->text();
 
 	editor.addRow();
 
-	const std::vector<FileHandler::Row> afterInsert = *editor.getWindowForTesting().fileRows;
+	const std::string afterInsert = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
 
-	const std::vector<FileHandler::Row> afterUndo = *editor.getWindowForTesting().fileRows;
+	const std::string afterUndo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterInsert);
 	EXPECT_NE(afterInsert, afterUndo);
@@ -129,19 +134,19 @@ TEST(EditorTests, UndoRemovesInsertedRowAsExpected)
 TEST(EditorTests, RedoReinsertsRowAsExpected)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeChange = *editor.getWindowForTesting().fileRows;
+	const std::string beforeChange = editor.getWindowForTesting().document->text();
 
 	editor.addRow();
 
-	const std::vector<FileHandler::Row> afterInsert = *editor.getWindowForTesting().fileRows;
+	const std::string afterInsert = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
 
-	const std::vector<FileHandler::Row> afterUndo = *editor.getWindowForTesting().fileRows;
+	const std::string afterUndo = editor.getWindowForTesting().document->text();
 
 	editor.redoChange();
 	
-	const std::vector<FileHandler::Row> afterRedo = *editor.getWindowForTesting().fileRows;
+	const std::string afterRedo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterInsert);
 	EXPECT_NE(afterInsert, afterUndo);
@@ -153,14 +158,14 @@ TEST(EditorTests, RedoReinsertsRowAsExpected)
 TEST(EditorTests, UndoReinsertsDeletedRowAsExpected)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeChange = *editor.getWindowForTesting().fileRows;
+	const std::string beforeChange = editor.getWindowForTesting().document->text();
 
 	editor.moveCursor(KeyActions::KeyAction::ArrowDown);
 	editor.deleteChar(KeyActions::KeyAction::Backspace);
-	std::vector<FileHandler::Row> afterDelete = *editor.getWindowForTesting().fileRows;
+	std::string afterDelete = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
-	std::vector<FileHandler::Row> afterUndo = *editor.getWindowForTesting().fileRows;
+	std::string afterUndo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterDelete);
 	EXPECT_NE(afterDelete, afterUndo);
@@ -172,10 +177,10 @@ TEST(EditorTests, UndoReinsertsDeletedRowAsExpected)
 	editor.moveCursor(KeyActions::KeyAction::ArrowLeft);
 	editor.deleteChar(KeyActions::KeyAction::Delete);
 
-	afterDelete = *editor.getWindowForTesting().fileRows;
+	afterDelete = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
-	afterUndo = *editor.getWindowForTesting().fileRows;
+	afterUndo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterDelete);
 	EXPECT_NE(afterDelete, afterUndo);
@@ -185,17 +190,17 @@ TEST(EditorTests, UndoReinsertsDeletedRowAsExpected)
 TEST(EditorTests, RedoRemovesDeletedRowAsExpected)
 {
 	Editor editor(SyntaxHighlight(".txt"), FileHandler("testFile.txt"), std::make_unique<MockConsole>(MockConsole()));
-	const std::vector<FileHandler::Row> beforeChange = *editor.getWindowForTesting().fileRows;
+	const std::string beforeChange = editor.getWindowForTesting().document->text();
 
 	editor.moveCursor(KeyActions::KeyAction::ArrowDown);
 	editor.deleteChar(KeyActions::KeyAction::Backspace);
-	std::vector<FileHandler::Row> afterDelete = *editor.getWindowForTesting().fileRows;
+	std::string afterDelete = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
-	std::vector<FileHandler::Row> afterUndo = *editor.getWindowForTesting().fileRows;
+	std::string afterUndo = editor.getWindowForTesting().document->text();
 
 	editor.redoChange();
-	std::vector<FileHandler::Row> afterRedo = *editor.getWindowForTesting().fileRows;
+	std::string afterRedo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterDelete);
 	EXPECT_NE(afterDelete, afterUndo);
@@ -209,13 +214,13 @@ TEST(EditorTests, RedoRemovesDeletedRowAsExpected)
 	editor.moveCursor(KeyActions::KeyAction::ArrowLeft);
 	editor.deleteChar(KeyActions::KeyAction::Delete);
 
-	afterDelete = *editor.getWindowForTesting().fileRows;
+	afterDelete = editor.getWindowForTesting().document->text();
 
 	editor.undoChange();
-	afterUndo = *editor.getWindowForTesting().fileRows;
+	afterUndo = editor.getWindowForTesting().document->text();
 
 	editor.redoChange();
-	afterRedo = *editor.getWindowForTesting().fileRows;
+	afterRedo = editor.getWindowForTesting().document->text();
 
 	EXPECT_NE(beforeChange, afterDelete);
 	EXPECT_NE(afterDelete, afterUndo);
@@ -264,4 +269,369 @@ TEST(EditorTests, MoveCursorToFindWorks)
 
 	EXPECT_EQ(fileCursorYFind, 2);
 	EXPECT_EQ(fileCursorXFind, 1);
-}
\ No newline at end of file
+}
+TEST(EditorTests, TypingOnLongRowsDoesntDependOnRowLength)
+{
+	auto timeTyping = [](const size_t rowLength, const bool atEnd)
+		{
+			const std::string fileName = "longRow.json";
+			{
+				std::ofstream file(fileName, std::ios::binary);
+				file << std::string(rowLength, 'x') << "\nshort row\n";
+			}
+
+			std::chrono::microseconds elapsed;
+			{
+				Editor editor(SyntaxHighlight(".json"), FileHandler(fileName), std::make_unique<MockConsole>(MockConsole()));
+				editor.enableEditMode();
+				if (atEnd) editor.moveCursor(KeyActions::KeyAction::End);
+
+				testing::internal::CaptureStdout();
+				const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < 100; ++i)
+				{
+					editor.insertChar('a');
+					editor.refreshScreen();
+				}
+				for (size_t i = 0; i < 50; ++i)
+				{
+					editor.deleteChar(KeyActions::KeyAction::Backspace);
+					editor.refreshScreen();
+				}
+				const std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+				const std::string output = testing::internal::GetCapturedStdout();
+				elapsed = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+				EXPECT_EQ(editor.getWindowForTesting().document->lineLength(0), rowLength + 50);
+				if (atEnd) EXPECT_NE(output.find("xxa\x1b[K"), std::string::npos) << "The end of the row should be on screen";
+			}
+			std::filesystem::remove(fileName);
+			return elapsed;
+		};
+
+	//The best of a few runs, so a busy machine doesn't decide the result
+	for (const bool atEnd : { false, true })
+	{
+		const auto shortTime = (std::min)({ timeTyping(1000, atEnd), timeTyping(1000, atEnd), timeTyping(1000, atEnd) });
+		const auto longTime = (std::min)({ timeTyping(8 * 1024 * 1024, atEnd), timeTyping(8 * 1024 * 1024, atEnd), timeTyping(8 * 1024 * 1024, atEnd) });
+		std::cout << "[ BENCHMARK ] 150 keystrokes with a redraw each at the " << (atEnd ? "end" : "start") << " of the row: 1KB row " << shortTime.count()
+			<< "us, 8MB row " << longTime.count() << "us\n";
+
+		EXPECT_LT(longTime.count(), (shortTime.count() + 1000) * 5);
+	}
+}
+
+TEST(EditorTests, ViewModeScrollsThroughWholeFile)
+{
+	{
+		std::ofstream file("viewEditorTestFile.txt", std::ios::binary);
+		for (size_t i = 0; i < 20'000; ++i) file << "row " << i << '\n';
+	}
+
+	Editor editor(SyntaxHighlight(".txt"), FileHandler("viewEditorTestFile.txt", FileHandler::OpenMode::View), std::make_unique<MockConsole>(MockConsole()));
+	editor.enableEditMode();
+	EXPECT_EQ(editor.mode(), Editor::Mode::ReadMode) << "View mode is read-only";
+
+	testing::internal::CaptureStdout();
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		editor.shiftRowOffset(KeyActions::KeyAction::PageDown);
+		editor.refreshScreen();
+	}
+	editor.moveCursor(KeyActions::KeyAction::CtrlEnd);
+	editor.refreshScreen();
+	const auto endWindow = editor.getWindowForTesting();
+	const std::string endRow = endWindow.document->line(endWindow.fileCursorY);
+	const std::string rowBeforeEnd = endWindow.document->line(endWindow.fileCursorY - 1);
+	editor.moveCursor(KeyActions::KeyAction::CtrlHome);
+	editor.refreshScreen();
+	const auto startWindow = editor.getWindowForTesting();
+	testing::internal::GetCapturedStdout();
+
+	EXPECT_EQ(endRow, "") << "The cursor should be on the empty row after the last line break";
+	EXPECT_EQ(rowBeforeEnd, "row 19999");
+	EXPECT_EQ(startWindow.fileCursorY, 0);
+	EXPECT_EQ(startWindow.document->line(0), "row 0");
+
+	std::filesystem::remove("viewEditorTestFile.txt");
+}
+
+TEST(EditorTests, EditingWhileSavingKeepsFileDirty)
+{
+	{
+		std::ofstream file("backgroundSaveTestFile.txt", std::ios::binary);
+		file << "first\nsecond";
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("backgroundSaveTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+		editor.insertChar('a');
+		editor.save();
+		editor.insertChar('b'); //Typed before the save has been collected
+		EXPECT_TRUE(editor.isDirty()) << "Only the version that was written should count as saved";
+
+		editor.save();
+		EXPECT_FALSE(editor.isDirty());
+	}
+
+	std::stringstream contents;
+	std::ifstream savedFile("backgroundSaveTestFile.txt", std::ios::binary);
+	contents << savedFile.rdbuf();
+	savedFile.close();
+	EXPECT_EQ(contents.str(), "abfirst\nsecond");
+	std::filesystem::remove("backgroundSaveTestFile.txt");
+}
+
+TEST(EditorTests, RecoveredEditsMakeFileDirty)
+{
+	{
+		std::ofstream file("recoveredEditorTestFile.txt", std::ios::binary);
+		file << "text";
+	}
+	{
+		//The journal a session that died after typing "ab" would leave behind
+		const EditJournal::FileIdentity identity = EditJournal::identify("recoveredEditorTestFile.txt");
+		std::ofstream journal("recoveredEditorTestFile.txt.mini-journal", std::ios::binary);
+		journal << "mini-journal 1 " << identity.size << ' ' << identity.modified << "\ni 0 0 1\na" << "i 0 1 1\nb";
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("recoveredEditorTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+		EXPECT_TRUE(editor.isDirty());
+		EXPECT_EQ(editor.getWindowForTesting().document->line(0), "abtext");
+	}
+	EXPECT_FALSE(std::filesystem::exists("recoveredEditorTestFile.txt.mini-journal"));
+	std::filesystem::remove("recoveredEditorTestFile.txt");
+}
+
+TEST(EditorTests, StaleJournalIsReported)
+{
+	{
+		std::ofstream file("staleEditorTestFile.txt", std::ios::binary);
+		file << "text";
+	}
+	{
+		//Recorded against a version of the file that has since been changed by another program
+		std::ofstream journal("staleEditorTestFile.txt.mini-journal", std::ios::binary);
+		journal << "mini-journal 1 3 0\ni 0 0 1\na";
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("staleEditorTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+		EXPECT_FALSE(editor.isDirty());
+		EXPECT_EQ(editor.getWindowForTesting().document->line(0), "text");
+
+		testing::internal::CaptureStdout();
+		editor.refreshScreen();
+		EXPECT_NE(testing::internal::GetCapturedStdout().find("couldn't replay unsaved edits from last session"), std::string::npos);
+	}
+	EXPECT_TRUE(std::filesystem::exists("staleEditorTestFile.txt.mini-journal.stale"));
+	std::filesystem::remove("staleEditorTestFile.txt.mini-journal.stale");
+	std::filesystem::remove("staleEditorTestFile.txt");
+}
+
+TEST(EditorTests, ReloadKeepsCursorAndUndoOutsideChangedRows)
+{
+	std::string text;
+	for (size_t i = 0; i < 50; ++i) text += "row " + std::to_string(i) + '\n';
+	{
+		std::ofstream file("reloadEditorTestFile.txt", std::ios::binary);
+		file << text;
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("reloadEditorTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+		for (size_t i = 0; i < 40; ++i) editor.moveCursor(KeyActions::KeyAction::ArrowDown);
+		editor.insertChar('x');
+		editor.save();
+		EXPECT_FALSE(editor.isDirty());
+
+		//Another program adds two rows near the top
+		text = "row 0\nrow 1\nrow 2\nrow 3\nrow 4\nnew row\nanother new row\n" + text.substr(text.find("row 5\n"));
+		text.replace(text.find("row 40\n"), 0, "x");
+		{
+			std::ofstream file("reloadEditorTestFile.txt.new", std::ios::binary);
+			file << text;
+		}
+		std::filesystem::rename("reloadEditorTestFile.txt.new", "reloadEditorTestFile.txt");
+		editor.refreshScreen();
+
+		EXPECT_EQ(editor.getWindowForTesting().document->text(), text);
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 42) << "The cursor should stay on the same row of text";
+		EXPECT_FALSE(editor.isDirty());
+
+		editor.undoChange();
+		EXPECT_EQ(editor.getWindowForTesting().document->line(42), "row 40") << "The undo history should follow the rows it changed";
+	}
+	std::filesystem::remove("reloadEditorTestFile.txt");
+}
+
+TEST(EditorTests, ReloadKeepsFindColumnsBelowChangedRows)
+{
+	std::string text;
+	for (size_t i = 0; i < 50; ++i) text += "row " + std::to_string(i) + (i >= 40 ? " target\n" : "\n");
+	{
+		std::ofstream file("reloadFindTestFile.txt", std::ios::binary);
+		file << text;
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("reloadFindTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+		editor.findString("target");
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 40);
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorX, 7);
+
+		//Another program makes an earlier row longer and adds two rows, so the bytes below move but the columns don't
+		text = "row 0\nrow 1\nrow 2 is much longer now\nrow 3\nrow 4\nnew row\nanother new row\n" + text.substr(text.find("row 5\n"));
+		{
+			std::ofstream file("reloadFindTestFile.txt.new", std::ios::binary);
+			file << text;
+		}
+		std::filesystem::rename("reloadFindTestFile.txt.new", "reloadFindTestFile.txt");
+		editor.refreshScreen();
+		ASSERT_EQ(editor.getWindowForTesting().document->text(), text);
+
+		for (size_t i = 1; i < 10; ++i)
+		{
+			editor.moveCursorToFind(KeyActions::KeyAction::Enter);
+			EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 42 + i);
+			EXPECT_EQ(editor.getWindowForTesting().fileCursorX, 7) << "Find results should keep their column in the row";
+		}
+	}
+	std::filesystem::remove("reloadFindTestFile.txt");
+}
+
+TEST(EditorTests, FollowModeScrollsWithNewRowsAtEnd)
+{
+	{
+		std::ofstream file("followEditorTestFile.txt", std::ios::binary);
+		file << "first\nsecond\n";
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("followEditorTestFile.txt", FileHandler::OpenMode::Follow), std::make_unique<MockConsole>(MockConsole()));
+		editor.moveCursor(KeyActions::KeyAction::ArrowDown);
+		editor.moveCursor(KeyActions::KeyAction::ArrowDown);
+		ASSERT_EQ(editor.getWindowForTesting().fileCursorY, 2);
+
+		std::ofstream file("followEditorTestFile.txt", std::ios::binary | std::ios::app);
+		for (size_t i = 0; i < 50; ++i) file << "new row " << i << '\n';
+		file.flush();
+		editor.refreshScreen();
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 52) << "The cursor was at the end, so it should stay there";
+		EXPECT_GT(editor.getWindowForTesting().rowOffset, 40);
+
+		editor.moveCursor(KeyActions::KeyAction::ArrowUp);
+		file << "another row\n" << std::flush;
+		editor.refreshScreen();
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 51) << "Scrolled away from the end, so the cursor should stay put";
+		EXPECT_EQ(editor.getWindowForTesting().document->lineCount(), 54);
+	}
+	std::filesystem::remove("followEditorTestFile.txt");
+}
+
+TEST(EditorTests, InsertedFileIsOneUndoableChange)
+{
+	{
+		std::ofstream file("insertTargetTestFile.txt", std::ios::binary);
+		file << "first row\nsecond row\n";
+	}
+	std::string inserted;
+	for (size_t i = 0; i < 10'000; ++i) inserted += "inserted row " + std::to_string(i) + "\r\n";
+	inserted += "no line break";
+	{
+		std::ofstream file("insertSourceTestFile.txt", std::ios::binary);
+		file << inserted;
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".txt"), FileHandler("insertTargetTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		const size_t piecesBefore = editor.getWindowForTesting().document->pieceCount();
+		editor.insertFile("insertSourceTestFile.txt");
+
+		const PieceTable& document = *editor.getWindowForTesting().document;
+		ASSERT_EQ(document.lineCount(), 10'003);
+		EXPECT_EQ(document.line(0), "firstinserted row 0") << "The file should be inserted at the cursor, with its \"\\r\\n\" line endings normalized";
+		EXPECT_EQ(document.line(10'000), "no line break row");
+		EXPECT_LE(document.pieceCount(), piecesBefore + 2) << "The whole file should be spliced in as a single piece";
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 10'000);
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorX, 13) << "The cursor should end up after the inserted text";
+		EXPECT_TRUE(editor.isDirty());
+
+		editor.undoChange();
+		EXPECT_EQ(document.text(), "first row\nsecond row\n") << "A single undo should remove the whole file";
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorX, 5);
+
+		editor.redoChange();
+		EXPECT_EQ(document.lineCount(), 10'003);
+		EXPECT_EQ(document.line(10'000), "no line break row");
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorY, 10'000);
+
+		editor.insertFile("missingTestFile.txt");
+		EXPECT_EQ(document.lineCount(), 10'003) << "A file that can't be opened shouldn't change anything";
+	}
+	std::filesystem::remove("insertTargetTestFile.txt");
+	std::filesystem::remove("insertSourceTestFile.txt");
+}
+
+TEST(EditorTests, LargeFileLimitsAreReadFromConfig)
+{
+	const LargeFilePolicy::Limits limits = LargeFilePolicy::parseLimits(JsonParser::parseJson(
+		"{\"largeFile\": {\"fileSize\": \"64MB\", \"lineCount\": \"500000\", \"lineLength\": \"bad\"}}"));
+	EXPECT_EQ(limits.fileSize, 64ull * 1024 * 1024);
+	EXPECT_EQ(limits.lineCount, 500'000);
+	EXPECT_EQ(limits.lineLength, LargeFilePolicy::Limits().lineLength) << "A limit that isn't a number should keep its default";
+
+	const LargeFilePolicy policy(limits, 1024, 600'000, 10);
+	EXPECT_TRUE(policy.isActive());
+	EXPECT_EQ(policy.label(), "MANY ROWS");
+	EXPECT_TRUE(policy.syntaxHighlighting());
+	EXPECT_FALSE(policy.highlightAllMatches());
+	EXPECT_TRUE(policy.groupTypingUndo());
+}
+
+TEST(EditorTests, LargeFileDegradesFeatures)
+{
+	{
+		std::ofstream file("largeFilePolicyTestFile.cpp", std::ios::binary);
+		file << "int main()\n{\n\treturn 0;\n}\n";
+	}
+
+	{
+		Editor editor(SyntaxHighlight(".cpp"), FileHandler("largeFilePolicyTestFile.cpp"), std::make_unique<MockConsole>(MockConsole()));
+		EXPECT_FALSE(editor.largeFilePolicy().isActive()) << "A small file shouldn't be limited by the default limits";
+
+		editor.setLargeFileLimits(LargeFilePolicy::Limits{ .fileSize = 1024, .lineCount = 3, .lineLength = 8 });
+		const LargeFilePolicy& policy = editor.largeFilePolicy();
+		EXPECT_EQ(policy.label(), "MANY ROWS, LONG ROWS");
+		EXPECT_FALSE(policy.syntaxHighlighting());
+		EXPECT_FALSE(policy.expandTabs());
+
+		//Tabs take one column, so the cursor column is the file column
+		editor.moveCursor(KeyActions::KeyAction::ArrowDown);
+		editor.moveCursor(KeyActions::KeyAction::ArrowDown);
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		editor.moveCursor(KeyActions::KeyAction::ArrowRight);
+		editor.refreshScreen();
+		EXPECT_EQ(editor.getWindowForTesting().renderedCursorX, 2);
+
+		//A run of typing is undone all at once
+		editor.enableEditMode();
+		editor.insertChar('a');
+		editor.insertChar('b');
+		editor.insertChar('c');
+		EXPECT_EQ(editor.getWindowForTesting().document->line(2), "\trabceturn 0;");
+		editor.undoChange();
+		EXPECT_EQ(editor.getWindowForTesting().document->line(2), "\treturn 0;");
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorX, 2);
+		editor.redoChange();
+		EXPECT_EQ(editor.getWindowForTesting().document->line(2), "\trabceturn 0;");
+		EXPECT_EQ(editor.getWindowForTesting().fileCursorX, 5);
+	}
+	std::filesystem::remove("largeFilePolicyTestFile.cpp");
+}
@@ -3,8 +3,22 @@
 #include <fstream>
 #include <sstream>
 #include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "File/File.hpp"
+#include "File/LineIndexCache.hpp"
+#include "Editor/Editor.hpp"
+#include "MockConsole.hpp"
 
 TEST(FileTest, FileNameGetsSavedProperly)
 {
@@ -15,15 +29,15 @@ TEST(FileTest, FileNameGetsSavedProperly)
 TEST(FileTest, FileReturnsCorrectNumRows)
 {
 	FileHandler file("testFile.txt");
-	std::vector<FileHandler::Row> rows = *file.getFileContents();
-	EXPECT_EQ(rows.size(), 4) << "rows.size() should return 4";
+	const PieceTable& document = *file.getFileContents();
+	EXPECT_EQ(document.lineCount(), 4) << "lineCount() should return 4";
 }
 
 TEST(FileTest, FileReturnsEmptyWhenFileDoesntExist)
 {
 	FileHandler file("nonexistantFile.txt");
-	std::vector<FileHandler::Row> rows = *file.getFileContents();
-	EXPECT_EQ(rows.size(), 0) << "New/Nonexistant File should not have any rows";
+	const PieceTable& document = *file.getFileContents();
+	EXPECT_EQ(document.lineCount(), 0) << "New/Nonexistant File should not have any rows";
 }
 
 TEST(FileTest, SavingFileDoesntCorruptFile)
@@ -56,4 +70,1064 @@ TEST(FileTest, LargeFileOpensQuickly)
 	std::chrono::milliseconds actualTime = std::chrono::duration_cast<std::chrono::milliseconds>(after - before); //Get the actual time
 
 	EXPECT_TRUE(actualTime <= expectedMaxTime);
-}
\ No newline at end of file
+}
+
+TEST(FileTest, LargeFileIsMappedInsteadOfCopied)
+{
+	FileHandler fileHandler("test.cpp");
+	const PieceTable& document = *fileHandler.getFileContents();
+	EXPECT_TRUE(document.isMapped()) << "A file without \"\\r\\n\" line endings should be read straight from a mapping";
+	EXPECT_GT(document.lineCount(), 1);
+}
+
+TEST(FileTest, CarriageReturnFileIsCopiedAndNormalized)
+{
+	std::ofstream file("crlfTestFile.txt", std::ios::binary);
+	file << "first\r\nsecond\r\n";
+	file.close();
+
+	FileHandler fileHandler("crlfTestFile.txt");
+	const PieceTable& document = *fileHandler.getFileContents();
+	EXPECT_FALSE(document.isMapped()) << "\"\\r\\n\" line endings need to be normalized, so the file can't be used as-is";
+	ASSERT_EQ(document.lineCount(), 3);
+	EXPECT_EQ(document.line(0), "first");
+	EXPECT_EQ(document.line(1), "second");
+
+	std::filesystem::remove("crlfTestFile.txt");
+}
+
+TEST(FileTest, SavingMappedFileKeepsDocumentReadable)
+{
+	std::ofstream file("mappedTestFile.txt", std::ios::binary);
+	file << "first\nsecond\nthird";
+	file.close();
+
+	FileHandler fileHandler("mappedTestFile.txt");
+	PieceTable& document = *fileHandler.getFileContents();
+	ASSERT_TRUE(document.isMapped());
+
+	document.erase(1, 0, 7);
+	fileHandler.saveFile();
+
+	EXPECT_EQ(document.text(), "first\nthird") << "The document should still read from the old mapping after the file is replaced";
+
+	std::stringstream contents;
+	std::ifstream savedFile("mappedTestFile.txt", std::ios::binary);
+	contents << savedFile.rdbuf();
+	savedFile.close();
+	EXPECT_EQ(contents.str(), "first\nthird");
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("."))
+	{
+		EXPECT_FALSE(entry.path().filename().string().starts_with("mappedTestFile.txt.mini-save")) << "The temporary save file should be renamed over the original";
+	}
+
+	std::filesystem::remove("mappedTestFile.txt");
+}
+
+TEST(FileTest, SavingLeavesOtherTemporaryFilesAlone)
+{
+	std::ofstream file("uniqueSaveTestFile.txt", std::ios::binary);
+	file << "original";
+	file.close();
+	std::ofstream leftover("uniqueSaveTestFile.txt.mini-save", std::ios::binary); //What a save that crashed part way through would leave behind
+	leftover << "leftover";
+	leftover.close();
+
+	FileHandler fileHandler("uniqueSaveTestFile.txt");
+	PieceTable& document = *fileHandler.getFileContents();
+	document.insert(0, 8, " edited");
+	fileHandler.saveFile(true);
+	EXPECT_TRUE(fileHandler.lastSave().error.empty()) << fileHandler.lastSave().error;
+
+	std::stringstream saved, kept;
+	std::ifstream savedFile("uniqueSaveTestFile.txt", std::ios::binary);
+	saved << savedFile.rdbuf();
+	savedFile.close();
+	std::ifstream keptFile("uniqueSaveTestFile.txt.mini-save", std::ios::binary);
+	kept << keptFile.rdbuf();
+	keptFile.close();
+	EXPECT_EQ(saved.str(), "original edited");
+	EXPECT_EQ(kept.str(), "leftover") << "A file already using the temporary name shouldn't be written over";
+
+	size_t temporaryFiles = 0;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("."))
+	{
+		if (entry.path().filename().string().starts_with("uniqueSaveTestFile.txt.mini-save")) ++temporaryFiles;
+	}
+	EXPECT_EQ(temporaryFiles, 1) << "Only the leftover file should remain after the save";
+
+	document = PieceTable(); //Unmaps the file so it can be removed
+	std::filesystem::remove("uniqueSaveTestFile.txt");
+	std::filesystem::remove("uniqueSaveTestFile.txt.mini-save");
+}
+
+extern std::atomic<size_t> allocationCount;
+
+TEST(FileTest, LoadingMakesFewAllocations)
+{
+	const size_t before = allocationCount;
+	FileHandler fileHandler("test.cpp");
+	const size_t allocations = allocationCount - before;
+
+	const PieceTable& document = *fileHandler.getFileContents();
+	std::cout << "[ BENCHMARK ] Loading test.cpp (" << document.lineCount() << " rows) made " << allocations << " allocations\n";
+	EXPECT_LT(allocations, 1000) << "Rows are read straight from the file, so the allocations shouldn't grow with the number of rows";
+	EXPECT_EQ(document.stats().slabAllocations, 0);
+}
+
+TEST(FileTest, ParallelLoaderMatchesSingleThread)
+{
+	std::stringstream contents;
+	std::ifstream file("test.cpp", std::ios::binary);
+	contents << file.rdbuf();
+	file.close();
+	const std::string fileStr = contents.str() + "\nno line break at the end";
+
+	LineIndex singleThread;
+	FileHandler::findLineBreaks(fileStr, singleThread, 1);
+
+	for (const unsigned int threads : { 2, 3, 8 })
+	{
+		LineIndex lineBreaks;
+		EXPECT_FALSE(FileHandler::findLineBreaks(fileStr, lineBreaks, threads));
+		EXPECT_GT(lineBreaks.segmentCount(), 1) << "Each chunk should be moved in as its own segment";
+		ASSERT_EQ(lineBreaks.size(), singleThread.size()) << threads << " threads";
+		for (size_t i = 0; i < lineBreaks.size(); i += 997)
+		{
+			ASSERT_EQ(lineBreaks[i], singleThread[i]);
+		}
+		EXPECT_EQ(lineBreaks[lineBreaks.size() - 1], singleThread[singleThread.size() - 1]);
+	}
+}
+
+TEST(FileTest, ParallelLoaderScaling)
+{
+	//Rows of 40-80 characters, like a typical log or source file
+	std::string fileStr;
+	constexpr size_t fileSize = 256 * 1024 * 1024;
+	fileStr.reserve(fileSize + 128);
+	for (size_t row = 0; fileStr.length() < fileSize; ++row)
+	{
+		fileStr.append(40 + (row * 7919) % 41, 'a' + row % 26);
+		fileStr.push_back('\n');
+	}
+
+	size_t expectedLineBreaks = 0;
+	std::chrono::milliseconds singleThreadTime;
+	std::cout << "[ BENCHMARK ] Indexing " << fileStr.length() / (1024 * 1024) << "MB on " << std::thread::hardware_concurrency() << " hardware thread(s):";
+	for (const unsigned int threads : { 1, 2, 4, 8, 16, 32 })
+	{
+		LineIndex lineBreaks;
+		const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+		FileHandler::findLineBreaks(fileStr, lineBreaks, threads);
+		const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before);
+
+		if (threads == 1)
+		{
+			expectedLineBreaks = lineBreaks.size();
+			singleThreadTime = time;
+		}
+		EXPECT_EQ(lineBreaks.size(), expectedLineBreaks);
+		std::cout << " " << threads << (threads == 1 ? " thread " : " threads ") << time.count() << "ms (x" << std::fixed << std::setprecision(2)
+			<< static_cast<double>(singleThreadTime.count()) / std::max<long long>(time.count(), 1) << ")" << (threads == 32 ? "" : ",");
+	}
+	std::cout << '\n';
+}
+
+/// <summary>
+/// Writes copies of test.cpp to fileName until it is large enough to be loaded progressively, followed by ending
+/// </summary>
+/// <returns> The number of rows in the file </returns>
+static size_t writeProgressiveFile(const std::string& fileName, const std::string& ending)
+{
+	std::stringstream source;
+	std::ifstream sourceFile("test.cpp", std::ios::binary);
+	source << sourceFile.rdbuf();
+	sourceFile.close();
+	const std::string_view sourceStr = source.rdbuf()->view();
+
+	std::ofstream file(fileName, std::ios::binary);
+	size_t written = 0, lineBreaks = 0;
+	while (written <= FileHandler::progressiveLoadSize)
+	{
+		file << sourceStr << '\n';
+		written += sourceStr.length() + 1;
+		lineBreaks += std::count(sourceStr.begin(), sourceStr.end(), '\n') + 1;
+	}
+	file << ending;
+	file.close();
+	return lineBreaks + std::count(ending.begin(), ending.end(), '\n') + 1;
+}
+
+TEST(FileTest, LargeFileIsIndexedProgressively)
+{
+	const size_t rowCount = writeProgressiveFile("progressiveTestFile.txt", "last row");
+
+	FileHandler fileHandler("progressiveTestFile.txt");
+	const PieceTable& document = *fileHandler.getFileContents();
+	EXPECT_GT(document.lineCount(), 0) << "The head of the file should be available straight away";
+	EXPECT_LT(document.lineCount(), rowCount);
+
+	fileHandler.waitForRows(200'000);
+	EXPECT_GE(document.lineCount(), 200'000) << "Waiting for a region should make at least that region available";
+
+	fileHandler.waitForIndex();
+	EXPECT_FALSE(fileHandler.isIndexing());
+	EXPECT_EQ(fileHandler.indexProgress(), 100);
+	EXPECT_TRUE(document.isMapped());
+	ASSERT_EQ(document.lineCount(), rowCount);
+	EXPECT_EQ(document.line(rowCount - 1), "last row");
+
+	std::filesystem::remove("progressiveTestFile.txt");
+	std::filesystem::remove(LineIndexCache::pathFor(std::filesystem::current_path() / "progressiveTestFile.txt"));
+}
+
+TEST(FileTest, CarriageReturnFoundWhileIndexingSwitchesToCopy)
+{
+	const size_t rowCount = writeProgressiveFile("progressiveTestFile.txt", "second to last\r\nlast row");
+
+	FileHandler fileHandler("progressiveTestFile.txt");
+	fileHandler.waitForIndex();
+	const PieceTable& document = *fileHandler.getFileContents();
+	EXPECT_FALSE(document.isMapped()) << "A \"\\r\\n\" found in the background still needs to be normalized";
+	ASSERT_EQ(document.lineCount(), rowCount);
+	EXPECT_EQ(document.line(rowCount - 2), "second to last");
+	EXPECT_FALSE(std::filesystem::exists(LineIndexCache::pathFor(std::filesystem::current_path() / "progressiveTestFile.txt")))
+		<< "A file that gets normalized shouldn't have its line breaks cached";
+
+	std::filesystem::remove("progressiveTestFile.txt");
+}
+
+TEST(FileTest, ReopenedLargeFileReadsIndexCache)
+{
+	const size_t rowCount = writeProgressiveFile("cachedTestFile.txt", "last row");
+	const std::filesystem::path cachePath = LineIndexCache::pathFor(std::filesystem::current_path() / "cachedTestFile.txt");
+	std::filesystem::remove(cachePath);
+
+	auto timeIndexing = [](const bool useIndexCache, bool& fromCache, std::vector<std::string>& sampledRows)
+		{
+			const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+			FileHandler fileHandler("cachedTestFile.txt", FileHandler::OpenMode::Edit, useIndexCache);
+			fileHandler.waitForIndex();
+			const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before);
+
+			const PieceTable& document = *fileHandler.getFileContents();
+			fromCache = fileHandler.indexedFromCache();
+			sampledRows.clear();
+			for (size_t row = 0; row < document.lineCount(); row += 9973) sampledRows.push_back(document.line(row));
+			sampledRows.push_back(std::to_string(document.lineCount()));
+			sampledRows.push_back(document.line(document.lineCount() - 1));
+			return time;
+		};
+
+	bool fromCache;
+	std::vector<std::string> scannedRows, cachedRows;
+	const auto scanTime = timeIndexing(true, fromCache, scannedRows);
+	EXPECT_FALSE(fromCache);
+	ASSERT_TRUE(std::filesystem::exists(cachePath)) << "Indexing the whole file should leave a cache behind";
+	EXPECT_LT(std::filesystem::file_size(cachePath), rowCount * sizeof(size_t) / 4) << "The cache should be much smaller than the index it holds";
+	EXPECT_EQ(scannedRows[scannedRows.size() - 2], std::to_string(rowCount));
+
+	const auto cachedTime = timeIndexing(true, fromCache, cachedRows);
+	EXPECT_TRUE(fromCache);
+	EXPECT_EQ(cachedRows, scannedRows) << "The cached line breaks should give the same rows as scanning";
+	std::cout << "[ BENCHMARK ] Indexing a " << std::filesystem::file_size("cachedTestFile.txt") / 1024 << "KB file: scanned " << scanTime.count()
+		<< "ms, from the cache " << cachedTime.count() << "ms\n";
+
+	timeIndexing(false, fromCache, cachedRows);
+	EXPECT_FALSE(fromCache) << "The cache shouldn't be used when it is turned off";
+
+	//Changing the file changes its size, so the cache no longer matches and gets rebuilt
+	std::ofstream file("cachedTestFile.txt", std::ios::binary | std::ios::app);
+	file << "\nadded row";
+	file.close();
+	timeIndexing(true, fromCache, cachedRows);
+	EXPECT_FALSE(fromCache) << "A cache saved for a different version of the file shouldn't be used";
+	EXPECT_EQ(cachedRows[cachedRows.size() - 2], std::to_string(rowCount + 1));
+	EXPECT_EQ(cachedRows.back(), "added row");
+	timeIndexing(true, fromCache, cachedRows);
+	EXPECT_TRUE(fromCache);
+	EXPECT_EQ(cachedRows.back(), "added row");
+
+	//A cache cut short is ignored
+	std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - 1);
+	timeIndexing(true, fromCache, cachedRows);
+	EXPECT_FALSE(fromCache);
+	EXPECT_EQ(cachedRows[cachedRows.size() - 2], std::to_string(rowCount + 1));
+
+	std::filesystem::remove("cachedTestFile.txt");
+	std::filesystem::remove(cachePath);
+}
+
+/// <summary>
+/// Writes rowCount rows of "row N" to fileName, without a line break after the last one
+/// </summary>
+static void writeNumberedRows(const std::string& fileName, const size_t rowCount)
+{
+	std::ofstream file(fileName, std::ios::binary);
+	std::string row;
+	for (size_t i = 0; i < rowCount; ++i)
+	{
+		row = "row " + std::to_string(i);
+		if (i + 1 < rowCount) row += '\n';
+		file << row;
+	}
+}
+
+TEST(FileTest, PagedFileFindsRowsFromSparseIndex)
+{
+	writeNumberedRows("pagedTestFile.txt", 10'000);
+	{
+		std::ofstream file("pagedTestFile.txt", std::ios::binary | std::ios::app);
+		file << "\r\n" << std::string(100'000, 'x') << "\nlast row";
+	}
+
+	PagedFile pagedFile;
+	ASSERT_TRUE(pagedFile.open("pagedTestFile.txt"));
+	EXPECT_FALSE(pagedFile.isScanned()) << "Nothing should be scanned until rows are asked for";
+
+	std::string rows;
+	EXPECT_EQ(pagedFile.copyRows(5000, 3, std::string::npos, 1000, rows), 3);
+	EXPECT_EQ(rows, "row 5000\nrow 5001\nrow 5002");
+
+	EXPECT_EQ(pagedFile.copyRows(9999, 10, std::string::npos, 1000, rows), 3) << "Copying should stop at the end of the file";
+	EXPECT_EQ(rows, "row 9999\n" + std::string(1000, 'x') + "\nlast row") << "Long rows are cut off, and \"\\r\\n\" is copied as '\\n'";
+
+	pagedFile.scanToEnd();
+	EXPECT_TRUE(pagedFile.isScanned());
+	EXPECT_EQ(pagedFile.scanProgress(), 100);
+	EXPECT_EQ(pagedFile.knownRows(), 10'002);
+	EXPECT_EQ(pagedFile.checkpointCount(), 10'002 / PagedFile::checkpointInterval + 1);
+	EXPECT_EQ(pagedFile.rowStart(10'002), std::string::npos);
+
+	EXPECT_EQ(pagedFile.copyRows(0, 2, 5, 1000, rows), 1) << "Copying should stop once the byte limit is reached";
+
+	std::filesystem::remove("pagedTestFile.txt");
+}
+
+TEST(FileTest, ViewModeOnlyHoldsRowsAroundTheCursor)
+{
+	constexpr size_t rowCount = 200'000;
+	writeNumberedRows("viewTestFile.txt", rowCount);
+
+	FileHandler fileHandler("viewTestFile.txt", FileHandler::OpenMode::View);
+	const PieceTable& document = *fileHandler.getFileContents();
+	EXPECT_TRUE(fileHandler.isViewOnly());
+	EXPECT_EQ(fileHandler.firstRow(), 0);
+	EXPECT_EQ(document.lineCount(), FileHandler::viewWindowRows);
+	EXPECT_LT(fileHandler.indexProgress(), 100);
+
+	EXPECT_EQ(fileHandler.followRow(10), 0) << "Rows near the start of the first window don't move it";
+	const int64_t moved = fileHandler.followRow(FileHandler::viewWindowRows - 10);
+	EXPECT_GT(moved, 0);
+	EXPECT_EQ(document.line(FileHandler::viewWindowRows - 10 - moved), "row " + std::to_string(FileHandler::viewWindowRows - 10));
+
+	fileHandler.showRow(130'000);
+	ASSERT_LE(fileHandler.firstRow(), 130'000);
+	EXPECT_EQ(document.line(130'000 - fileHandler.firstRow()), "row 130000");
+
+	fileHandler.showRow(std::string::npos);
+	EXPECT_EQ(fileHandler.indexProgress(), 100);
+	EXPECT_EQ(fileHandler.lineCount(), rowCount);
+	EXPECT_EQ(document.line(document.lineCount() - 1), "row " + std::to_string(rowCount - 1));
+	EXPECT_EQ(fileHandler.followRow(document.lineCount() - 1), 0) << "The window can't move past the end of the file";
+
+	std::filesystem::remove("viewTestFile.txt");
+}
+
+#ifndef _WIN32
+/// <summary>
+/// Runs the load in a child process, so earlier tests don't affect the peak memory measured.
+/// Returns how much the child's peak memory grew (in KB) and how long the load took (in ms)
+/// </summary>
+static std::pair<long, long> measureLoad(void(*load)())
+{
+	int fds[2];
+	if (pipe(fds) == -1) return { -1, -1 };
+
+	const pid_t pid = fork();
+	if (pid == 0)
+	{
+		close(fds[0]);
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		const long peakBefore = usage.ru_maxrss; //Starts at the memory the child shares with the parent
+		std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+		load();
+		const long time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before).count();
+		getrusage(RUSAGE_SELF, &usage);
+		long result[2] = { usage.ru_maxrss - peakBefore, time };
+		write(fds[1], result, sizeof(result));
+		_exit(0);
+	}
+	close(fds[1]);
+	long result[2] = { -1, -1 };
+	read(fds[0], result, sizeof(result));
+	close(fds[0]);
+	waitpid(pid, nullptr, 0);
+#ifdef __APPLE__
+	result[0] /= 1024; //macOS reports bytes instead of KB
+#endif
+	return { result[0], result[1] };
+}
+
+TEST(FileTest, MappedLoadMemoryAndFirstFrame)
+{
+	std::stringstream source;
+	std::ifstream sourceFile("test.cpp", std::ios::binary);
+	source << sourceFile.rdbuf();
+	sourceFile.close();
+
+	constexpr size_t copies = 32; //Roughly 120MB
+	std::ofstream bigFile("bigTestFile.txt", std::ios::binary);
+	for (size_t i = 0; i < copies; ++i) bigFile << source.rdbuf()->view();
+	bigFile.close();
+	const size_t fileSizeKB = std::filesystem::file_size("bigTestFile.txt") / 1024;
+
+	const auto [mappedPeakKB, mappedTime] = measureLoad([]()
+		{
+			Editor editor(SyntaxHighlight(".txt"), FileHandler("bigTestFile.txt"), std::make_unique<MockConsole>(MockConsole()));
+			std::cout.setstate(std::ios::failbit); //Only the time it takes to build the frame matters, not the output
+			editor.refreshScreen(true);
+			std::cout.clear();
+		});
+
+	//The old way of loading: stream the file into a stringstream, then copy it out into a string
+	const auto [copiedPeakKB, copiedTime] = measureLoad([]()
+		{
+			std::stringstream contents;
+			std::ifstream file("bigTestFile.txt");
+			contents << file.rdbuf();
+			file.close();
+			PieceTable document(contents.str());
+		});
+
+	EXPECT_GE(mappedPeakKB, 0);
+	std::cout << "[ BENCHMARK ] " << fileSizeKB << "KB file. Mapped: first frame in " << mappedTime << "ms, peak RSS +" << mappedPeakKB
+		<< "KB. Copied (load only): " << copiedTime << "ms, peak RSS +" << copiedPeakKB << "KB\n";
+
+	std::filesystem::remove("bigTestFile.txt");
+	std::filesystem::remove(LineIndexCache::pathFor(std::filesystem::current_path() / "bigTestFile.txt"));
+}
+
+TEST(FileTest, ViewModeMemoryStaysBounded)
+{
+	constexpr size_t rowCount = 20'000'000; //Roughly 250MB
+	writeNumberedRows("bigViewTestFile.txt", rowCount);
+	const size_t fileSizeKB = std::filesystem::file_size("bigViewTestFile.txt") / 1024;
+
+	//Page through the whole file, the way scrolling to the bottom would
+	const auto [viewPeakKB, viewTime] = measureLoad([]()
+		{
+			FileHandler fileHandler("bigViewTestFile.txt", FileHandler::OpenMode::View);
+			const PieceTable& document = *fileHandler.getFileContents();
+			size_t row = 0;
+			while (fileHandler.firstRow() + document.lineCount() < rowCount)
+			{
+				row += document.lineCount() / 2;
+				fileHandler.showRow(row);
+			}
+		});
+
+	EXPECT_GE(viewPeakKB, 0);
+	EXPECT_LT(static_cast<size_t>(viewPeakKB), fileSizeKB / 4) << "Paging through the file shouldn't keep it in memory";
+	std::cout << "[ BENCHMARK ] Paging through a " << fileSizeKB << "KB file in view mode: " << viewTime << "ms, peak RSS +" << viewPeakKB << "KB\n";
+
+	std::filesystem::remove("bigViewTestFile.txt");
+}
+#endif
+
+TEST(FileTest, StreamingSaveWritesPiecesWithoutCopying)
+{
+	constexpr size_t rowCount = 4'000'000;
+	writeNumberedRows("streamSaveTestFile.txt", rowCount);
+
+	FileHandler fileHandler("streamSaveTestFile.txt");
+	PieceTable& document = *fileHandler.getFileContents();
+	for (size_t row = 0; row < rowCount; row += 1000)
+	{
+		document.insert(row, 0, "#"); //Leaves thousands of pieces, more than fit in a single writev
+	}
+	document.compact();
+	ASSERT_GT(document.pieceCount(), 4000);
+
+	//The way the file used to be saved: join the document into one string, then write it through a stream
+	std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	{
+		const std::string output = document.text();
+		std::ofstream copyFile("streamSaveCopy.txt", std::ios::binary);
+		copyFile << output;
+	}
+	std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+	const auto copyTime = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+	before = std::chrono::steady_clock::now();
+	fileHandler.saveFile();
+	after = std::chrono::steady_clock::now();
+	const auto streamTime = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+	const FileHandler::SaveStats& stats = fileHandler.lastSave();
+	std::cout << "[ BENCHMARK ] Saving " << stats.bytes / (1024 * 1024) << "MB in " << document.pieceCount() << " pieces: copy then write " << copyTime.count()
+		<< "us, streamed " << streamTime.count() << "us (" << std::fixed << std::setprecision(1) << stats.bytesPerSecond() / (1024 * 1024) << " MB/s)\n";
+
+	EXPECT_EQ(stats.bytes, document.length());
+	EXPECT_EQ(std::filesystem::file_size("streamSaveTestFile.txt"), document.length());
+
+	std::stringstream saved, copied;
+	std::ifstream savedFile("streamSaveTestFile.txt", std::ios::binary);
+	saved << savedFile.rdbuf();
+	savedFile.close();
+	std::ifstream copiedFile("streamSaveCopy.txt", std::ios::binary);
+	copied << copiedFile.rdbuf();
+	copiedFile.close();
+	EXPECT_TRUE(saved.str() == copied.str()) << "Streaming the pieces should write exactly what the document holds";
+
+	fileHandler.saveFile(true);
+	EXPECT_EQ(fileHandler.lastSave().bytes, document.length()) << "Saving with fsync should write the same file";
+
+	EXPECT_LT(streamTime.count(), copyTime.count() * 2 + 10'000);
+
+	document = PieceTable(); //Unmaps the file so it can be removed
+	std::filesystem::remove("streamSaveTestFile.txt");
+	std::filesystem::remove("streamSaveCopy.txt");
+}
+
+TEST(FileTest, BackgroundSaveWritesSnapshotWhileEditing)
+{
+	constexpr size_t rowCount = 4'000'000;
+	writeNumberedRows("backgroundSaveTestFile.txt", rowCount);
+
+	FileHandler fileHandler("backgroundSaveTestFile.txt");
+	PieceTable& document = *fileHandler.getFileContents();
+	document.insert(0, 0, "saved ");
+	const std::string expected = document.text();
+	const uint64_t savedVersion = document.version();
+
+	std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	fileHandler.saveFileInBackground();
+	std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+	const auto startTime = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+	//Keep editing while the snapshot is written, enough to trigger compaction too
+	for (size_t i = 0; i < 20'000; ++i)
+	{
+		document.insert((i * 7919) % rowCount, 0, "#");
+	}
+	document.erase(0, 0, 6);
+
+	ASSERT_TRUE(fileHandler.waitForSave());
+	const FileHandler::SaveStats& stats = fileHandler.lastSave();
+	std::cout << "[ BENCHMARK ] Background save of " << stats.bytes / (1024 * 1024) << "MB: returned after " << startTime.count() << "us, written in "
+		<< stats.duration.count() << "us\n";
+
+	EXPECT_TRUE(stats.error.empty());
+	EXPECT_EQ(stats.version, savedVersion);
+	EXPECT_NE(stats.version, document.version());
+	EXPECT_LT(startTime, stats.duration) << "Starting a save shouldn't wait for the file to be written";
+
+	std::stringstream contents;
+	std::ifstream savedFile("backgroundSaveTestFile.txt", std::ios::binary);
+	contents << savedFile.rdbuf();
+	savedFile.close();
+	EXPECT_TRUE(contents.str() == expected) << "The file should hold the document as it was when the save started";
+	EXPECT_FALSE(fileHandler.waitForSave()) << "There is nothing left to wait for";
+
+	document = PieceTable(); //Unmaps the file so it can be removed
+	std::filesystem::remove("backgroundSaveTestFile.txt");
+}
+
+TEST(FileTest, SaveCopiesUnchangedRangesFromOriginalFile)
+{
+	constexpr size_t rowCount = 4'000'000;
+	writeNumberedRows("spliceSaveTestFile.txt", rowCount);
+
+	FileHandler fileHandler("spliceSaveTestFile.txt");
+	PieceTable& document = *fileHandler.getFileContents();
+	ASSERT_TRUE(document.isMapped());
+	document.insert(10, 0, "edited ");
+	document.erase(rowCount / 2, 0, 4);
+	document.insert(rowCount - 1, 0, "last ");
+
+	std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	const std::string expected = document.text();
+	{
+		std::ofstream copyFile("spliceSaveCopy.txt", std::ios::binary);
+		copyFile << expected;
+	}
+	std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+	const auto rewriteTime = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+	fileHandler.saveFile();
+	const FileHandler::SaveStats stats = fileHandler.lastSave();
+	std::cout << "[ BENCHMARK ] Saving " << stats.bytes / (1024 * 1024) << "MB with 3 edits: full rewrite " << rewriteTime.count() << "us, copying unchanged ranges "
+		<< stats.duration.count() << "us (" << stats.bytesCopied / (1024 * 1024) << "MB copied by the kernel)\n";
+
+	auto readFile = [](const std::string& fileName)
+		{
+			std::stringstream contents;
+			std::ifstream file(fileName, std::ios::binary);
+			contents << file.rdbuf();
+			return contents.str();
+		};
+	EXPECT_TRUE(readFile("spliceSaveTestFile.txt") == expected);
+#ifdef __linux__
+	if (stats.bytesCopied == 0) std::cout << "[ BENCHMARK ] copy_file_range isn't supported here, so the whole file was written from memory\n";
+#else
+	EXPECT_EQ(stats.bytesCopied, 0);
+#endif
+	EXPECT_LE(stats.bytesCopied, stats.bytes);
+
+	//The file on disk is now the saved copy, but the unchanged ranges still have to come from the file that was loaded
+	document.insert(0, 0, "again ");
+	fileHandler.saveFile();
+	EXPECT_TRUE(readFile("spliceSaveTestFile.txt") == "again " + expected);
+	EXPECT_EQ(fileHandler.lastSave().bytesCopied, stats.bytesCopied);
+
+	document = PieceTable(); //Unmaps the file so it can be removed
+	std::filesystem::remove("spliceSaveTestFile.txt");
+	std::filesystem::remove("spliceSaveCopy.txt");
+}
+
+/// <summary>
+/// Closing a file handler removes its journal, so a copy is kept to stand in for the journal a crash would leave behind
+/// </summary>
+static void keepJournalThroughClose(const std::string& fileName, FileHandler& fileHandler, std::string& journal)
+{
+	fileHandler.journal()->flush();
+	std::stringstream contents;
+	std::ifstream journalFile(fileName + ".mini-journal", std::ios::binary);
+	contents << journalFile.rdbuf();
+	journal = contents.str();
+}
+
+static void restoreJournal(const std::string& fileName, const std::string& journal)
+{
+	std::ofstream journalFile(fileName + ".mini-journal", std::ios::binary);
+	journalFile << journal;
+}
+
+TEST(FileTest, JournalRecoversUnsavedEdits)
+{
+	{
+		std::ofstream file("journalTestFile.txt", std::ios::binary);
+		file << "first\nsecond\nthird";
+	}
+
+	std::string journal, expected;
+	{
+		FileHandler fileHandler("journalTestFile.txt");
+		PieceTable& document = *fileHandler.getFileContents();
+		document.insert(0, 5, " row");
+		document.insert(1, 0, "the\n");
+		document.erase(2, 0, 3);
+		document.pushBackLine();
+		expected = document.text();
+		keepJournalThroughClose("journalTestFile.txt", fileHandler, journal);
+		EXPECT_EQ(fileHandler.journal()->stats().records, 4);
+	}
+	EXPECT_FALSE(std::filesystem::exists("journalTestFile.txt.mini-journal")) << "Closing normally should remove the journal";
+
+	restoreJournal("journalTestFile.txt", journal + "i 0 0 50\nonly part of a recor"); //The crash happened part way through writing a record
+	{
+		FileHandler fileHandler("journalTestFile.txt");
+		EXPECT_EQ(fileHandler.recoveredEdits(), 4);
+		EXPECT_EQ(fileHandler.getFileContents()->text(), expected);
+
+		//Edits after recovering carry on in the same journal
+		fileHandler.getFileContents()->insert(0, 0, "# ");
+		expected = fileHandler.getFileContents()->text();
+		keepJournalThroughClose("journalTestFile.txt", fileHandler, journal);
+	}
+
+	restoreJournal("journalTestFile.txt", journal);
+	{
+		FileHandler fileHandler("journalTestFile.txt");
+		EXPECT_EQ(fileHandler.recoveredEdits(), 5);
+		EXPECT_EQ(fileHandler.getFileContents()->text(), expected);
+	}
+
+	//A journal recorded against a different version of the file is never replayed
+	{
+		std::ofstream file("journalTestFile.txt", std::ios::binary);
+		file << "changed somewhere else";
+	}
+	restoreJournal("journalTestFile.txt", journal);
+	{
+		FileHandler fileHandler("journalTestFile.txt");
+		EXPECT_EQ(fileHandler.recoveredEdits(), 0);
+		EXPECT_TRUE(fileHandler.hasStaleJournal());
+		EXPECT_EQ(fileHandler.getFileContents()->text(), "changed somewhere else");
+	}
+	EXPECT_FALSE(std::filesystem::exists("journalTestFile.txt.mini-journal"));
+
+	//The edits are set aside rather than thrown away, since they can't be recovered any other way
+	std::stringstream stale;
+	stale << std::ifstream("journalTestFile.txt.mini-journal.stale", std::ios::binary).rdbuf();
+	EXPECT_EQ(stale.str(), journal);
+	std::filesystem::remove("journalTestFile.txt.mini-journal.stale");
+	std::filesystem::remove("journalTestFile.txt");
+}
+
+TEST(FileTest, SavingStartsJournalAgainFromSavedFile)
+{
+	{
+		std::ofstream file("journalSaveTestFile.txt", std::ios::binary);
+		file << "first\nsecond";
+	}
+
+	std::string journal, expected;
+	{
+		FileHandler fileHandler("journalSaveTestFile.txt");
+		PieceTable& document = *fileHandler.getFileContents();
+		document.insert(0, 0, "saved ");
+		fileHandler.saveFileInBackground();
+		document.insert(1, 0, "unsaved "); //Made while the save may still be being written, so it has to stay in the journal
+		ASSERT_TRUE(fileHandler.waitForSave());
+		document.erase(0, 0, 6);
+		expected = document.text();
+		keepJournalThroughClose("journalSaveTestFile.txt", fileHandler, journal);
+	}
+
+	restoreJournal("journalSaveTestFile.txt", journal);
+	{
+		FileHandler fileHandler("journalSaveTestFile.txt");
+		EXPECT_EQ(fileHandler.recoveredEdits(), 2) << "Only the edits that aren't in the saved file should be replayed";
+		EXPECT_EQ(fileHandler.getFileContents()->text(), expected);
+
+		fileHandler.saveFile();
+		EXPECT_FALSE(std::filesystem::exists("journalSaveTestFile.txt.mini-journal")) << "Nothing is left unsaved";
+	}
+	std::filesystem::remove("journalSaveTestFile.txt");
+}
+
+TEST(FileTest, JournalingAddsLittleToEachEdit)
+{
+	std::string text;
+	for (size_t i = 0; i < 100'000; ++i) text += "row " + std::to_string(i) + '\n';
+
+	auto timeTyping = [&text](PieceTable::EditListener* listener)
+		{
+			PieceTable document(text);
+			document.setEditListener(listener);
+			constexpr size_t keystrokes = 200'000;
+			const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < keystrokes; ++i)
+			{
+				const size_t row = (i / 100) % 100'000; //Typing a hundred characters on each row
+				if (i % 10 == 9) document.erase(row, 0, 1);
+				else document.insert(row, 0, "x");
+			}
+			const std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count() / keystrokes;
+		};
+
+	const int64_t plainTime = timeTyping(nullptr);
+	int64_t journaledTime;
+	EditJournal::Stats stats;
+	{
+		EditJournal journal("journalBenchmark.txt.mini-journal", EditJournal::FileIdentity());
+		journaledTime = timeTyping(&journal);
+		journal.flush();
+		stats = journal.stats();
+	}
+	std::cout << "[ BENCHMARK ] Per keystroke: " << plainTime << "ns without the journal, " << journaledTime << "ns with it (" << stats.records << " records, "
+		<< stats.bytes / 1024 << "KB in " << stats.flushes << " writes)\n";
+
+	EXPECT_EQ(stats.records, 200'000);
+	EXPECT_LT(stats.flushes, stats.records / 100) << "Edits should be written in batches";
+	EXPECT_LT(journaledTime, plainTime * 2 + 1000);
+	EXPECT_FALSE(std::filesystem::exists("journalBenchmark.txt.mini-journal"));
+}
+
+TEST(FileTest, ReplacedFileOnlyReloadsChangedRows)
+{
+	std::string text;
+	for (size_t i = 0; i < 1000; ++i) text += "row " + std::to_string(i) + '\n';
+	{
+		std::ofstream file("reloadTestFile.txt", std::ios::binary);
+		file << text;
+	}
+
+	{
+		FileHandler fileHandler("reloadTestFile.txt");
+		const PieceTable& document = *fileHandler.getFileContents();
+		EXPECT_FALSE(fileHandler.reloadIfChanged(false).changedOnDisk);
+
+		//Most tools save by writing a new file and renaming it over the old one
+		const size_t start = text.find("row 500\n");
+		const size_t end = text.find("row 502\n");
+		text.replace(start, end - start, "new 500\nnew 501\nnew 502\n");
+		{
+			std::ofstream file("reloadTestFile.txt.new", std::ios::binary);
+			file << text;
+		}
+		std::filesystem::rename("reloadTestFile.txt.new", "reloadTestFile.txt");
+
+		const FileHandler::Reload reload = fileHandler.reloadIfChanged(false);
+		EXPECT_TRUE(reload.changedOnDisk);
+		EXPECT_TRUE(reload.reloaded);
+		EXPECT_FALSE(reload.wholeFile);
+		EXPECT_EQ(reload.firstRow, 500);
+		EXPECT_EQ(reload.oldEndRow, 502);
+		EXPECT_EQ(reload.rowDelta, 1);
+		EXPECT_EQ(reload.byteDelta, 8);
+		EXPECT_EQ(document.text(), text);
+		EXPECT_TRUE(document.isMapped()) << "The rest of the document should still be read from the old mapping";
+		EXPECT_LE(document.pieceCount(), 3);
+		EXPECT_FALSE(fileHandler.reloadIfChanged(false).changedOnDisk);
+
+		PieceTable& editable = *fileHandler.getFileContents();
+		editable.insert(0, 0, "saved ");
+		fileHandler.saveFile();
+		EXPECT_FALSE(fileHandler.reloadIfChanged(false).changedOnDisk) << "Our own save isn't a change made by another program";
+		EXPECT_EQ(document.line(0), "saved row 0");
+	}
+	std::filesystem::remove("reloadTestFile.txt");
+}
+
+TEST(FileTest, RewrittenFileIsReloadedWhole)
+{
+	{
+		std::ofstream file("rewriteTestFile.txt", std::ios::binary);
+		file << "first\nsecond\nthird";
+	}
+
+	{
+		FileHandler fileHandler("rewriteTestFile.txt");
+		PieceTable& document = *fileHandler.getFileContents();
+
+		//Written over in place, so the mapping of the old file already shows the new text and the change can't be found
+		{
+			std::ofstream file("rewriteTestFile.txt", std::ios::binary);
+			file << "first\nchanged\nthird\nfourth";
+		}
+		const FileHandler::Reload reload = fileHandler.reloadIfChanged(false);
+		EXPECT_TRUE(reload.reloaded);
+		EXPECT_TRUE(reload.wholeFile);
+		EXPECT_EQ(document.text(), "first\nchanged\nthird\nfourth");
+
+		document.insert(0, 0, "unsaved ");
+		{
+			std::ofstream file("rewriteTestFile.txt.new", std::ios::binary);
+			file << "replaced";
+		}
+		std::filesystem::rename("rewriteTestFile.txt.new", "rewriteTestFile.txt");
+		const FileHandler::Reload skipped = fileHandler.reloadIfChanged(true);
+		EXPECT_TRUE(skipped.changedOnDisk);
+		EXPECT_FALSE(skipped.reloaded) << "Unsaved changes should never be thrown away";
+		EXPECT_EQ(document.line(0), "unsaved first");
+	}
+	std::filesystem::remove("rewriteTestFile.txt");
+}
+
+TEST(FileTest, TruncatedFileUnderUnsavedChangesIsCopiedOut)
+{
+	{
+		std::ofstream file("truncateTestFile.txt", std::ios::binary);
+		file << "first\nsecond\nthird\n";
+	}
+
+	{
+		FileHandler fileHandler("truncateTestFile.txt");
+		PieceTable& document = *fileHandler.getFileContents();
+		ASSERT_TRUE(document.isMapped());
+		document.insert(0, 0, "unsaved ");
+
+		//Truncated in place, like a shell's '>' does, so the mapping's last page is past the end of the file
+		std::filesystem::resize_file("truncateTestFile.txt", 8);
+		const FileHandler::Reload reload = fileHandler.reloadIfChanged(true);
+		EXPECT_TRUE(reload.changedOnDisk);
+		EXPECT_FALSE(reload.reloaded);
+		EXPECT_EQ(reload.lostBytes, 11);
+		EXPECT_FALSE(document.isMapped());
+		EXPECT_EQ(document.text(), "unsaved first\nse    \n     \n") << "The rows that are gone should keep their line breaks";
+	}
+	std::filesystem::remove("truncateTestFile.txt");
+}
+
+TEST(FileTest, FollowModeAddsOnlyCompleteAppendedRows)
+{
+	{
+		std::ofstream file("followTestFile.txt", std::ios::binary);
+		file << "first\nsecond\npart";
+	}
+
+	{
+		FileHandler fileHandler("followTestFile.txt", FileHandler::OpenMode::Follow);
+		const PieceTable& document = *fileHandler.getFileContents();
+		EXPECT_TRUE(fileHandler.isViewOnly());
+		EXPECT_TRUE(fileHandler.isFollowing());
+		ASSERT_EQ(document.lineCount(), 3);
+		EXPECT_FALSE(fileHandler.readAppended().changed);
+
+		std::ofstream file("followTestFile.txt", std::ios::binary | std::ios::app);
+		file << "ial\nthird\nunfin" << std::flush;
+		FileHandler::Appended appended = fileHandler.readAppended();
+		EXPECT_TRUE(appended.changed);
+		EXPECT_EQ(appended.firstRow, 2);
+		EXPECT_EQ(appended.newRows, 2);
+		EXPECT_EQ(document.text(), "first\nsecond\npartial\nthird\n") << "A row that is still being written shouldn't be shown";
+
+		file << "ished" << std::flush;
+		EXPECT_FALSE(fileHandler.readAppended().changed);
+		file << "\r\n" << std::flush;
+		appended = fileHandler.readAppended();
+		EXPECT_EQ(appended.firstRow, 4);
+		EXPECT_EQ(appended.newRows, 1);
+		EXPECT_EQ(document.line(4), "unfinished");
+		file.close();
+
+		//Rotated, so the file starts again
+		{
+			std::ofstream rotated("followTestFile.txt", std::ios::binary);
+			rotated << "new\n";
+		}
+		appended = fileHandler.readAppended();
+		EXPECT_TRUE(appended.truncated);
+		EXPECT_EQ(document.text(), "new\n");
+
+		//Truncated in place like logrotate's copytruncate, the rows already loaded can still be read until the truncation is noticed
+		std::filesystem::resize_file("followTestFile.txt", 0);
+		EXPECT_EQ(document.text(), "new\n");
+		{
+			std::ofstream rotated("followTestFile.txt", std::ios::binary | std::ios::app);
+			rotated << "a\n";
+		}
+		appended = fileHandler.readAppended();
+		EXPECT_TRUE(appended.truncated);
+		EXPECT_EQ(document.text(), "a\n");
+	}
+	std::filesystem::remove("followTestFile.txt");
+}
+
+TEST(FileTest, FollowModeKeepsUpWithFastWriter)
+{
+	{
+		std::ofstream file("followBenchmark.txt", std::ios::binary);
+		for (size_t i = 0; i < 10'000; ++i) file << "existing row " << i << '\n';
+	}
+
+	{
+		FileHandler fileHandler("followBenchmark.txt", FileHandler::OpenMode::Follow);
+		const PieceTable& document = *fileHandler.getFileContents();
+		std::ofstream file("followBenchmark.txt", std::ios::binary | std::ios::app);
+
+		//A frame's worth of log lines at a time
+		constexpr size_t frames = 100, rowsPerFrame = 1000;
+		std::chrono::nanoseconds readTime(0);
+		for (size_t frame = 0; frame < frames; ++frame)
+		{
+			for (size_t i = 0; i < rowsPerFrame; ++i) file << "2025-01-01 12:00:00 INFO request " << frame * rowsPerFrame + i << " handled\n";
+			file << "2025-01-01 12:00:00 INFO partial " << std::flush;
+
+			const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+			const FileHandler::Appended appended = fileHandler.readAppended();
+			readTime += std::chrono::steady_clock::now() - before;
+			ASSERT_EQ(appended.newRows, rowsPerFrame);
+		}
+
+		const double rowsPerSecond = frames * rowsPerFrame / std::chrono::duration<double>(readTime).count();
+		std::cout << "[ BENCHMARK ] Follow mode: " << frames * rowsPerFrame << " rows in " << std::chrono::duration_cast<std::chrono::milliseconds>(readTime).count()
+			<< "ms (" << static_cast<size_t>(rowsPerSecond) << " rows/s), " << document.pieceCount() << " pieces\n";
+
+		EXPECT_EQ(document.lineCount(), 10'000 + frames * rowsPerFrame + 1);
+		EXPECT_EQ(document.line(document.lineCount() - 2), "2025-01-01 12:00:00 INFO request 99999 handled");
+		EXPECT_GT(rowsPerSecond, 100'000);
+		EXPECT_LE(document.pieceCount(), frames + 2) << "Each read should add at most one piece, however many rows it has";
+	}
+	std::filesystem::remove("followBenchmark.txt");
+}
+
+#ifndef _WIN32
+TEST(FileTest, PipedInputIsAddedAsItArrives)
+{
+	int ends[2];
+	ASSERT_EQ(pipe(ends), 0);
+	PipeReader reader;
+	ASSERT_TRUE(reader.open(ends[0]));
+
+	FileHandler fileHandler(std::move(reader));
+	const PieceTable& document = *fileHandler.getFileContents();
+	EXPECT_TRUE(fileHandler.isViewOnly());
+	EXPECT_TRUE(fileHandler.isFollowing());
+
+	auto waitForAppend = [&fileHandler]()
+		{
+			FileHandler::Appended appended;
+			for (size_t i = 0; i < 200 && !appended.changed && !appended.ended; ++i)
+			{
+				appended = fileHandler.readAppended();
+				if (!appended.changed) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+			return appended;
+		};
+
+	const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	EXPECT_FALSE(fileHandler.readAppended().changed);
+	EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(50)) << "Nothing arriving shouldn't hold up the screen";
+
+	ASSERT_EQ(write(ends[1], "first\nsec", 9), 9);
+	FileHandler::Appended appended = waitForAppend();
+	EXPECT_TRUE(appended.changed);
+	EXPECT_EQ(document.text(), "first\n") << "A row that is still arriving shouldn't be shown";
+
+	ASSERT_EQ(write(ends[1], "ond\nthird", 9), 9);
+	close(ends[1]);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	for (size_t i = 0; i < 200 && !appended.ended; ++i)
+	{
+		appended = fileHandler.readAppended();
+		if (!appended.ended) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_TRUE(appended.ended);
+	EXPECT_EQ(document.text(), "first\nsecond\nthird") << "The last row is complete once the input ends, even without a line break";
+	EXPECT_FALSE(fileHandler.readAppended().ended) << "The end should only be reported once";
+}
+
+TEST(FileTest, PipedInputKeepsUpWithFastWriter)
+{
+	int ends[2];
+	ASSERT_EQ(pipe(ends), 0);
+	PipeReader reader;
+	ASSERT_TRUE(reader.open(ends[0]));
+	FileHandler fileHandler(std::move(reader));
+	const PieceTable& document = *fileHandler.getFileContents();
+
+	constexpr size_t rows = 1'000'000;
+	std::thread writer([writeEnd = ends[1]]()
+		{
+			std::string block;
+			for (size_t i = 0; i < rows; ++i)
+			{
+				block += "2025-01-01 12:00:00 INFO request " + std::to_string(i) + " handled\n";
+				if (block.length() < 64 * 1024 && i + 1 < rows) continue;
+				for (size_t written = 0; written < block.length();)
+				{
+					const ssize_t length = write(writeEnd, block.data() + written, block.length() - written);
+					if (length <= 0) break;
+					written += static_cast<size_t>(length);
+				}
+				block.clear();
+			}
+			close(writeEnd);
+		});
+
+	const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	size_t frames = 0;
+	FileHandler::Appended appended;
+	while (!appended.ended && std::chrono::steady_clock::now() - before < std::chrono::seconds(30))
+	{
+		appended = fileHandler.readAppended();
+		++frames;
+		if (!appended.changed) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before);
+	writer.join();
+
+	std::cout << "[ BENCHMARK ] Piped input: " << rows << " rows (" << document.length() / (1024 * 1024) << "MB) in " << elapsed.count() << "ms over "
+		<< frames << " frames\n";
+	EXPECT_TRUE(appended.ended);
+	EXPECT_EQ(document.lineCount(), rows + 1);
+	EXPECT_EQ(document.line(rows - 1), "2025-01-01 12:00:00 INFO request 999999 handled");
+}
+#endif
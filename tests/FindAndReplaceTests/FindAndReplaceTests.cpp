@@ -2,17 +2,17 @@
 #include <vector>
 
 #include "FindAndReplace/FindAndReplace.hpp"
-#include "File/File.hpp"
+#include "PieceTable/PieceTable.hpp"
 
 TEST(FindAndReplaceTests, FindReturnsCorrectAmount)
 {
-	std::vector<FileHandler::Row> rows{
-		FileHandler::Row("test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r2test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r3test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r4test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r5test, test2, t3st3, test4, otherword, otherwordwithtest")
-	};
+	PieceTable rows(
+		"test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r2test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r3test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r4test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r5test, test2, t3st3, test4, otherword, otherwordwithtest"
+	);
 	std::vector<FindAndReplace::FindLocation> locations = FindAndReplace::find("test", rows);
 
 	EXPECT_EQ(locations.size(), 20);
@@ -20,13 +20,13 @@ TEST(FindAndReplaceTests, FindReturnsCorrectAmount)
 
 TEST(FindAndReplaceTests, FindReturnsEmptyWithNoMatch)
 {
-	std::vector<FileHandler::Row> rows{
-		FileHandler::Row("test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r2test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r3test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r4test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r5test, test2, t3st3, test4, otherword, otherwordwithtest")
-	};
+	PieceTable rows(
+		"test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r2test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r3test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r4test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r5test, test2, t3st3, test4, otherword, otherwordwithtest"
+	);
 	std::vector<FindAndReplace::FindLocation> locations = FindAndReplace::find("nomatch", rows);
 
 	EXPECT_EQ(locations.size(), 0);
@@ -34,16 +34,16 @@ TEST(FindAndReplaceTests, FindReturnsEmptyWithNoMatch)
 
 TEST(FindAndReplaceTests, ReplaceReplacesCorrectOne)
 {
-	std::vector<FileHandler::Row> rows{
-		FileHandler::Row("test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r2test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r3test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r4test, test2, t3st3, test4, otherword, otherwordwithtest"),
-		FileHandler::Row("r5test, test2, t3st3, test4, otherword, otherwordwithtest")
-	};
+	PieceTable rows(
+		"test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r2test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r3test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r4test, test2, t3st3, test4, otherword, otherwordwithtest\n"
+		"r5test, test2, t3st3, test4, otherword, otherwordwithtest"
+	);
 	std::vector<FindAndReplace::FindLocation> locations = FindAndReplace::find("test", rows);
 
-	FindAndReplace::replace(rows[0].line, "replacedTest", locations[0]);
+	FindAndReplace::replace(rows, "replacedTest", locations[0]);
 
-	EXPECT_EQ(rows[0].line, "replacedTest, test2, t3st3, test4, otherword, otherwordwithtest");
+	EXPECT_EQ(rows.line(0), "replacedTest, test2, t3st3, test4, otherword, otherwordwithtest");
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <iostream>
+
+#include "Utility/LineScanner/LineScanner.hpp"
+
+using LineScanner::Implementation;
+
+static const std::vector<Implementation> allImplementations = { Implementation::Scalar, Implementation::SSE2, Implementation::AVX2 };
+
+static std::vector<size_t> expectedLineBreaks(const std::string_view str, const size_t base)
+{
+	std::vector<size_t> lineBreaks;
+	for (size_t i = 0; i < str.length(); ++i)
+	{
+		if (str[i] == '\n') lineBreaks.push_back(base + i);
+	}
+	return lineBreaks;
+}
+
+TEST(LineScannerTests, EveryImplementationFindsEveryLineBreak)
+{
+	std::string str;
+	for (size_t i = 0; i < 300; ++i)
+	{
+		str += std::string(i % 41, 'a'); //Row lengths that land the '\n' on and around every block boundary
+		str += '\n';
+	}
+	str += "no line break at the end";
+
+	for (const Implementation implementation : allImplementations)
+	{
+		if (!LineScanner::isSupported(implementation)) continue;
+
+		for (const size_t start : { 0, 1, 15, 31 }) //Unaligned starts
+		{
+			const std::string_view view = std::string_view(str).substr(start);
+			std::vector<size_t> lineBreaks;
+			EXPECT_FALSE(LineScanner::findLineBreaks(view, 100, lineBreaks, implementation));
+			EXPECT_EQ(lineBreaks, expectedLineBreaks(view, 100)) << "Implementation " << static_cast<int>(implementation) << ", start " << start;
+		}
+	}
+}
+
+TEST(LineScannerTests, CarriageReturnLineEndingsAreReported)
+{
+	for (const Implementation implementation : allImplementations)
+	{
+		if (!LineScanner::isSupported(implementation)) continue;
+
+		std::vector<size_t> lineBreaks;
+		std::string str = std::string(31, 'a') + "\r\n" + std::string(40, 'b'); //"\r\n" split across a 16 and 32 byte boundary
+		EXPECT_TRUE(LineScanner::findLineBreaks(str, 0, lineBreaks, implementation));
+		EXPECT_EQ(lineBreaks, std::vector<size_t>{ 32 });
+
+		lineBreaks.clear();
+		str = std::string(40, 'a') + "\r" + std::string(40, 'b') + "\n"; //A '\r' that isn't part of a line ending
+		EXPECT_FALSE(LineScanner::findLineBreaks(str, 0, lineBreaks, implementation));
+		EXPECT_EQ(lineBreaks, std::vector<size_t>{ 81 });
+
+		lineBreaks.clear();
+		EXPECT_TRUE(LineScanner::findLineBreaks("a\r\n", 0, lineBreaks, implementation)) << "Text shorter than a block still needs checking";
+	}
+}
+
+TEST(LineScannerTests, ScannerIsFasterThanFindLoop)
+{
+	std::stringstream contents;
+	std::ifstream file("test.cpp", std::ios::binary);
+	contents << file.rdbuf();
+	file.close();
+	const std::string fileStr = contents.str();
+	constexpr size_t runs = 5;
+
+	//The loop loadRows used to run: find each '\n', check for a '\r' before it, and copy the row out
+	std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	size_t rowCount = 0;
+	for (size_t run = 0; run < runs; ++run)
+	{
+		std::vector<std::string> rows;
+		size_t findPos = 0, prevPos = 0;
+		while ((findPos = fileStr.find('\n', prevPos)) != std::string::npos)
+		{
+			const size_t length = (findPos > 0 && fileStr.at(findPos - 1) == '\r') ? findPos - prevPos - 1 : findPos - prevPos;
+			rows.emplace_back(fileStr.substr(prevPos, length));
+			prevPos = findPos + 1;
+		}
+		rowCount = rows.size();
+	}
+	const auto rowLoopTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before) / runs;
+
+	std::cout << "[ BENCHMARK ] Indexing test.cpp (" << fileStr.length() / 1024 << "KB): row copying loop " << rowLoopTime.count() << "us";
+	for (const Implementation implementation : allImplementations)
+	{
+		if (!LineScanner::isSupported(implementation)) continue;
+
+		before = std::chrono::steady_clock::now();
+		for (size_t run = 0; run < runs; ++run)
+		{
+			std::vector<size_t> lineBreaks;
+			LineScanner::findLineBreaks(fileStr, 0, lineBreaks, implementation);
+			EXPECT_EQ(lineBreaks.size(), rowCount);
+		}
+		const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before) / runs;
+		if (implementation == LineScanner::bestImplementation())
+		{
+			EXPECT_LT(time, rowLoopTime);
+		}
+		std::cout << ", " << (implementation == Implementation::Scalar ? "find loop" : implementation == Implementation::SSE2 ? "SSE2" : "AVX2") << " " << time.count() << "us";
+	}
+	std::cout << '\n';
+}
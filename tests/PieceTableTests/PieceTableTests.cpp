@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <iostream>
+#include <filesystem>
+
+#include "PieceTable/PieceTable.hpp"
+#include "File/File.hpp"
+
+TEST(PieceTableTests, EmptyDocumentHasNoRows)
+{
+	PieceTable document;
+	EXPECT_EQ(document.lineCount(), 0);
+
+	document.pushBackLine();
+	EXPECT_EQ(document.lineCount(), 1) << "Adding a row to an empty document should give it exactly one empty row";
+	EXPECT_EQ(document.line(0), "");
+}
+
+TEST(PieceTableTests, RowsAreSplitOnLineBreaks)
+{
+	PieceTable document("first\nsecond\n\nlast");
+	EXPECT_EQ(document.lineCount(), 4);
+	EXPECT_EQ(document.line(0), "first");
+	EXPECT_EQ(document.line(1), "second");
+	EXPECT_EQ(document.line(2), "");
+	EXPECT_EQ(document.line(3), "last");
+	EXPECT_EQ(document.lineLength(1), 6);
+	EXPECT_EQ(document.at(3, 1), 'a');
+	EXPECT_EQ(document.at(3, 4), '\0') << "Reading past the end of a row should return '\\0'";
+}
+
+TEST(PieceTableTests, InsertAndEraseWithinRow)
+{
+	PieceTable document("hello world");
+	document.insert(0, 5, ",");
+	EXPECT_EQ(document.line(0), "hello, world");
+
+	document.erase(0, 0, 7);
+	EXPECT_EQ(document.line(0), "world");
+	EXPECT_EQ(document.lineCount(), 1);
+}
+
+TEST(PieceTableTests, InsertingLineBreakSplitsRow)
+{
+	PieceTable document("abcdef\nghi");
+	document.insert(0, 3, "\n");
+	EXPECT_EQ(document.lineCount(), 3);
+	EXPECT_EQ(document.line(0), "abc");
+	EXPECT_EQ(document.line(1), "def");
+	EXPECT_EQ(document.line(2), "ghi");
+
+	document.erase(0, 3, 1);
+	EXPECT_EQ(document.lineCount(), 2);
+	EXPECT_EQ(document.line(0), "abcdef");
+	EXPECT_EQ(document.text(), "abcdef\nghi");
+}
+
+TEST(PieceTableTests, SequentialTypingDoesntFragment)
+{
+	PieceTable document("int main() {}");
+	const std::string typed = "return 0;";
+	for (size_t i = 0; i < typed.length(); ++i)
+	{
+		document.insert(0, 12 + i, typed.substr(i, 1));
+	}
+	EXPECT_EQ(document.line(0), "int main() {return 0;}");
+	EXPECT_EQ(document.pieceCount(), 3) << "Typing in one spot should keep growing a single piece";
+}
+
+TEST(PieceTableTests, ManyEditsMatchPlainString)
+{
+	std::string expected = "line one\nline two\nline three\n";
+	PieceTable document(expected);
+
+	for (size_t i = 0; i < 500; ++i)
+	{
+		const size_t pos = (i * 7919) % (expected.length() + 1);
+		const std::string text = (i % 5 == 0) ? "\n" : std::string(1, static_cast<char>('a' + i % 26));
+
+		size_t row = 0, col = 0;
+		for (size_t j = 0; j < pos; ++j)
+		{
+			if (expected[j] == '\n') { ++row; col = 0; }
+			else ++col;
+		}
+
+		if (i % 3 == 0 && pos < expected.length())
+		{
+			document.erase(row, col, 1);
+			expected.erase(pos, 1);
+		}
+		else
+		{
+			document.insert(row, col, text);
+			expected.insert(pos, text);
+		}
+	}
+
+	EXPECT_EQ(document.text(), expected);
+	EXPECT_EQ(document.length(), expected.length());
+}
+
+TEST(PieceTableTests, AppendBufferViewsStayPutWhileGrowing)
+{
+	SlabArena arena;
+	const size_t first = arena.append("first");
+	const std::string_view firstView = arena.view(first, 5);
+
+	const std::string large(SlabArena::slabSize * 3, 'x');
+	for (size_t i = 0; i < 10; ++i)
+	{
+		arena.append(std::string(1000, 'a' + i));
+	}
+	const size_t largePos = arena.append(large);
+
+	EXPECT_EQ(arena.view(first, 5).data(), firstView.data()) << "Appending should never move text that is already stored";
+	EXPECT_EQ(firstView, "first");
+	EXPECT_EQ(arena.view(largePos, large.length()), large) << "Text larger than a slab should still be stored in one piece";
+	EXPECT_EQ(arena.size(), 5 + 10 * 1000 + large.length());
+}
+
+TEST(PieceTableTests, CompactionKeepsTextAndReducesPieces)
+{
+	std::string expected;
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		expected += "row " + std::to_string(i) + '\n';
+	}
+	PieceTable document(expected);
+
+	//Typing a character at the start of every other row leaves lots of tiny pieces behind
+	for (size_t row = 0; row < 2000; row += 2)
+	{
+		document.insert(row, 0, "#");
+	}
+	const size_t piecesBefore = document.pieceCount();
+	document.compact();
+
+	expected.clear();
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		expected += ((i % 2 == 0) ? "#row " : "row ") + std::to_string(i) + '\n';
+	}
+	EXPECT_EQ(document.text(), expected);
+	EXPECT_EQ(document.lineCount(), 2001);
+	EXPECT_EQ(document.line(1998), "#row 1998");
+	EXPECT_LT(document.pieceCount(), piecesBefore / 10);
+
+	//Compaction also happens on its own while editing
+	for (size_t i = 0; i < 5000; ++i)
+	{
+		document.insert((i * 7) % 2000, 1, "!");
+	}
+	EXPECT_GE(document.stats().compactions, 2);
+	EXPECT_EQ(document.line(14).substr(0, 2), "#!");
+}
+
+TEST(PieceTableTests, InsertAtTopFasterThanRowVector)
+{
+	std::ifstream file("test.cpp");
+	std::stringstream contents;
+	contents << file.rdbuf();
+	const std::string fileStr = contents.str();
+
+	std::vector<FileHandler::Row> rows;
+	size_t findPos, prevPos = 0;
+	while ((findPos = fileStr.find('\n', prevPos)) != std::string::npos)
+	{
+		rows.emplace_back(fileStr.substr(prevPos, findPos - prevPos));
+		prevPos = findPos + 1;
+	}
+	rows.emplace_back(fileStr.substr(prevPos));
+	PieceTable document(fileStr);
+	ASSERT_EQ(rows.size(), document.lineCount());
+
+	constexpr size_t edits = 200; //Pressing enter near the top of the file
+	std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < edits; ++i)
+	{
+		rows.insert(rows.begin() + 1, FileHandler::Row());
+	}
+	std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+	const auto vectorTime = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+	before = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < edits; ++i)
+	{
+		document.insert(1, 0, "\n");
+	}
+	after = std::chrono::steady_clock::now();
+	const auto pieceTableTime = std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+
+	std::cout << "[ BENCHMARK ] " << edits << " row inserts at the top of test.cpp: std::vector<Row> " << vectorTime.count()
+		<< "us, PieceTable " << pieceTableTime.count() << "us\n";
+
+	EXPECT_EQ(rows.size(), document.lineCount());
+	EXPECT_LT(pieceTableTime, vectorTime);
+}
+
+
+TEST(PieceTableTests, RowEditsDontDependOnDocumentSize)
+{
+	//The row edits the editor makes at the top of a file: addRow, deleteRow, undoing a deleted row, and pasting a block of rows
+	std::string block;
+	for (size_t i = 0; i < 100; ++i) block += "pasted row\n";
+
+	auto timeRowEdits = [&block](const size_t rowCount)
+		{
+			std::string text;
+			text.reserve(rowCount * 12);
+			for (size_t i = 0; i < rowCount; ++i) text += "row " + std::to_string(i) + '\n';
+			PieceTable document(std::move(text));
+
+			constexpr size_t edits = 1000;
+			const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < edits; ++i)
+			{
+				document.insert(1, 2, "\n"); //addRow
+				document.erase(1, 2, 1); //deleteRow
+				document.insert(1, 2, "\n"); //Undoing the deleted row
+				document.insert(2, 0, block); //Paste
+			}
+			const std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+
+			EXPECT_EQ(document.lineCount(), rowCount + 1 + edits * (1 + 100));
+			EXPECT_EQ(document.line(2), "pasted row");
+			EXPECT_EQ(document.line(document.lineCount() - 2), "row " + std::to_string(rowCount - 1));
+			return std::chrono::duration_cast<std::chrono::microseconds>(after - before);
+		};
+
+	const auto smallTime = timeRowEdits(20'000);
+	const auto largeTime = timeRowEdits(2'000'000);
+	std::cout << "[ BENCHMARK ] 4000 row edits at the top of the document: 20k rows " << smallTime.count() << "us, 2M rows " << largeTime.count() << "us\n";
+
+	//A container that moves the rows after the edit would be about 100x slower on the larger document
+	EXPECT_LT(largeTime.count(), (smallTime.count() + 1000) * 10);
+}
+
+TEST(PieceTableTests, PartOfRowIsCopied)
+{
+	PieceTable document("first\nsecond row\nlast");
+	document.insert(1, 6, " long");
+	EXPECT_EQ(document.line(1, 3, 8), "ond long");
+	EXPECT_EQ(document.line(1, 7, std::string::npos), "long row");
+	EXPECT_EQ(document.line(2, 4, 10), "");
+	EXPECT_THROW(document.line(0, 6, 1), std::out_of_range);
+}
+
+TEST(PieceTableTests, LineIndexSearchesAcrossSegments)
+{
+	LineIndex lineBreaks(std::vector<size_t>{ 3, 7 });
+	lineBreaks.append({});
+	lineBreaks.append({ 12, 20, 21 });
+	lineBreaks.scan("ab\ncd\n", 30);
+	EXPECT_EQ(lineBreaks.segmentCount(), 2) << "Empty segments shouldn't be kept, and scanning adds to the last segment";
+	ASSERT_EQ(lineBreaks.size(), 7);
+
+	const std::vector<size_t> expected = { 3, 7, 12, 20, 21, 32, 35 };
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		EXPECT_EQ(lineBreaks[i], expected[i]);
+	}
+	EXPECT_EQ(lineBreaks.lowerBound(0), 0);
+	EXPECT_EQ(lineBreaks.lowerBound(7), 1);
+	EXPECT_EQ(lineBreaks.lowerBound(8), 2);
+	EXPECT_EQ(lineBreaks.lowerBound(21), 4);
+	EXPECT_EQ(lineBreaks.lowerBound(22), 5);
+	EXPECT_EQ(lineBreaks.lowerBound(36), 7);
+}
+
+TEST(PieceTableTests, PartiallyIndexedDocumentOnlyShowsCompleteRows)
+{
+	std::ofstream file("partialTestFile.txt", std::ios::binary);
+	file << "first\nsecond\nthird";
+	file.close();
+
+	MappedFile mapping;
+	ASSERT_TRUE(mapping.open("partialTestFile.txt"));
+	PieceTable document(std::move(mapping), std::vector<size_t>{ 5 }, false);
+	EXPECT_FALSE(document.isIndexed());
+	EXPECT_EQ(document.lineCount(), 1) << "Only the rows ending in a known line break are complete";
+	EXPECT_EQ(document.line(0), "first");
+	EXPECT_THROW(document.line(1), std::out_of_range);
+	EXPECT_THROW(document.insert(0, 0, "a"), std::logic_error) << "Editing has to wait for indexing to finish";
+
+	document.appendOriginalLineBreaks({ 12 }, true);
+	EXPECT_TRUE(document.isIndexed());
+	ASSERT_EQ(document.lineCount(), 3);
+	EXPECT_EQ(document.line(1), "second");
+	EXPECT_EQ(document.line(2), "third");
+
+	document.insert(2, 0, "the ");
+	EXPECT_EQ(document.line(2), "the third");
+
+	document = PieceTable(); //Unmaps the file so it can be removed
+	std::filesystem::remove("partialTestFile.txt");
+}
\ No newline at end of file
@@ -1,8 +1,18 @@
 #include <gtest/gtest.h>
 #include <string>
 #include <format>
+#include <atomic>
+#include <random>
+#include <algorithm>
 
 #include "Renderer/Renderer.hpp"
+#include "Renderer/FrameBuffer.hpp"
+#include "Renderer/StyleCompositor.hpp"
+#include "Renderer/SgrEncoder.hpp"
+#include "Renderer/ViewportCache.hpp"
+#include "PieceTable/PieceTable.hpp"
+
+extern std::atomic<size_t> allocationCount;
 
 TEST(RendererTests, RendererWritesToConsole)
 {
@@ -36,7 +46,7 @@ TEST(RendererTests, RendererAddsStatusToBuffer)
 
 	std::string rStatus = "Right-end of status";
 
-	renderer.setStatusBuffer(1, false, "testFile.txt", 1, 1, 1, mode, rStatus, 120);
+	renderer.setStatusBuffer(1, false, "testFile.txt", 1, 100, 1, 1, mode, rStatus, 120);
 	testing::internal::CaptureStdout();
 	renderer.renderScreen(false, false);
 	std::string output = testing::internal::GetCapturedStdout();
@@ -45,6 +55,45 @@ TEST(RendererTests, RendererAddsStatusToBuffer)
 	EXPECT_TRUE(outputContainsStatus);
 }
 
+TEST(RendererTests, StatusFitsNarrowScreens)
+{
+	Renderer renderer;
+	renderer.resize(3, 20);
+
+	//The file info alone is wider than the screen, which used to wrap the padding around
+	renderer.setStatusBuffer(2, true, "aVeryLongFileNameThatDoesNotFit.txt", 1000, 100, 1, 1, "EDIT", "1:1", 20);
+	testing::internal::CaptureStdout();
+	renderer.renderScreen(false, false);
+	const std::string output = testing::internal::GetCapturedStdout();
+
+	EXPECT_NE(output.find("aVeryLongFileNameTha"), std::string::npos);
+	EXPECT_EQ(output.find("aVeryLongFileNameThat"), std::string::npos) << "The file info should be cut off at the edge of the screen";
+}
+
+TEST(RendererTests, LongModeFitsNarrowScreens)
+{
+	Renderer renderer;
+	renderer.resize(3, 30);
+
+	//The mode names the large file policy, which is longer than the space left after the file info
+	const std::string mode = "READ (large file: no highlighting, no undo)";
+	renderer.setStatusBuffer(2, false, "big.log", 5000000, 40, 1, 1, mode, "1:1", 30);
+	testing::internal::CaptureStdout();
+	renderer.renderScreen(false, false);
+	const std::string output = testing::internal::GetCapturedStdout();
+
+	const std::string fileInfo = "big.log - 5000000+ lines (indexing 40%) ";
+	EXPECT_NE(output.find(fileInfo.substr(0, 30)), std::string::npos);
+	EXPECT_EQ(output.find("READ"), std::string::npos) << "There is no room left for the mode";
+
+	renderer.setStatusBuffer(2, false, "big.log", 5000000, 100, 1, 1, mode, "1:1", 30);
+	testing::internal::CaptureStdout();
+	renderer.renderScreen(false, false);
+	const std::string shortOutput = testing::internal::GetCapturedStdout();
+	EXPECT_NE(shortOutput.find("lines READ ("), std::string::npos) << "The mode should start right after the file info and be cut off at the edge";
+	EXPECT_EQ(shortOutput.find("large"), std::string::npos);
+}
+
 TEST(RendererTests, RendererSetsCursorPosition)
 {
 	Renderer renderer;
@@ -114,4 +163,411 @@ TEST(RendererTests, ForceRerenderWorks)
 	std::string output2 = testing::internal::GetCapturedStdout(); //Shouldn't contain main text buffer since it is just a re-render
 
 	EXPECT_EQ(output, output2);
-}
\ No newline at end of file
+}
+
+TEST(RendererTests, FrameBufferKeepsStyleBetweenWrites)
+{
+	FrameBuffer frame;
+	frame.resize(3, 10);
+	EXPECT_EQ(frame.write(0, 0, "a\x1b[38;5;4mbc"), 3);
+	frame.write(1, 0, "de\x1b[48;5;237mf\x1b[0K");
+	frame.write(2, 8, "\x1b[0mghij");
+
+	EXPECT_EQ(frame.at(0, 0).style, FrameBuffer::Style());
+	EXPECT_EQ(frame.at(0, 1).glyph, 'b');
+	EXPECT_EQ(frame.at(0, 1).style.foreground, 4);
+	EXPECT_EQ(frame.at(1, 0).style.foreground, 4) << "A color should carry on to the next row, like it does on a terminal";
+	EXPECT_EQ(frame.at(1, 2).style.background, 237);
+	EXPECT_EQ(frame.at(1, 9).style, FrameBuffer::Style{ .background = 237 }) << "Clearing the rest of the row only keeps the background";
+	EXPECT_EQ(frame.at(2, 9).glyph, 'h') << "Text past the last column should be dropped";
+}
+
+TEST(RendererTests, FrameBufferRewritesChangedMultiByteRows)
+{
+	FrameBuffer frame;
+	frame.resize(2, 10);
+	EXPECT_EQ(frame.write(0, 0, "h\xc3\xa9llo \xe2\x82\xac"), 7) << "Each UTF-8 character should take one cell";
+	frame.write(1, 0, "plain");
+	EXPECT_EQ(frame.at(0, 2).glyph, 'l');
+	EXPECT_EQ(frame.at(0, 6).glyph, '\xe2');
+	EXPECT_EQ(std::string_view(frame.at(0, 6).continuation, 2), "\x82\xac");
+
+	std::string output;
+	frame.flush(output);
+	EXPECT_NE(output.find("h\xc3\xa9llo \xe2\x82\xac"), std::string::npos) << "Characters should be sent whole";
+
+	//Changing a cell after a multi-byte character rewrites the row from its start instead of moving the cursor into it
+	frame.write(0, 0, "h\xc3\xa9llx \xe2\x82\xac");
+	frame.write(1, 0, "plaiN");
+	output.clear();
+	frame.flush(output);
+	EXPECT_EQ(output, "\x1b[1;1Hh\xc3\xa9llx \xe2\x82\xac\x1b[K\x1b[2;5HN");
+}
+
+//Plays back what the renderer wrote onto a frame that stands in for the terminal
+static void playBack(FrameBuffer& screen, const std::string_view output)
+{
+	size_t row = 0, col = 0, i = 0;
+	size_t scrollTop = 0, scrollBottom = screen.rows();
+	while (i < output.length())
+	{
+		const size_t escape = output.find("\x1b[", i);
+		col = screen.write(row, col, output.substr(i, escape - i));
+		if (escape == std::string_view::npos) break;
+
+		const size_t end = output.find_first_of("HJKmrST", escape);
+		if (output[end] == 'H')
+		{
+			const size_t separator = output.find(';', escape);
+			row = std::stoul(std::string(output.substr(escape + 2, separator - escape - 2))) - 1;
+			col = std::stoul(std::string(output.substr(separator + 1, end - separator - 1))) - 1;
+		}
+		else if (output[end] == 'r')
+		{
+			const size_t separator = output.find(';', escape);
+			scrollTop = (separator < end) ? std::stoul(std::string(output.substr(escape + 2, separator - escape - 2))) - 1 : 0;
+			scrollBottom = (separator < end) ? std::stoul(std::string(output.substr(separator + 1, end - separator - 1))) : screen.rows();
+			row = col = 0;
+		}
+		else if (output[end] == 'S' || output[end] == 'T')
+		{
+			const int64_t count = std::stol(std::string(output.substr(escape + 2, end - escape - 2)));
+			screen.scroll(scrollTop, scrollBottom, (output[end] == 'S') ? count : -count);
+		}
+		else col = screen.write(row, col, output.substr(escape, end + 1 - escape));
+		i = end + 1;
+	}
+}
+
+TEST(RendererTests, FrameBufferDiffsMatchWholeFrames)
+{
+	constexpr size_t rows = 12, cols = 40;
+	FrameBuffer frame, screen;
+	frame.resize(rows, cols);
+	screen.resize(rows, cols);
+
+	std::mt19937 random(7);
+	std::vector<std::string> lines(rows);
+	for (size_t i = 0; i < 200; ++i)
+	{
+		//Each frame changes a few rows, with text of random lengths and colors
+		for (size_t change = 0; change < 3; ++change)
+		{
+			std::string& line = lines[random() % rows];
+			line.clear();
+			const size_t length = random() % (cols + 5);
+			for (size_t c = 0; c < length; ++c)
+			{
+				if (random() % 10 == 0) line += std::format("\x1b[{};5;{}m", (random() % 2) ? 38 : 48, random() % 256);
+				if (random() % 20 == 0) line += "\x1b[0m";
+				line.push_back(static_cast<char>('a' + random() % 4));
+			}
+		}
+
+		FrameBuffer expected;
+		expected.resize(rows, cols);
+		for (size_t row = 0; row < rows; ++row)
+		{
+			frame.write(row, frame.write(row, 0, lines[row]), "\x1b[0K");
+			expected.write(row, expected.write(row, 0, lines[row]), "\x1b[0K");
+		}
+
+		std::string output;
+		frame.flush(output);
+		playBack(screen, output);
+		for (size_t row = 0; row < rows; ++row)
+		{
+			for (size_t col = 0; col < cols; ++col)
+			{
+				ASSERT_EQ(screen.at(row, col), expected.at(row, col)) << "Frame " << i << ", row " << row << ", column " << col;
+			}
+		}
+	}
+}
+
+TEST(RendererTests, ScrolledRowsArentRedrawn)
+{
+	constexpr size_t rows = 12, cols = 40, textRows = 10;
+	FrameBuffer frame, screen;
+	frame.resize(rows, cols);
+	screen.resize(rows, cols);
+	frame.setScrollRegion(0, textRows);
+
+	auto drawFrame = [&](const size_t rowOffset)
+		{
+			for (size_t row = 0; row < textRows; ++row)
+			{
+				frame.write(row, 0, std::format("\x1b[38;5;{}mrow {} of the file\x1b[0m", rowOffset + row, rowOffset + row));
+			}
+			frame.write(textRows, 0, std::format("status {}", rowOffset % 10));
+
+			std::string output;
+			frame.flush(output);
+			playBack(screen, output);
+			for (size_t row = 0; row < textRows; ++row)
+			{
+				const std::string expected = std::format("row {} of the file", rowOffset + row);
+				for (size_t col = 0; col < expected.length(); ++col)
+				{
+					EXPECT_EQ(screen.at(row, col).glyph, expected[col]) << "Row " << row << " after scrolling to " << rowOffset;
+					EXPECT_EQ(screen.at(row, col).style.foreground, rowOffset + row);
+				}
+			}
+			EXPECT_EQ(screen.at(textRows, 7).glyph, '0' + rowOffset % 10);
+			return output;
+		};
+
+	const std::string firstFrame = drawFrame(0);
+	EXPECT_EQ(firstFrame.find("S"), std::string::npos);
+
+	const std::string scrolledDown = drawFrame(3);
+	EXPECT_NE(scrolledDown.find("\x1b[1;10r\x1b[3S\x1b[r"), std::string::npos);
+	EXPECT_EQ(scrolledDown.find("row 3 "), std::string::npos) << "Rows that were already on screen shouldn't be drawn again";
+	EXPECT_NE(scrolledDown.find("row 12 "), std::string::npos);
+
+	const std::string scrolledUp = drawFrame(2);
+	EXPECT_NE(scrolledUp.find("\x1b[1;10r\x1b[1T\x1b[r"), std::string::npos);
+	EXPECT_LT(scrolledUp.length(), firstFrame.length() / 4);
+
+	drawFrame(50); //Nothing in common, so everything is redrawn
+	frame.setScrollRegion(0, 0);
+	const std::string withoutScrolling = drawFrame(51);
+	EXPECT_EQ(withoutScrolling.find("\x1b[1;10r"), std::string::npos) << "Without a scroll region the rows should be redrawn";
+}
+
+TEST(RendererTests, StyleSpansAreComposedOntoText)
+{
+	FrameBuffer frame;
+	frame.resize(3, 20);
+	StyleCompositor styles;
+	styles.setBaseStyle(FrameBuffer::Style{ .foreground = 15 });
+
+	//A keyword, a find match over part of it and the text after it, and a comment carrying on from the row before
+	styles.addForeground({ .row = 1, .startCol = 0, .endCol = 3, .color = 4 });
+	styles.addForeground({ .row = 0, .startCol = 10, .endCol = std::string::npos, .color = 2 });
+	styles.addForeground({ .row = 1, .startCol = 10, .endCol = 12, .color = 9 });
+	styles.addBackground({ .row = 1, .startCol = 2, .endCol = 6, .color = 237 });
+	styles.addForeground({ .row = 2, .startCol = 4, .endCol = 4, .color = 1 }); //Empty, so it is dropped
+
+	styles.compose(frame, 0, "int a = 0; //comment");
+	styles.compose(frame, 1, "int b = 1;");
+	styles.compose(frame, 2, "return");
+
+	EXPECT_EQ(frame.at(0, 0).style, FrameBuffer::Style{ .foreground = 15 });
+	EXPECT_EQ(frame.at(0, 19).style.foreground, 2);
+	EXPECT_EQ(frame.at(1, 1).style, FrameBuffer::Style{ .foreground = 4 });
+	EXPECT_EQ(frame.at(1, 2).style, (FrameBuffer::Style{ .foreground = 4, .background = 237 }));
+	EXPECT_EQ(frame.at(1, 3).style, (FrameBuffer::Style{ .foreground = 15, .background = 237 }));
+	EXPECT_EQ(frame.at(1, 6).style, FrameBuffer::Style{ .foreground = 15 });
+	EXPECT_EQ(frame.at(1, 9).glyph, ';');
+	EXPECT_EQ(frame.at(1, 10), FrameBuffer::Cell()) << "Spans past the end of the text shouldn't draw anything";
+	EXPECT_EQ(frame.at(2, 4).style, FrameBuffer::Style{ .foreground = 15 });
+}
+
+TEST(RendererTests, StyleSpansAfterMultiByteCharactersLineUp)
+{
+	FrameBuffer frame;
+	frame.resize(1, 10);
+	StyleCompositor styles;
+
+	//Spans are in bytes of the text, and the "\xc3\xa9" before the span is two bytes but one cell
+	styles.addForeground({ .row = 0, .startCol = 4, .endCol = 7, .color = 4 });
+	styles.compose(frame, 0, "\xc3\xa9: abc!");
+
+	EXPECT_EQ(frame.at(0, 3).glyph, 'a');
+	EXPECT_EQ(frame.at(0, 3).style.foreground, 4);
+	EXPECT_EQ(frame.at(0, 5).glyph, 'c');
+	EXPECT_EQ(frame.at(0, 6).glyph, '!');
+	EXPECT_EQ(frame.at(0, 6).style, FrameBuffer::Style());
+	EXPECT_EQ(frame.at(0, 7), FrameBuffer::Cell()) << "No blank cells should be left before the end of the text";
+}
+
+TEST(RendererTests, SgrEncoderOnlyWritesChangedAttributes)
+{
+	for (uint16_t color = 0; color < 256; ++color)
+	{
+		EXPECT_EQ(SgrEncoder::foreground(static_cast<uint8_t>(color)), std::format("\x1b[38;5;{}m", color));
+		EXPECT_EQ(SgrEncoder::background(static_cast<uint8_t>(color)), std::format("\x1b[48;5;{}m", color));
+	}
+
+	SgrEncoder encoder;
+	std::string output;
+	encoder.encode(output, SgrEncoder::Style{ .foreground = 160 });
+	EXPECT_EQ(output, "\x1b[38;5;160m");
+
+	output.clear();
+	encoder.encode(output, SgrEncoder::Style{ .foreground = 160 });
+	EXPECT_EQ(output, "") << "Nothing should be written when the style hasn't changed";
+
+	encoder.encode(output, SgrEncoder::Style{ .foreground = 160, .background = 237 });
+	EXPECT_EQ(output, "\x1b[48;5;237m") << "Only the background changed";
+
+	output.clear();
+	encoder.encode(output, SgrEncoder::Style{ .background = 237, .inverse = true });
+	EXPECT_EQ(output, "\x1b[7m\x1b[39m");
+
+	output.clear();
+	encoder.encode(output, SgrEncoder::Style());
+	EXPECT_EQ(output, "\x1b[0m");
+}
+
+TEST(RendererTests, HighlightedFramesDontAllocate)
+{
+	constexpr size_t rows = 50, cols = 200;
+	FrameBuffer frame;
+	frame.resize(rows, cols);
+	StyleCompositor styles;
+	styles.setBaseStyle(FrameBuffer::Style{ .foreground = 15 });
+	std::string text;
+	for (size_t i = 0; i < cols / 10; ++i) text += "int value;";
+	std::string output;
+
+	auto drawFrame = [&](const size_t shift)
+		{
+			//A keyword every 10 columns, and a find match on every other row
+			for (size_t row = 0; row < rows; ++row)
+			{
+				for (size_t col = (row + shift) % 10; col < cols; col += 10) styles.addForeground({ row, col, col + 3, static_cast<uint8_t>(160 + row % 4) });
+				if (row % 2 == 0) styles.addBackground({ row, 20 + shift, 30 + shift, 237 });
+			}
+			for (size_t row = 0; row < rows; ++row) styles.compose(frame, row, text);
+			styles.clear();
+
+			output.clear();
+			frame.flush(output);
+			return output.length();
+		};
+
+	const size_t firstFrame = drawFrame(0);
+	drawFrame(1);
+	drawFrame(0);
+	const size_t before = allocationCount;
+	const size_t changedFrame = drawFrame(1);
+	EXPECT_EQ(allocationCount - before, 0) << "Styling and sending a frame shouldn't allocate once its buffers have grown";
+	std::cout << "[ BENCHMARK ] " << rows << "x" << cols << " frame with " << rows * cols / 10 << " highlights: first frame " << firstFrame
+		<< " bytes, every highlight moved " << changedFrame << " bytes\n";
+}
+
+TEST(RendererTests, TypingOnlySendsChangedCells)
+{
+	constexpr uint16_t rows = 100, cols = 300;
+	Renderer renderer;
+	renderer.resize(rows, cols);
+
+	auto drawFrame = [&renderer](const std::string& typed)
+		{
+			for (size_t row = 0; row < rows - 2; ++row)
+			{
+				std::string line = "\x1b[38;5;12m" + std::string(cols - 1, static_cast<char>('a' + row % 26)) + "\x1b[38;5;15m";
+				if (row == 40) line.replace(10 + 5, typed.length(), typed); //After the color escape
+				renderer.addRenderedLineToBuffer(line);
+			}
+			renderer.setStatusBuffer(rows - 1, true, "file.cpp", 98, 100, 41, 6 + typed.length(), "EDIT", "", cols);
+			renderer.setCursorBuffer(41, 6 + typed.length());
+
+			testing::internal::CaptureStdout();
+			renderer.renderScreen(false, false);
+			return testing::internal::GetCapturedStdout();
+		};
+
+	const std::string firstFrame = drawFrame("");
+	const std::string typedFrame = drawFrame("x");
+	std::cout << "[ BENCHMARK ] Typing a character on a 300x100 terminal: first frame " << firstFrame.length() << " bytes, next frame " << typedFrame.length() << " bytes\n";
+
+	EXPECT_GT(firstFrame.length(), rows * (cols - 1));
+	EXPECT_LT(typedFrame.length(), 64) << "Only the typed character, the column number and the cursor should be sent";
+	EXPECT_NE(typedFrame.find("\x1b[41;6H"), std::string::npos);
+
+	//Each frame is sent in one write, wrapped in synchronized update mode so it is shown all at once
+	EXPECT_EQ(renderer.lastFrameStats().writes, 1);
+	EXPECT_EQ(renderer.lastFrameStats().bytes, typedFrame.length());
+	EXPECT_TRUE(typedFrame.starts_with("\x1b[?2026h"));
+	EXPECT_TRUE(typedFrame.ends_with("\x1b[?2026l"));
+}
+
+TEST(RendererTests, UnchangedFrameIsntWritten)
+{
+	Renderer renderer;
+	renderer.resize(5, 20);
+	renderer.addRenderedLineToBuffer("Test Line");
+	testing::internal::CaptureStdout();
+	renderer.renderScreen(false, false);
+	EXPECT_NE(testing::internal::GetCapturedStdout(), std::string());
+	EXPECT_EQ(renderer.lastFrameStats().writes, 1);
+
+	renderer.addRenderedLineToBuffer("Test Line");
+	testing::internal::CaptureStdout();
+	renderer.renderScreen(false, false);
+	EXPECT_EQ(testing::internal::GetCapturedStdout(), std::string());
+	EXPECT_EQ(renderer.lastFrameStats().writes, 0);
+}
+
+TEST(RendererTests, ViewportCacheReusesRowsWhenScrolling)
+{
+	std::string text;
+	for (size_t i = 0; i < 100; ++i)
+	{
+		text += "row " + std::to_string(i) + '\n';
+	}
+	PieceTable document(text);
+	ViewportCache viewport;
+	viewport.resize(21);
+
+	viewport.load(document, 10, 30);
+	EXPECT_EQ(viewport.rowsLoaded(), 21);
+	EXPECT_EQ(viewport.at(10).line, "row 10");
+	EXPECT_EQ(viewport.at(30).renderedLine, "row 30");
+
+	viewport.at(15).renderedLine = "changed while rendering";
+	viewport.load(document, 13, 33); //Scrolling down
+	EXPECT_EQ(viewport.rowsLoaded(), 3);
+	EXPECT_EQ(viewport.at(15).renderedLine, "row 15") << "Rendered lines are rebuilt every frame";
+	EXPECT_EQ(viewport.at(33).line, "row 33");
+	EXPECT_THROW(viewport.at(12), std::out_of_range);
+
+	viewport.load(document, 5, 25); //Scrolling up
+	EXPECT_EQ(viewport.rowsLoaded(), 8);
+	for (size_t row = 5; row <= 25; ++row)
+	{
+		EXPECT_EQ(viewport.at(row).line, "row " + std::to_string(row));
+	}
+
+	document.insert(20, 0, "new ");
+	viewport.load(document, 5, 25);
+	EXPECT_EQ(viewport.rowsLoaded(), 21) << "Editing the document invalidates the cached rows";
+	EXPECT_EQ(viewport.at(20).line, "new row 20");
+
+	viewport.load(document, 95, 120);
+	EXPECT_EQ(viewport.size(), document.lineCount());
+	EXPECT_EQ(viewport.at(100).line, "");
+
+	//Once the buffers have grown, drawing the same rows again doesn't allocate
+	viewport.load(document, 40, 60);
+	const size_t before = allocationCount;
+	viewport.load(document, 41, 61);
+	viewport.load(document, 40, 60);
+	EXPECT_EQ(allocationCount - before, 0);
+}
+
+TEST(RendererTests, ViewportCacheKeepsRowsBeforeAppendedOnes)
+{
+	std::string text;
+	for (size_t i = 0; i < 20; ++i) text += "row " + std::to_string(i) + '\n';
+	PieceTable document(text);
+	ViewportCache viewport;
+	viewport.resize(21);
+	viewport.load(document, 0, 20);
+
+	const uint64_t previousVersion = document.version();
+	document.insert(20, 0, "row 20\nrow 21\n");
+	viewport.keepRowsBefore(document, previousVersion, 20);
+	viewport.load(document, 2, 22);
+	EXPECT_EQ(viewport.rowsLoaded(), 3) << "Only the rows that were added should be pulled out of the document";
+	EXPECT_EQ(viewport.at(19).line, "row 19");
+	EXPECT_EQ(viewport.at(21).line, "row 21");
+
+	document.insert(0, 0, "changed ");
+	viewport.keepRowsBefore(document, previousVersion, 22); //The cache is from a later version than this, so nothing can be kept
+	viewport.load(document, 2, 22);
+	EXPECT_EQ(viewport.rowsLoaded(), 21);
+}
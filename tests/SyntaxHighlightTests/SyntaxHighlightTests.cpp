@@ -5,7 +5,8 @@
 #include <string_view>
 #include <vector>
 
-#include "File/File.hpp"
+#include "PieceTable/PieceTable.hpp"
+#include "Renderer/ViewportCache.hpp"
 #include "SyntaxHighlight/SyntaxHighlight.hpp"
 
 TEST(SyntaxHighlightTests, TextFileHasNoSyntax)
@@ -65,11 +66,9 @@ TEST(SyntaxHighlightTests, OffScreenHighlightsGetRemoved)
 TEST(SyntaxHighlightTests, MultilineCommentCheckWorks)
 {
 	SyntaxHighlight highlight(".cpp");
-	std::vector<FileHandler::Row> fileRows{
-		FileHandler::Row("/*Start to a multilineComment", "/*Start to a multilineComment"),
-		FileHandler::Row("End to a multilineComment*/", "End to a multilineComment*/"),
-		FileHandler::Row("Test line at end to make sure end marker end row is correct", "Test line")
-	};
+	PieceTable document("/*Start to a multilineComment\nEnd to a multilineComment*/\nTest line at end to make sure end marker end row is correct");
+	ViewportCache fileRows;
+	fileRows.load(document, 0, 2);
 
 	uint8_t beforeAddition = highlight.highlights().size();
 	EXPECT_EQ(beforeAddition, 0);
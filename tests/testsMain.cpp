@@ -1,5 +1,27 @@
 #include <gtest/gtest.h>
 #include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+std::atomic<size_t> allocationCount = 0; //Every heap allocation made by the tests, so tests can measure how many a task needs
+
+void* operator new(size_t size)
+{
+	++allocationCount;
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
 
 int main(int argc, char** argv)
 {